@@ -0,0 +1,549 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+
+#include "AI/CrowdAvoidanceSubsystem.h"
+
+#include "TankGame.h"
+#include "AIController.h"
+#include "Async/ParallelFor.h"
+#include "Character/MainCharacter.h"
+#include "Character/MainCharacterMovementComponent.h"
+#include "Components/CapsuleComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Navigation/PathFollowingComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("Crowd Gather"), STAT_CrowdGather, STATGROUP_TankGame);
+DECLARE_CYCLE_STAT(TEXT("Crowd Apply"), STAT_CrowdApply, STATGROUP_TankGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Crowd Agents"), STAT_CrowdAgents, STATGROUP_TankGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Crowd Agents Solved"), STAT_CrowdAgentsSolved, STATGROUP_TankGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Crowd Surround Attackers"), STAT_CrowdAttackers, STATGROUP_TankGame);
+
+namespace
+{
+	TAutoConsoleVariable<bool> CVarCrowdEnabled(
+		TEXT("tg.Crowd.Enabled"),
+		true,
+		TEXT("Steer NPC path following around other characters."));
+
+	TAutoConsoleVariable<float> CVarCrowdNeighbourRadius(
+		TEXT("tg.Crowd.NeighbourRadius"),
+		400.f,
+		TEXT("Characters further apart than this ignore each other."));
+
+	TAutoConsoleVariable<int32> CVarCrowdMaxNeighbours(
+		TEXT("tg.Crowd.MaxNeighbours"),
+		8,
+		TEXT("Closest neighbours each NPC avoids."));
+
+	TAutoConsoleVariable<float> CVarCrowdTimeHorizon(
+		TEXT("tg.Crowd.TimeHorizon"),
+		2.f,
+		TEXT("Seconds ahead that collisions are anticipated."));
+
+	TAutoConsoleVariable<int32> CVarCrowdSurroundSlots(
+		TEXT("tg.Crowd.SurroundSlots"),
+		6,
+		TEXT("Attack slots around each player pawn. 0 disables surrounding."));
+
+	TAutoConsoleVariable<float> CVarCrowdSurroundGap(
+		TEXT("tg.Crowd.SurroundGap"),
+		30.f,
+		TEXT("Clearance between an attacker's capsule and its target's collision at an attack slot."));
+
+	TAutoConsoleVariable<float> CVarCrowdSurroundEngageDistance(
+		TEXT("tg.Crowd.SurroundEngageDistance"),
+		1000.f,
+		TEXT("NPCs heading for a player pawn within this distance are given a surround slot."));
+
+	/** Path following requests older than this mean the NPC is not being moved, so it only acts as an obstacle. */
+	constexpr double kPreferredVelocityMaxAge = 0.2;
+
+	/** Seconds an attacker takes to close the last stretch to its slot, so it slows down instead of overshooting. */
+	constexpr float kSlotArrivalTime = 0.4f;
+
+	/** Attackers without a slot wait at this multiple of the slot radius. */
+	constexpr float kWaitingRingScale = 2.5f;
+
+	/** True if Pawn's path has no corners left before its goal. Pawns moved without a path count as on their final leg. */
+	bool IsOnFinalLeg(const APawn* Pawn)
+	{
+		const AAIController* AIController = Cast<AAIController>(Pawn->GetController());
+		const UPathFollowingComponent* PathFollowing = AIController ? AIController->GetPathFollowingComponent() : nullptr;
+
+		if (PathFollowing == nullptr || !PathFollowing->HasValidPath())
+		{
+			return true;
+		}
+
+		return PathFollowing->GetNextPathIndex() >= PathFollowing->GetPath()->GetPathPoints().Num() - 1;
+	}
+
+	FVector2D SteerTowards(const FVector2D& From, const FVector2D& To, float MaxSpeed)
+	{
+		const FVector2D Offset = To - From;
+		const float Distance = Offset.Size();
+
+		if (Distance < 10.f)
+		{
+			return FVector2D::ZeroVector;
+		}
+
+		return Offset / Distance * FMath::Min(MaxSpeed, Distance / kSlotArrivalTime);
+	}
+}
+
+bool UCrowdAvoidanceSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCrowdAvoidanceSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	if (UGameplayJobSubsystem* GameplayJobs = Collection.InitializeDependency<UGameplayJobSubsystem>())
+	{
+		GameplayJobs->RegisterJob(this, TEXT("CrowdAvoidance"));
+	}
+}
+
+void UCrowdAvoidanceSubsystem::Deinitialize()
+{
+	if (UGameplayJobSubsystem* GameplayJobs = GetWorld()->GetSubsystem<UGameplayJobSubsystem>())
+	{
+		GameplayJobs->UnregisterJob(this);
+	}
+
+	Characters.Empty();
+	GatheredMovements.Empty();
+	Rings.Empty();
+
+	Super::Deinitialize();
+}
+
+void UCrowdAvoidanceSubsystem::RegisterCharacter(AMainCharacter* Character)
+{
+	if (Character && Cast<UMainCharacterMovementComponent>(Character->GetCharacterMovement()))
+	{
+		Characters.AddUnique(Character);
+	}
+}
+
+void UCrowdAvoidanceSubsystem::UnregisterCharacter(AMainCharacter* Character)
+{
+	Characters.RemoveSwap(Character);
+}
+
+int32 UCrowdAvoidanceSubsystem::GatherJob(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_CrowdGather);
+
+	Characters.RemoveAllSwap([](const TWeakObjectPtr<AMainCharacter>& Character) { return !Character.IsValid(); });
+
+	Solver.Agents.Reset();
+	GatheredMovements.Reset();
+
+	if (!CVarCrowdEnabled.GetValueOnGameThread())
+	{
+		Rings.Reset();
+		return 0;
+	}
+
+	Solver.Params.NeighbourRadius = CVarCrowdNeighbourRadius.GetValueOnGameThread();
+	Solver.Params.MaxNeighbours = CVarCrowdMaxNeighbours.GetValueOnGameThread();
+	Solver.Params.TimeHorizon = CVarCrowdTimeHorizon.GetValueOnGameThread();
+
+	TArray<APawn*, TInlineAllocator<4>> Targets;
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (APawn* PlayerPawn = It->Get() ? It->Get()->GetPawn() : nullptr)
+		{
+			Targets.Add(PlayerPawn);
+		}
+	}
+
+	const float EngageDistanceSquared = FMath::Square(CVarCrowdSurroundEngageDistance.GetValueOnGameThread());
+	const bool bSurround = CVarCrowdSurroundSlots.GetValueOnGameThread() > 0;
+
+	TArray<FAttacker> Attackers;
+	int32 NumSolved = 0;
+
+	for (const TWeakObjectPtr<AMainCharacter>& Character : Characters)
+	{
+		UMainCharacterMovementComponent* Movement = CastChecked<UMainCharacterMovementComponent>(Character->GetCharacterMovement());
+
+		FCrowdAgent& Agent = Solver.Agents.AddDefaulted_GetRef();
+		Agent.Position = FVector2D(Character->GetActorLocation());
+		Agent.Velocity = FVector2D(Movement->Velocity);
+		Agent.PreferredVelocity = FVector2D(Movement->GetPreferredVelocity(kPreferredVelocityMaxAge));
+		Agent.Radius = Character->GetCapsuleComponent()->GetScaledCapsuleRadius();
+		Agent.MaxSpeed = Movement->GetMaxSpeed();
+		Agent.bSolve = !Character->IsPlayerControlled() && Movement->IsMovingOnGround() && !Agent.PreferredVelocity.IsNearlyZero();
+
+		GatheredMovements.Add(Movement);
+
+		if (!Agent.bSolve)
+		{
+			// Cleared here rather than in ApplyJob, which does not run on frames with nothing to solve. Otherwise the
+			// last solved velocity would keep overriding path following until it went stale.
+			Movement->ClearAvoidanceVelocity();
+			continue;
+		}
+
+		++NumSolved;
+
+		if (!bSurround)
+		{
+			continue;
+		}
+
+		// An NPC heading roughly towards a nearby player pawn is taken to be attacking it.
+		const FVector2D Heading = Agent.PreferredVelocity.GetSafeNormal();
+		APawn* AttackedTarget = nullptr;
+
+		for (APawn* Target : Targets)
+		{
+			const FVector2D ToTarget = FVector2D(Target->GetActorLocation()) - Agent.Position;
+
+			if (ToTarget.SizeSquared() <= EngageDistanceSquared && FVector2D::DotProduct(Heading, ToTarget.GetSafeNormal()) >= 0.5f)
+			{
+				AttackedTarget = Target;
+				break;
+			}
+		}
+
+		// An NPC already holding a slot keeps attacking that target while in range, even when walking around it to
+		// reach the slot, unless it heads for another player pawn instead.
+		int32 RingIndex = Rings.IndexOfByPredicate([&Character](const FSurroundRing& Ring) { return Ring.SlotOwners.Contains(Character); });
+
+		if (RingIndex != INDEX_NONE)
+		{
+			const AActor* HeldTarget = Rings[RingIndex].Target.Get();
+			const bool bHeldInRange = HeldTarget && FVector2D::DistSquared(FVector2D(HeldTarget->GetActorLocation()), Agent.Position) <= EngageDistanceSquared;
+
+			if (!bHeldInRange || (AttackedTarget && AttackedTarget != HeldTarget))
+			{
+				RingIndex = INDEX_NONE;
+			}
+		}
+
+		if (RingIndex == INDEX_NONE && AttackedTarget)
+		{
+			RingIndex = Rings.IndexOfByPredicate([AttackedTarget](const FSurroundRing& Ring) { return Ring.Target == AttackedTarget; });
+
+			if (RingIndex == INDEX_NONE)
+			{
+				RingIndex = Rings.AddDefaulted();
+				Rings[RingIndex].Target = AttackedTarget;
+			}
+		}
+
+		if (RingIndex != INDEX_NONE)
+		{
+			Attackers.Add({ Solver.Agents.Num() - 1, RingIndex, IsOnFinalLeg(Character.Get()) });
+		}
+	}
+
+	AssignSurroundSlots(Attackers);
+
+	Solver.BuildGrid();
+
+	SET_DWORD_STAT(STAT_CrowdAgents, Solver.Agents.Num());
+	SET_DWORD_STAT(STAT_CrowdAgentsSolved, NumSolved);
+	SET_DWORD_STAT(STAT_CrowdAttackers, Attackers.Num());
+
+	return NumSolved > 0 ? Solver.Agents.Num() : 0;
+}
+
+void UCrowdAvoidanceSubsystem::AssignSurroundSlots(const TArray<FAttacker>& Attackers)
+{
+	const int32 NumSlots = FMath::Max(CVarCrowdSurroundSlots.GetValueOnGameThread(), 0);
+	const float EngageDistanceSquared = FMath::Square(CVarCrowdSurroundEngageDistance.GetValueOnGameThread());
+
+	// A slot stays with its owner, moving or standing in it, until the owner dies or is unregistered, leaves the
+	// engage distance or switches to another target.
+	for (int32 RingIndex = 0; RingIndex < Rings.Num(); ++RingIndex)
+	{
+		FSurroundRing& Ring = Rings[RingIndex];
+		Ring.SlotOwners.SetNum(NumSlots);
+
+		const AActor* Target = Ring.Target.Get();
+
+		for (TWeakObjectPtr<AMainCharacter>& Owner : Ring.SlotOwners)
+		{
+			if (!Owner.IsValid())
+			{
+				continue;
+			}
+
+			const bool bSwitchedTarget = Attackers.ContainsByPredicate([this, &Owner, RingIndex](const FAttacker& Attacker)
+			{
+				return Attacker.RingIndex != RingIndex && Characters[Attacker.AgentIndex] == Owner;
+			});
+
+			if (Target == nullptr || bSwitchedTarget || !Characters.Contains(Owner)
+				|| FVector::DistSquared2D(Owner->GetActorLocation(), Target->GetActorLocation()) > EngageDistanceSquared)
+			{
+				Owner.Reset();
+			}
+		}
+	}
+
+	for (const FAttacker& Attacker : Attackers)
+	{
+		FSurroundRing& Ring = Rings[Attacker.RingIndex];
+		const AActor* Target = Ring.Target.Get();
+		FCrowdAgent& Agent = Solver.Agents[Attacker.AgentIndex];
+		const TWeakObjectPtr<AMainCharacter>& Character = Characters[Attacker.AgentIndex];
+
+		int32 Slot = Ring.SlotOwners.IndexOfByKey(Character);
+
+		if (Slot == INDEX_NONE)
+		{
+			// Take the free slot closest to the side the attacker approaches from.
+			const FVector2D Bearing = (Agent.Position - FVector2D(Target->GetActorLocation())).GetSafeNormal();
+			float BestAlignment = -UE_BIG_NUMBER;
+
+			for (int32 Candidate = 0; Candidate < NumSlots; ++Candidate)
+			{
+				if (Ring.SlotOwners[Candidate].IsValid())
+				{
+					continue;
+				}
+
+				const FVector2D SlotDirection = FVector2D(GetSlotLocation(Target, Candidate, NumSlots, 1.f) - Target->GetActorLocation());
+				const float Alignment = FVector2D::DotProduct(Bearing, SlotDirection);
+
+				if (Alignment > BestAlignment)
+				{
+					BestAlignment = Alignment;
+					Slot = Candidate;
+				}
+			}
+
+			if (Slot != INDEX_NONE)
+			{
+				Ring.SlotOwners[Slot] = Character;
+			}
+		}
+
+		const float Radius = GetSlotRadius(Target, Agent.Radius);
+		FVector Destination;
+
+		if (Slot != INDEX_NONE)
+		{
+			Destination = GetSlotLocation(Target, Slot, NumSlots, Radius);
+		}
+		else
+		{
+			const FVector TargetLocation = Target->GetActorLocation();
+			Destination = TargetLocation + FVector(Agent.Position - FVector2D(TargetLocation), 0.f).GetSafeNormal() * Radius * kWaitingRingScale;
+		}
+
+		// A straight line to the destination is only trusted once the path has no corners left. Until then path
+		// following keeps steering towards the behaviour's own goal, which it takes from GetSurroundSlot.
+		if (Attacker.bOnFinalLeg)
+		{
+			Agent.PreferredVelocity = SteerTowards(Agent.Position, FVector2D(Destination), Agent.MaxSpeed);
+		}
+	}
+
+	Rings.RemoveAll([](const FSurroundRing& Ring)
+	{
+		return !Ring.Target.IsValid() || !Ring.SlotOwners.ContainsByPredicate([](const TWeakObjectPtr<AMainCharacter>& Owner) { return Owner.IsValid(); });
+	});
+}
+
+FVector UCrowdAvoidanceSubsystem::GetSlotLocation(const AActor* Target, int32 Slot, int32 NumSlots, float Radius)
+{
+	float Sin = 0.f;
+	float Cos = 0.f;
+	FMath::SinCos(&Sin, &Cos, Slot * UE_TWO_PI / FMath::Max(NumSlots, 1));
+
+	return Target->GetActorLocation() + FVector(Cos, Sin, 0.f) * Radius;
+}
+
+float UCrowdAvoidanceSubsystem::GetSlotRadius(const AActor* Target, float AttackerRadius)
+{
+	return Target->GetSimpleCollisionRadius() + AttackerRadius + CVarCrowdSurroundGap.GetValueOnGameThread();
+}
+
+bool UCrowdAvoidanceSubsystem::GetSurroundSlot(const AMainCharacter* Attacker, FVector& OutLocation) const
+{
+	for (const FSurroundRing& Ring : Rings)
+	{
+		const int32 Slot = Ring.SlotOwners.IndexOfByPredicate([Attacker](const TWeakObjectPtr<AMainCharacter>& Owner) { return Owner.Get() == Attacker; });
+
+		if (Slot != INDEX_NONE && Ring.Target.IsValid())
+		{
+			const float Radius = GetSlotRadius(Ring.Target.Get(), Attacker->GetCapsuleComponent()->GetScaledCapsuleRadius());
+			OutLocation = GetSlotLocation(Ring.Target.Get(), Slot, Ring.SlotOwners.Num(), Radius);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void UCrowdAvoidanceSubsystem::ComputeJob(int32 Index)
+{
+	Solver.SolveAgent(Index);
+}
+
+void UCrowdAvoidanceSubsystem::ApplyJob()
+{
+	SCOPE_CYCLE_COUNTER(STAT_CrowdApply);
+
+	for (int32 AgentIndex = 0; AgentIndex < Solver.Agents.Num(); ++AgentIndex)
+	{
+		if (Solver.Agents[AgentIndex].bSolve)
+		{
+			const FVector2D& Velocity = Solver.SolvedVelocities[AgentIndex];
+			GatheredMovements[AgentIndex]->SetAvoidanceVelocity(FVector(Velocity.X, Velocity.Y, 0.f));
+		}
+	}
+}
+
+#if !UE_BUILD_SHIPPING
+namespace
+{
+	/** Pairs of agents overlapping by more than a tenth of their combined radius. */
+	int32 CountOverlaps(const TArray<FCrowdAgent>& Agents)
+	{
+		int32 NumOverlaps = 0;
+
+		for (int32 First = 0; First < Agents.Num(); ++First)
+		{
+			for (int32 Second = First + 1; Second < Agents.Num(); ++Second)
+			{
+				const float MinDistance = (Agents[First].Radius + Agents[Second].Radius) * 0.9f;
+
+				if (FVector2D::DistSquared(Agents[First].Position, Agents[Second].Position) < FMath::Square(MinDistance))
+				{
+					++NumOverlaps;
+				}
+			}
+		}
+
+		return NumOverlaps;
+	}
+
+	void RunCrowdBenchmark(const TArray<FString>& Args)
+	{
+		const int32 NumAgents = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 2) : 200;
+
+		constexpr int32 kSteps = 300;
+		constexpr float kStepSeconds = 1.f / 30.f;
+		constexpr float kAgentRadius = 35.f;
+		constexpr float kAgentSpeed = 400.f;
+
+		// Agents start evenly on a circle and all head for its center.
+		const float StartRadius = FMath::Max(2000.f, NumAgents * kAgentRadius * 3.f / UE_TWO_PI);
+		const FVector2D Goal = FVector2D::ZeroVector;
+
+		FCrowdSolver Solver;
+		Solver.Params.NeighbourRadius = CVarCrowdNeighbourRadius.GetValueOnGameThread();
+		Solver.Params.MaxNeighbours = CVarCrowdMaxNeighbours.GetValueOnGameThread();
+		Solver.Params.TimeHorizon = CVarCrowdTimeHorizon.GetValueOnGameThread();
+
+		const auto ResetAgents = [&]()
+		{
+			FRandomStream Random(0xC20D);
+			Solver.Agents.SetNum(NumAgents);
+
+			for (int32 AgentIndex = 0; AgentIndex < NumAgents; ++AgentIndex)
+			{
+				const float Angle = AgentIndex * UE_TWO_PI / NumAgents;
+
+				FCrowdAgent& Agent = Solver.Agents[AgentIndex];
+				Agent = FCrowdAgent();
+				Agent.Position = FVector2D(FMath::Cos(Angle), FMath::Sin(Angle)) * (StartRadius + Random.FRandRange(-100.f, 100.f));
+				Agent.Radius = kAgentRadius;
+				Agent.MaxSpeed = kAgentSpeed;
+			}
+		};
+
+		const auto UpdatePreferredVelocities = [&]()
+		{
+			for (FCrowdAgent& Agent : Solver.Agents)
+			{
+				Agent.PreferredVelocity = SteerTowards(Agent.Position, Goal, Agent.MaxSpeed);
+			}
+		};
+
+		const auto Integrate = [&](const TArray<FVector2D>& Velocities)
+		{
+			for (int32 AgentIndex = 0; AgentIndex < NumAgents; ++AgentIndex)
+			{
+				FCrowdAgent& Agent = Solver.Agents[AgentIndex];
+				Agent.Velocity = Velocities[AgentIndex];
+				Agent.Position += Agent.Velocity * kStepSeconds;
+			}
+		};
+
+		// Without avoidance, as the baseline for how many agents end up inside each other.
+		ResetAgents();
+		TArray<FVector2D> PreferredVelocities;
+
+		for (int32 Step = 0; Step < kSteps; ++Step)
+		{
+			UpdatePreferredVelocities();
+			PreferredVelocities.Reset();
+
+			for (const FCrowdAgent& Agent : Solver.Agents)
+			{
+				PreferredVelocities.Add(Agent.PreferredVelocity);
+			}
+
+			Integrate(PreferredVelocities);
+		}
+
+		UE_LOG(LogTankGame, Display, TEXT("Crowd benchmark: %d agents converging without avoidance end with %d overlapping pairs"),
+			NumAgents, CountOverlaps(Solver.Agents));
+
+		for (const bool bParallel : { false, true })
+		{
+			ResetAgents();
+
+			double GridSeconds = 0.0;
+			double SolveSeconds = 0.0;
+			double WorstStepSeconds = 0.0;
+
+			for (int32 Step = 0; Step < kSteps; ++Step)
+			{
+				UpdatePreferredVelocities();
+
+				const double StartTime = FPlatformTime::Seconds();
+
+				Solver.BuildGrid();
+
+				const double GridTime = FPlatformTime::Seconds();
+
+				ParallelFor(TEXT("CrowdBenchmark.Solve"), NumAgents, 32, [&Solver](int32 AgentIndex)
+				{
+					Solver.SolveAgent(AgentIndex);
+				}, bParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
+
+				const double EndTime = FPlatformTime::Seconds();
+
+				GridSeconds += GridTime - StartTime;
+				SolveSeconds += EndTime - GridTime;
+				WorstStepSeconds = FMath::Max(WorstStepSeconds, EndTime - StartTime);
+
+				Integrate(Solver.SolvedVelocities);
+			}
+
+			UE_LOG(LogTankGame, Display, TEXT("Crowd benchmark: %d agents, %s: grid %.3f ms, solve %.3f ms per step, worst step %.3f ms; %d overlapping pairs at the end"),
+				NumAgents, bParallel ? TEXT("parallel") : TEXT("single thread"),
+				GridSeconds * 1000.0 / kSteps, SolveSeconds * 1000.0 / kSteps, WorstStepSeconds * 1000.0, CountOverlaps(Solver.Agents));
+		}
+	}
+
+	FAutoConsoleCommand CrowdBenchmarkCommand(
+		TEXT("TankGame.Crowd.Benchmark"),
+		TEXT("Simulates [Agents] agents (default 200) converging on one point and logs the avoidance cost per step, single-threaded and parallel, along with how many agents end up overlapping."),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunCrowdBenchmark));
+}
+#endif
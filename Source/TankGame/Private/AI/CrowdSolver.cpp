@@ -0,0 +1,248 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+
+#include "AI/CrowdSolver.h"
+
+namespace
+{
+	/** Candidate directions per speed ring, spaced evenly starting from the preferred direction. */
+	constexpr int32 kSampleDirections = 12;
+	constexpr float kSampleSpeedFractions[] = { 1.f, 0.5f };
+
+	/**
+	 * Time until two circles RelativePosition apart touch when closing at RelativeVelocity, or -1 if they never do.
+	 * Circles already overlapping report 0 while they are still closing.
+	 */
+	float SweepCircles(const FVector2D& RelativePosition, const FVector2D& RelativeVelocity, float CombinedRadius)
+	{
+		const float DistanceSquared = RelativePosition.SizeSquared();
+		const float ClosingRate = FVector2D::DotProduct(RelativeVelocity, RelativePosition);
+
+		if (DistanceSquared < FMath::Square(CombinedRadius))
+		{
+			return ClosingRate > 0.f ? 0.f : -1.f;
+		}
+
+		const float SpeedSquared = RelativeVelocity.SizeSquared();
+
+		if (SpeedSquared < UE_KINDA_SMALL_NUMBER || ClosingRate <= 0.f)
+		{
+			return -1.f;
+		}
+
+		const float Discriminant = FMath::Square(ClosingRate) - SpeedSquared * (DistanceSquared - FMath::Square(CombinedRadius));
+
+		if (Discriminant < 0.f)
+		{
+			return -1.f;
+		}
+
+		return (ClosingRate - FMath::Sqrt(Discriminant)) / SpeedSquared;
+	}
+}
+
+FIntPoint FCrowdSolver::GetCell(const FVector2D& Position) const
+{
+	return FIntPoint(FMath::FloorToInt32(Position.X * InvCellSize), FMath::FloorToInt32(Position.Y * InvCellSize));
+}
+
+void FCrowdSolver::BuildGrid()
+{
+	InvCellSize = 1.f / FMath::Max(Params.NeighbourRadius, 1.f);
+
+	CellLookup.Reset();
+	CellStarts.Reset();
+	SortedAgents.SetNumUninitialized(Agents.Num());
+	SolvedVelocities.SetNumUninitialized(Agents.Num());
+
+	// Counting sort by cell: count, prefix sum, then scatter.
+	TArray<int32, TInlineAllocator<256>> AgentCells;
+	AgentCells.SetNumUninitialized(Agents.Num());
+
+	for (int32 AgentIndex = 0; AgentIndex < Agents.Num(); ++AgentIndex)
+	{
+		const FIntPoint Cell = GetCell(Agents[AgentIndex].Position);
+		int32 CellIndex = INDEX_NONE;
+
+		if (const int32* Found = CellLookup.Find(Cell))
+		{
+			CellIndex = *Found;
+		}
+		else
+		{
+			CellIndex = CellStarts.Add(0);
+			CellLookup.Add(Cell, CellIndex);
+		}
+
+		AgentCells[AgentIndex] = CellIndex;
+		++CellStarts[CellIndex];
+		SolvedVelocities[AgentIndex] = Agents[AgentIndex].Velocity;
+	}
+
+	int32 Start = 0;
+
+	for (int32& CellStart : CellStarts)
+	{
+		const int32 Count = CellStart;
+		CellStart = Start;
+		Start += Count;
+	}
+
+	CellStarts.Add(Start);
+
+	TArray<int32, TInlineAllocator<256>> Cursors(CellStarts);
+
+	for (int32 AgentIndex = 0; AgentIndex < Agents.Num(); ++AgentIndex)
+	{
+		SortedAgents[Cursors[AgentCells[AgentIndex]]++] = AgentIndex;
+	}
+}
+
+void FCrowdSolver::FindNeighbours(int32 AgentIndex, FNeighbourList& OutNeighbours) const
+{
+	const FCrowdAgent& Agent = Agents[AgentIndex];
+	const FIntPoint Center = GetCell(Agent.Position);
+	const int32 MaxNeighbours = FMath::Max(Params.MaxNeighbours, 1);
+
+	TArray<float, TInlineAllocator<16>> DistancesSquared;
+
+	// Cells are as large as the neighbour radius, so the 3x3 block around the agent covers it.
+	for (int32 Y = Center.Y - 1; Y <= Center.Y + 1; ++Y)
+	{
+		for (int32 X = Center.X - 1; X <= Center.X + 1; ++X)
+		{
+			const int32* CellIndex = CellLookup.Find(FIntPoint(X, Y));
+
+			if (CellIndex == nullptr)
+			{
+				continue;
+			}
+
+			for (int32 Slot = CellStarts[*CellIndex]; Slot < CellStarts[*CellIndex + 1]; ++Slot)
+			{
+				const int32 OtherIndex = SortedAgents[Slot];
+				const float DistanceSquared = FVector2D::DistSquared(Agent.Position, Agents[OtherIndex].Position);
+
+				if (OtherIndex == AgentIndex || DistanceSquared > FMath::Square(Params.NeighbourRadius))
+				{
+					continue;
+				}
+
+				// Insertion into the short list of closest neighbours.
+				int32 InsertAt = DistancesSquared.Num();
+
+				while (InsertAt > 0 && DistancesSquared[InsertAt - 1] > DistanceSquared)
+				{
+					--InsertAt;
+				}
+
+				if (InsertAt >= MaxNeighbours)
+				{
+					continue;
+				}
+
+				DistancesSquared.Insert(DistanceSquared, InsertAt);
+				OutNeighbours.Insert(OtherIndex, InsertAt);
+
+				if (OutNeighbours.Num() > MaxNeighbours)
+				{
+					DistancesSquared.Pop(EAllowShrinking::No);
+					OutNeighbours.Pop(EAllowShrinking::No);
+				}
+			}
+		}
+	}
+}
+
+float FCrowdSolver::GetTimeToImpact(const FCrowdAgent& Agent, const FVector2D& Candidate, const FNeighbourList& Neighbours) const
+{
+	float TimeToImpact = Params.TimeHorizon;
+
+	for (const int32 NeighbourIndex : Neighbours)
+	{
+		const FCrowdAgent& Neighbour = Agents[NeighbourIndex];
+
+		// Solved neighbours avoid us too, so only half of the change in velocity is ours to make.
+		const FVector2D RelativeVelocity = Neighbour.bSolve
+			? Candidate * 2.f - Agent.Velocity - Neighbour.Velocity
+			: Candidate - Neighbour.Velocity;
+
+		const float Time = SweepCircles(Neighbour.Position - Agent.Position, RelativeVelocity, Agent.Radius + Neighbour.Radius);
+
+		if (Time >= 0.f && Time < TimeToImpact)
+		{
+			TimeToImpact = Time;
+		}
+	}
+
+	return TimeToImpact;
+}
+
+void FCrowdSolver::SolveAgent(int32 AgentIndex)
+{
+	const FCrowdAgent& Agent = Agents[AgentIndex];
+
+	if (!Agent.bSolve)
+	{
+		return;
+	}
+
+	const float MaxSpeed = FMath::Max(Agent.MaxSpeed, 1.f);
+	const FVector2D Preferred = Agent.PreferredVelocity.GetClampedToMaxSize(MaxSpeed);
+
+	FNeighbourList Neighbours;
+	FindNeighbours(AgentIndex, Neighbours);
+
+	if (Neighbours.IsEmpty())
+	{
+		SolvedVelocities[AgentIndex] = Preferred;
+		return;
+	}
+
+	const float InvMaxSpeed = 1.f / MaxSpeed;
+	const float InvTimeHorizon = 1.f / FMath::Max(Params.TimeHorizon, UE_KINDA_SMALL_NUMBER);
+
+	FVector2D BestVelocity = Preferred;
+	float BestPenalty = TNumericLimits<float>::Max();
+
+	const auto Evaluate = [&](const FVector2D& Candidate)
+	{
+		const float DesiredPenalty = Params.DesiredVelocityWeight * FVector2D::Distance(Candidate, Preferred) * InvMaxSpeed;
+		const float CurrentPenalty = Params.CurrentVelocityWeight * FVector2D::Distance(Candidate, Agent.Velocity) * InvMaxSpeed;
+
+		// Cheap penalties first: a candidate already worse than the best cannot win on the collision term.
+		if (DesiredPenalty + CurrentPenalty >= BestPenalty)
+		{
+			return;
+		}
+
+		const float TimeToImpact = GetTimeToImpact(Agent, Candidate, Neighbours);
+		const float ImpactPenalty = Params.ImpactWeight / (0.1f + TimeToImpact * InvTimeHorizon);
+		const float Penalty = DesiredPenalty + CurrentPenalty + ImpactPenalty;
+
+		if (Penalty < BestPenalty)
+		{
+			BestPenalty = Penalty;
+			BestVelocity = Candidate;
+		}
+	};
+
+	Evaluate(Preferred);
+	Evaluate(FVector2D::ZeroVector);
+
+	const float BaseAngle = Preferred.IsNearlyZero() ? 0.f : FMath::Atan2(Preferred.Y, Preferred.X);
+
+	for (const float SpeedFraction : kSampleSpeedFractions)
+	{
+		for (int32 Direction = 0; Direction < kSampleDirections; ++Direction)
+		{
+			float Sin = 0.f;
+			float Cos = 0.f;
+			FMath::SinCos(&Sin, &Cos, BaseAngle + Direction * UE_TWO_PI / kSampleDirections);
+
+			Evaluate(FVector2D(Cos, Sin) * (MaxSpeed * SpeedFraction));
+		}
+	}
+
+	SolvedVelocities[AgentIndex] = BestVelocity;
+}
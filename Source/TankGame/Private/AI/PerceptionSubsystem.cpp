@@ -0,0 +1,388 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+
+#include "AI/PerceptionSubsystem.h"
+
+#include "TankGame.h"
+#include "Character/MainCharacter.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+
+DECLARE_CYCLE_STAT(TEXT("Perception Schedule"), STAT_PerceptionSchedule, STATGROUP_TankGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Perception Queries Issued"), STAT_PerceptionQueriesIssued, STATGROUP_TankGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Perception Queue Depth"), STAT_PerceptionQueueDepth, STATGROUP_TankGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Perception Queries In Flight"), STAT_PerceptionQueriesInFlight, STATGROUP_TankGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Perception Query Budget"), STAT_PerceptionQueryBudget, STATGROUP_TankGame);
+
+namespace
+{
+	TAutoConsoleVariable<int32> CVarPerceptionQueryBudget(
+		TEXT("tg.Perception.QueryBudget"),
+		24,
+		TEXT("Maximum number of line-of-sight traces issued per frame."));
+
+	TAutoConsoleVariable<float> CVarPerceptionMaxAge(
+		TEXT("tg.Perception.MaxAge"),
+		1.f,
+		TEXT("Seconds after which a cached sight result is treated as unknown."));
+
+	TAutoConsoleVariable<float> CVarPerceptionMinRefreshInterval(
+		TEXT("tg.Perception.MinRefreshInterval"),
+		0.1f,
+		TEXT("Seconds a sight result stays fresh before it competes for the query budget again."));
+
+	TAutoConsoleVariable<float> CVarPerceptionSightRange(
+		TEXT("tg.Perception.SightRange"),
+		8000.f,
+		TEXT("Targets further away than this are not visible and are never traced."));
+
+	/** Perceivers in combat refresh this many times more eagerly than idle ones. */
+	constexpr float kCombatPriorityScale = 4.f;
+
+	/** Perceivers scored and selected by one compute item. */
+	constexpr int32 kPerceiversPerChunk = 32;
+}
+
+bool UPerceptionSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UPerceptionSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	TraceDelegate.BindUObject(this, &UPerceptionSubsystem::OnTraceCompleted);
+
+	if (UGameplayJobSubsystem* GameplayJobs = Collection.InitializeDependency<UGameplayJobSubsystem>())
+	{
+		GameplayJobs->RegisterJob(this, TEXT("Perception"));
+	}
+}
+
+void UPerceptionSubsystem::Deinitialize()
+{
+	if (UGameplayJobSubsystem* GameplayJobs = GetWorld()->GetSubsystem<UGameplayJobSubsystem>())
+	{
+		GameplayJobs->UnregisterJob(this);
+	}
+
+	TraceDelegate.Unbind();
+
+	Perceivers.Empty();
+	PerceiverLookup.Empty();
+	PendingQueries.Empty();
+	Candidates.Empty();
+	ScoringChunks.Empty();
+	ScoringPerceivers.Empty();
+	ScoringResults.Empty();
+
+	Super::Deinitialize();
+}
+
+void UPerceptionSubsystem::RegisterPerceiver(APawn* Perceiver)
+{
+	if (Perceiver == nullptr || PerceiverLookup.Contains(FObjectKey(Perceiver)))
+	{
+		return;
+	}
+
+	FPerceiver& Entry = Perceivers.AddDefaulted_GetRef();
+	Entry.Pawn = Perceiver;
+	Entry.Key = FObjectKey(Perceiver);
+
+	PerceiverLookup.Add(Entry.Key, Perceivers.Num() - 1);
+}
+
+void UPerceptionSubsystem::UnregisterPerceiver(APawn* Perceiver)
+{
+	if (const int32* PerceiverIndex = PerceiverLookup.Find(FObjectKey(Perceiver)))
+	{
+		RemovePerceiverAt(*PerceiverIndex);
+	}
+}
+
+void UPerceptionSubsystem::RemovePerceiverAt(int32 PerceiverIndex)
+{
+	PerceiverLookup.Remove(Perceivers[PerceiverIndex].Key);
+	Perceivers.RemoveAtSwap(PerceiverIndex, EAllowShrinking::No);
+
+	if (Perceivers.IsValidIndex(PerceiverIndex))
+	{
+		PerceiverLookup.Add(Perceivers[PerceiverIndex].Key, PerceiverIndex);
+	}
+}
+
+int32 UPerceptionSubsystem::GatherJob(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_PerceptionSchedule);
+
+	for (int32 PerceiverIndex = Perceivers.Num() - 1; PerceiverIndex >= 0; --PerceiverIndex)
+	{
+		if (!Perceivers[PerceiverIndex].Pawn.IsValid())
+		{
+			RemovePerceiverAt(PerceiverIndex);
+		}
+	}
+
+	TArray<AActor*, TInlineAllocator<4>> Targets;
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (APawn* PlayerPawn = It->Get() ? It->Get()->GetPawn() : nullptr)
+		{
+			Targets.Add(PlayerPawn);
+		}
+	}
+
+	RefreshTargets(Targets);
+
+	ScoringTime = GetWorld()->GetTimeSeconds();
+	ScoringMinRefreshInterval = CVarPerceptionMinRefreshInterval.GetValueOnGameThread();
+	ScoringSightRange = CVarPerceptionSightRange.GetValueOnGameThread();
+	ScoringQueryBudget = FMath::Max(CVarPerceptionQueryBudget.GetValueOnGameThread(), 0);
+
+	ScoringPerceivers.Reset();
+	ScoringResults.Reset();
+
+	for (const FPerceiver& Perceiver : Perceivers)
+	{
+		const APawn* Pawn = Perceiver.Pawn.Get();
+		const AMainCharacter* Character = Cast<AMainCharacter>(Pawn);
+
+		FScoringPerceiver& Scoring = ScoringPerceivers.AddDefaulted_GetRef();
+		Scoring.Location = Pawn->GetActorLocation();
+		Scoring.ThreatScale = Character && Character->IsInCombat() ? kCombatPriorityScale : 1.f;
+		Scoring.FirstResult = ScoringResults.Num();
+		Scoring.NumResults = Perceiver.Results.Num();
+
+		for (const FSightResult& Result : Perceiver.Results)
+		{
+			FScoringResult& ScoringResult = ScoringResults.AddDefaulted_GetRef();
+			ScoringResult.TargetLocation = Result.Target->GetActorLocation();
+			ScoringResult.CheckTime = Result.CheckTime;
+			ScoringResult.bSkip = Result.bPending;
+		}
+	}
+
+	// Chunks keep their candidate arrays from frame to frame, so the heaps are not reallocated.
+	const int32 NumChunks = FMath::DivideAndRoundUp(ScoringPerceivers.Num(), kPerceiversPerChunk);
+
+	if (ScoringChunks.Num() < NumChunks)
+	{
+		ScoringChunks.SetNum(NumChunks);
+	}
+
+	return NumChunks;
+}
+
+void UPerceptionSubsystem::PushCandidate(TArray<FQueryCandidate>& Heap, const FQueryCandidate& Candidate) const
+{
+	// Keep the ScoringQueryBudget highest priority candidates in a min-heap so selection is O(N log Budget).
+	const auto LowestPriorityFirst = [](const FQueryCandidate& A, const FQueryCandidate& B) { return A.Priority < B.Priority; };
+
+	if (Heap.Num() < ScoringQueryBudget)
+	{
+		Heap.HeapPush(Candidate, LowestPriorityFirst);
+	}
+	else if (ScoringQueryBudget > 0 && Candidate.Priority > Heap.HeapTop().Priority)
+	{
+		Heap.HeapPopDiscard(LowestPriorityFirst, EAllowShrinking::No);
+		Heap.HeapPush(Candidate, LowestPriorityFirst);
+	}
+}
+
+void UPerceptionSubsystem::ComputeJob(int32 Index)
+{
+	FScoringChunk& Chunk = ScoringChunks[Index];
+	Chunk.Candidates.Reset();
+	Chunk.QueueDepth = 0;
+
+	const int32 FirstPerceiver = Index * kPerceiversPerChunk;
+	const int32 LastPerceiver = FMath::Min(FirstPerceiver + kPerceiversPerChunk, ScoringPerceivers.Num());
+
+	for (int32 PerceiverIndex = FirstPerceiver; PerceiverIndex < LastPerceiver; ++PerceiverIndex)
+	{
+		const FScoringPerceiver& Scoring = ScoringPerceivers[PerceiverIndex];
+
+		for (int32 ResultIndex = 0; ResultIndex < Scoring.NumResults; ++ResultIndex)
+		{
+			FScoringResult& Result = ScoringResults[Scoring.FirstResult + ResultIndex];
+			const double Age = ScoringTime - Result.CheckTime;
+
+			if (Result.bSkip || Age < ScoringMinRefreshInterval)
+			{
+				Result.bSkip = true;
+				continue;
+			}
+
+			const double Distance = FVector::Dist(Scoring.Location, Result.TargetLocation);
+
+			Result.bOutOfRange = Distance > ScoringSightRange;
+
+			if (Result.bOutOfRange)
+			{
+				continue;
+			}
+
+			++Chunk.QueueDepth;
+
+			FQueryCandidate Candidate;
+			Candidate.Priority = FMath::Min(Age, 10.0) * Scoring.ThreatScale * ScoringSightRange / FMath::Max(Distance, 500.0);
+			Candidate.PerceiverIndex = PerceiverIndex;
+			Candidate.ResultIndex = ResultIndex;
+
+			PushCandidate(Chunk.Candidates, Candidate);
+		}
+	}
+}
+
+void UPerceptionSubsystem::ApplyJob()
+{
+	SCOPE_CYCLE_COUNTER(STAT_PerceptionSchedule);
+
+	for (int32 PerceiverIndex = 0; PerceiverIndex < Perceivers.Num(); ++PerceiverIndex)
+	{
+		FPerceiver& Perceiver = Perceivers[PerceiverIndex];
+		const FScoringPerceiver& Scoring = ScoringPerceivers[PerceiverIndex];
+
+		for (int32 ResultIndex = 0; ResultIndex < Perceiver.Results.Num(); ++ResultIndex)
+		{
+			const FScoringResult& ScoringResult = ScoringResults[Scoring.FirstResult + ResultIndex];
+
+			if (!ScoringResult.bSkip && ScoringResult.bOutOfRange)
+			{
+				FSightResult& Result = Perceiver.Results[ResultIndex];
+				Result.bVisible = false;
+				Result.CheckTime = ScoringTime;
+			}
+		}
+	}
+
+	// The overall top ScoringQueryBudget is among the chunks' own top ScoringQueryBudget, so only those are merged.
+	const int32 NumChunks = FMath::DivideAndRoundUp(ScoringPerceivers.Num(), kPerceiversPerChunk);
+	int32 QueueDepth = 0;
+	Candidates.Reset();
+
+	for (int32 ChunkIndex = 0; ChunkIndex < NumChunks; ++ChunkIndex)
+	{
+		QueueDepth += ScoringChunks[ChunkIndex].QueueDepth;
+
+		for (const FQueryCandidate& Candidate : ScoringChunks[ChunkIndex].Candidates)
+		{
+			PushCandidate(Candidates, Candidate);
+		}
+	}
+
+	for (const FQueryCandidate& Candidate : Candidates)
+	{
+		FPerceiver& Perceiver = Perceivers[Candidate.PerceiverIndex];
+		IssueQuery(Perceiver, Perceiver.Results[Candidate.ResultIndex]);
+	}
+
+	SET_DWORD_STAT(STAT_PerceptionQueueDepth, QueueDepth);
+	SET_DWORD_STAT(STAT_PerceptionQueriesInFlight, PendingQueries.Num());
+	SET_DWORD_STAT(STAT_PerceptionQueryBudget, ScoringQueryBudget);
+}
+
+void UPerceptionSubsystem::RefreshTargets(const TArray<AActor*, TInlineAllocator<4>>& Targets)
+{
+	for (FPerceiver& Perceiver : Perceivers)
+	{
+		Perceiver.Results.RemoveAllSwap([&Targets](const FSightResult& Result)
+		{
+			return !Result.Target.IsValid() || !Targets.Contains(Result.Target.Get());
+		});
+
+		for (AActor* Target : Targets)
+		{
+			if (Target != Perceiver.Pawn.Get() && !Perceiver.Results.ContainsByPredicate([Target](const FSightResult& Result) { return Result.Target == Target; }))
+			{
+				Perceiver.Results.AddDefaulted_GetRef().Target = Target;
+			}
+		}
+	}
+}
+
+void UPerceptionSubsystem::IssueQuery(FPerceiver& Perceiver, FSightResult& Result)
+{
+	const APawn* Pawn = Perceiver.Pawn.Get();
+	const AActor* Target = Result.Target.Get();
+
+	FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(PerceptionSight), false, Pawn);
+
+	const uint32 QueryId = ++NextQueryId;
+	PendingQueries.Add(QueryId, FPendingQuery{ Perceiver.Key, FObjectKey(Target) });
+
+	GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, Pawn->GetPawnViewLocation(), Target->GetActorLocation(),
+		ECC_Visibility, TraceParams, FCollisionResponseParams::DefaultResponseParam, &TraceDelegate, QueryId);
+
+	Result.bPending = true;
+
+	INC_DWORD_STAT(STAT_PerceptionQueriesIssued);
+}
+
+void UPerceptionSubsystem::OnTraceCompleted(const FTraceHandle& Handle, FTraceDatum& Datum)
+{
+	FPendingQuery Query;
+
+	if (!PendingQueries.RemoveAndCopyValue(Datum.UserData, Query))
+	{
+		return;
+	}
+
+	const int32* PerceiverIndex = PerceiverLookup.Find(Query.Perceiver);
+
+	if (PerceiverIndex == nullptr)
+	{
+		return;
+	}
+
+	for (FSightResult& Result : Perceivers[*PerceiverIndex].Results)
+	{
+		if (FObjectKey(Result.Target.Get()) == Query.Target)
+		{
+			const FHitResult* BlockingHit = Datum.OutHits.FindByPredicate([](const FHitResult& Hit) { return Hit.bBlockingHit; });
+
+			Result.bVisible = BlockingHit == nullptr || FObjectKey(BlockingHit->GetActor()) == Query.Target;
+			Result.CheckTime = GetWorld()->GetTimeSeconds();
+			Result.bPending = false;
+			break;
+		}
+	}
+}
+
+const UPerceptionSubsystem::FSightResult* UPerceptionSubsystem::FindResult(const APawn* Perceiver, const AActor* Target) const
+{
+	const int32* PerceiverIndex = PerceiverLookup.Find(FObjectKey(Perceiver));
+
+	if (PerceiverIndex == nullptr)
+	{
+		return nullptr;
+	}
+
+	return Perceivers[*PerceiverIndex].Results.FindByPredicate([Target](const FSightResult& Result) { return Result.Target == Target; });
+}
+
+bool UPerceptionSubsystem::GetSightResult(const APawn* Perceiver, const AActor* Target, bool& bOutVisible, float& OutAge) const
+{
+	const FSightResult* Result = FindResult(Perceiver, Target);
+
+	if (Result == nullptr || Result->CheckTime < 0.0)
+	{
+		return false;
+	}
+
+	bOutVisible = Result->bVisible;
+	OutAge = GetWorld()->GetTimeSeconds() - Result->CheckTime;
+
+	return true;
+}
+
+bool UPerceptionSubsystem::HasLineOfSight(const APawn* Perceiver, const AActor* Target) const
+{
+	bool bVisible = false;
+	float Age = 0.f;
+
+	return GetSightResult(Perceiver, Target, bVisible, Age) && bVisible && Age <= CVarPerceptionMaxAge.GetValueOnGameThread();
+}
@@ -0,0 +1,158 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+
+#include "AI/TankAIController.h"
+
+#include "ChaosVehicleMovementComponent.h"
+#include "AI/TankPathPlannerSubsystem.h"
+#include "Engine/World.h"
+#include "Tank/Tank.h"
+
+ATankAIController::ATankAIController()
+{
+	PrimaryActorTick.bCanEverTick = true;
+}
+
+void ATankAIController::OnPossess(APawn* InPawn)
+{
+	Super::OnPossess(InPawn);
+
+	ControlledTank = Cast<ATank>(InPawn);
+}
+
+void ATankAIController::OnUnPossess()
+{
+	StopTank();
+	ControlledTank = nullptr;
+
+	Super::OnUnPossess();
+}
+
+void ATankAIController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	CancelPendingRequest();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ATankAIController::MoveTankTo(const FVector& Goal)
+{
+	UTankPathPlannerSubsystem* Planner = GetWorld()->GetSubsystem<UTankPathPlannerSubsystem>();
+
+	if (ControlledTank == nullptr || Planner == nullptr)
+	{
+		return;
+	}
+
+	CancelPendingRequest();
+
+	PendingRequestId = Planner->RequestPath(ControlledTank->GetActorLocation(), ControlledTank->GetActorRotation().Yaw, Goal,
+		FOnTankPathPlanned::CreateUObject(this, &ATankAIController::OnPathPlanned));
+}
+
+void ATankAIController::StopTank()
+{
+	CancelPendingRequest();
+	CurrentPath.Reset();
+
+	ApplyInputs(0.f, 0.f, 1.f);
+}
+
+void ATankAIController::CancelPendingRequest()
+{
+	if (PendingRequestId == 0)
+	{
+		return;
+	}
+
+	if (UTankPathPlannerSubsystem* Planner = GetWorld()->GetSubsystem<UTankPathPlannerSubsystem>())
+	{
+		Planner->CancelRequest(PendingRequestId);
+	}
+
+	PendingRequestId = 0;
+}
+
+void ATankAIController::OnPathPlanned(TSharedPtr<const FTankPath> Path)
+{
+	PendingRequestId = 0;
+
+	// A partial path still gets the tank as close as the planner could; an empty one means there is nowhere to go.
+	if (!Path.IsValid() || Path->Poses.Num() < 2)
+	{
+		StopTank();
+		return;
+	}
+
+	CurrentPath = MoveTemp(Path);
+	PathIndex = 0;
+}
+
+void ATankAIController::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (ControlledTank == nullptr || !CurrentPath.IsValid())
+	{
+		return;
+	}
+
+	const TArray<FTankPathPose>& Poses = CurrentPath->Poses;
+	const FVector2D TankLocation(ControlledTank->GetActorLocation());
+
+	// Advance to the closest pose, looking only a short way ahead so loops in the path are not skipped.
+	double ClosestDistanceSquared = FVector2D::DistSquared(TankLocation, FVector2D(Poses[PathIndex].Location));
+
+	for (int32 Index = PathIndex + 1; Index < FMath::Min(PathIndex + 8, Poses.Num()); ++Index)
+	{
+		const double DistanceSquared = FVector2D::DistSquared(TankLocation, FVector2D(Poses[Index].Location));
+
+		if (DistanceSquared < ClosestDistanceSquared)
+		{
+			ClosestDistanceSquared = DistanceSquared;
+			PathIndex = Index;
+		}
+	}
+
+	const FVector2D GoalLocation(Poses.Last().Location);
+	const double DistanceToGoal = FVector2D::Distance(TankLocation, GoalLocation);
+
+	if (DistanceToGoal <= ArrivalDistance)
+	{
+		StopTank();
+		return;
+	}
+
+	int32 TargetIndex = PathIndex;
+
+	while (TargetIndex < Poses.Num() - 1
+		&& FVector2D::DistSquared(TankLocation, FVector2D(Poses[TargetIndex].Location)) < FMath::Square(LookaheadDistance))
+	{
+		++TargetIndex;
+	}
+
+	const FVector2D ToTarget = FVector2D(Poses[TargetIndex].Location) - TankLocation;
+	const float TargetYaw = FMath::RadiansToDegrees(FMath::Atan2(ToTarget.Y, ToTarget.X));
+	const float HeadingError = FMath::FindDeltaAngleDegrees(ControlledTank->GetActorRotation().Yaw, TargetYaw);
+
+	const float Steering = FMath::Clamp(HeadingError / FullSteeringAngle, -1.f, 1.f);
+	const float TurnScale = FMath::Lerp(1.f, 0.4f, FMath::Abs(Steering));
+	const float ArrivalScale = FMath::Clamp(DistanceToGoal / (LookaheadDistance * 2.f), 0.3f, 1.f);
+
+	ApplyInputs(CruiseThrottle * TurnScale * ArrivalScale, Steering, 0.f);
+}
+
+void ATankAIController::ApplyInputs(float Throttle, float Steering, float Brake) const
+{
+	if (ControlledTank == nullptr)
+	{
+		return;
+	}
+
+	if (UChaosVehicleMovementComponent* VehicleMovement = ControlledTank->GetVehicleMovementComponent())
+	{
+		VehicleMovement->SetThrottleInput(Throttle);
+		VehicleMovement->SetSteeringInput(Steering);
+		VehicleMovement->SetBrakeInput(Brake);
+	}
+}
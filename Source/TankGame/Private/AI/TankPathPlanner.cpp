@@ -0,0 +1,213 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+
+#include "AI/TankPathPlanner.h"
+
+#include "Algo/Reverse.h"
+
+namespace
+{
+	struct FPlannerNode
+	{
+		FVector2D Location;
+		float Yaw = 0.f;
+		float Steering = 0.f;
+		float CostSoFar = 0.f;
+		int32 Parent = INDEX_NONE;
+	};
+
+	struct FOpenEntry
+	{
+		float EstimatedCost = 0.f;
+		int32 NodeIndex = INDEX_NONE;
+	};
+
+	constexpr float kSteeringSamples[] = { -1.f, -0.5f, 0.f, 0.5f, 1.f };
+
+	float SampleHeight(const FTankCostGrid& Grid, const FIntPoint& Cell)
+	{
+		return Grid.Heights[Grid.GetIndex(Cell)];
+	}
+}
+
+void FTankCostGrid::Init(const FVector2D& InOrigin, float InCellSize, int32 InSizeX, int32 InSizeY)
+{
+	Origin = InOrigin;
+	CellSize = InCellSize;
+	SizeX = InSizeX;
+	SizeY = InSizeY;
+
+	Heights.Init(0.f, SizeX * SizeY);
+	Costs.Init(BlockedCost, SizeX * SizeY);
+}
+
+FIntPoint FTankCostGrid::WorldToCell(const FVector2D& Location) const
+{
+	return FIntPoint(FMath::FloorToInt32((Location.X - Origin.X) / CellSize), FMath::FloorToInt32((Location.Y - Origin.Y) / CellSize));
+}
+
+FVector2D FTankCostGrid::CellToWorld(const FIntPoint& Cell) const
+{
+	return Origin + (FVector2D(Cell) + 0.5) * CellSize;
+}
+
+FTankPath FTankPathPlanner::PlanPath(const FTankCostGrid& Grid, const FTankPlannerParams& Params, const FVector2D& Start, float StartYaw,
+	const FVector2D& Goal)
+{
+	FTankPath Path;
+
+	const FIntPoint StartCell = Grid.WorldToCell(Start);
+	const FIntPoint GoalCell = Grid.WorldToCell(Goal);
+
+	if (!Grid.IsValidCell(StartCell) || !Grid.IsValidCell(GoalCell) || Grid.Costs[Grid.GetIndex(GoalCell)] == FTankCostGrid::BlockedCost)
+	{
+		return Path;
+	}
+
+	// Each arc must leave its cell, otherwise expansions pile up on their own (cell, heading) state.
+	const float StepLength = Grid.CellSize * 1.5f;
+	const float MaxCurvature = 1.f / FMath::Max(Params.TurningRadius, 1.f);
+	const float MaxRise = StepLength * FMath::Tan(FMath::DegreesToRadians(Params.MaxSlopeDegrees));
+	const float HeadingBinSize = UE_TWO_PI / Params.HeadingBins;
+
+	const auto GetStateKey = [&Grid, &Params, HeadingBinSize](const FIntPoint& Cell, float Yaw)
+	{
+		const int32 HeadingBin = FMath::FloorToInt32(FMath::UnwindRadians(Yaw) / HeadingBinSize + Params.HeadingBins) % Params.HeadingBins;
+		return Grid.GetIndex(Cell) * Params.HeadingBins + HeadingBin;
+	};
+
+	const auto Heuristic = [&Goal](const FVector2D& Location)
+	{
+		return static_cast<float>(FVector2D::Distance(Location, Goal));
+	};
+
+	const auto LowestCostFirst = [](const FOpenEntry& A, const FOpenEntry& B) { return A.EstimatedCost < B.EstimatedCost; };
+
+	TArray<FPlannerNode> Nodes;
+	TArray<FOpenEntry> Open;
+	TMap<int32, float> BestCostByState;
+
+	Nodes.Reserve(Params.MaxExpansions);
+	Open.Reserve(Params.MaxExpansions);
+	BestCostByState.Reserve(Params.MaxExpansions);
+
+	FPlannerNode& StartNode = Nodes.AddDefaulted_GetRef();
+	StartNode.Location = Start;
+	StartNode.Yaw = FMath::DegreesToRadians(StartYaw);
+
+	Open.HeapPush(FOpenEntry{ Heuristic(Start), 0 }, LowestCostFirst);
+	BestCostByState.Add(GetStateKey(StartCell, StartNode.Yaw), 0.f);
+
+	int32 GoalNode = INDEX_NONE;
+
+	// Expanded node nearest the goal, returned as a partial path if the goal cannot be reached.
+	int32 ClosestNode = 0;
+	float ClosestDistance = Heuristic(Start);
+
+	while (Open.Num() > 0 && Path.Expansions < Params.MaxExpansions)
+	{
+		FOpenEntry Entry;
+		Open.HeapPop(Entry, LowestCostFirst, EAllowShrinking::No);
+
+		// Copy, since expanding adds nodes and may reallocate the array.
+		const FPlannerNode Node = Nodes[Entry.NodeIndex];
+
+		if (const float* BestCost = BestCostByState.Find(GetStateKey(Grid.WorldToCell(Node.Location), Node.Yaw)); BestCost && *BestCost < Node.CostSoFar)
+		{
+			continue;
+		}
+
+		++Path.Expansions;
+
+		if (FVector2D::DistSquared(Node.Location, Goal) <= FMath::Square(Params.GoalTolerance))
+		{
+			GoalNode = Entry.NodeIndex;
+			break;
+		}
+
+		if (const float Distance = Heuristic(Node.Location); Distance < ClosestDistance)
+		{
+			ClosestDistance = Distance;
+			ClosestNode = Entry.NodeIndex;
+		}
+
+		const FIntPoint NodeCell = Grid.WorldToCell(Node.Location);
+		const float NodeHeight = SampleHeight(Grid, NodeCell);
+
+		for (const float Steering : kSteeringSamples)
+		{
+			const float Curvature = Steering * MaxCurvature;
+			const float DeltaYaw = Curvature * StepLength;
+
+			FVector2D NextLocation;
+			FVector2D MidLocation;
+
+			if (FMath::IsNearlyZero(Curvature))
+			{
+				const FVector2D Direction(FMath::Cos(Node.Yaw), FMath::Sin(Node.Yaw));
+				NextLocation = Node.Location + Direction * StepLength;
+				MidLocation = Node.Location + Direction * (StepLength * 0.5f);
+			}
+			else
+			{
+				const float Radius = 1.f / Curvature;
+				NextLocation = Node.Location + FVector2D(FMath::Sin(Node.Yaw + DeltaYaw) - FMath::Sin(Node.Yaw), FMath::Cos(Node.Yaw) - FMath::Cos(Node.Yaw + DeltaYaw)) * Radius;
+				MidLocation = Node.Location + FVector2D(FMath::Sin(Node.Yaw + DeltaYaw * 0.5f) - FMath::Sin(Node.Yaw), FMath::Cos(Node.Yaw) - FMath::Cos(Node.Yaw + DeltaYaw * 0.5f)) * Radius;
+			}
+
+			const FIntPoint NextCell = Grid.WorldToCell(NextLocation);
+			const FIntPoint MidCell = Grid.WorldToCell(MidLocation);
+
+			if (!Grid.IsValidCell(NextCell) || !Grid.IsValidCell(MidCell))
+			{
+				continue;
+			}
+
+			const uint8 NextCost = Grid.Costs[Grid.GetIndex(NextCell)];
+
+			if (NextCost == FTankCostGrid::BlockedCost || Grid.Costs[Grid.GetIndex(MidCell)] == FTankCostGrid::BlockedCost
+				|| FMath::Abs(SampleHeight(Grid, NextCell) - NodeHeight) > MaxRise)
+			{
+				continue;
+			}
+
+			const float StepCost = StepLength * (1.f + NextCost / 64.f
+				+ Params.SteeringPenalty * FMath::Abs(Steering) + Params.SteeringChangePenalty * FMath::Abs(Steering - Node.Steering));
+			const float CostSoFar = Node.CostSoFar + StepCost;
+			const float NextYaw = Node.Yaw + DeltaYaw;
+			const int32 StateKey = GetStateKey(NextCell, NextYaw);
+
+			if (const float* BestCost = BestCostByState.Find(StateKey); BestCost && *BestCost <= CostSoFar)
+			{
+				continue;
+			}
+
+			BestCostByState.Add(StateKey, CostSoFar);
+
+			FPlannerNode& NextNode = Nodes.AddDefaulted_GetRef();
+			NextNode.Location = NextLocation;
+			NextNode.Yaw = NextYaw;
+			NextNode.Steering = Steering;
+			NextNode.CostSoFar = CostSoFar;
+			NextNode.Parent = Entry.NodeIndex;
+
+			Open.HeapPush(FOpenEntry{ CostSoFar + Heuristic(NextLocation), Nodes.Num() - 1 }, LowestCostFirst);
+		}
+	}
+
+	const int32 LastNode = GoalNode != INDEX_NONE ? GoalNode : ClosestNode;
+
+	for (int32 NodeIndex = LastNode; NodeIndex != INDEX_NONE; NodeIndex = Nodes[NodeIndex].Parent)
+	{
+		const FPlannerNode& Node = Nodes[NodeIndex];
+
+		FTankPathPose& Pose = Path.Poses.AddDefaulted_GetRef();
+		Pose.Location = FVector(Node.Location, SampleHeight(Grid, Grid.WorldToCell(Node.Location)));
+		Pose.Yaw = FMath::RadiansToDegrees(FMath::UnwindRadians(Node.Yaw));
+	}
+
+	Algo::Reverse(Path.Poses);
+	Path.bReachedGoal = GoalNode != INDEX_NONE;
+
+	return Path;
+}
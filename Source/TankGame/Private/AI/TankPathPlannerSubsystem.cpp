@@ -0,0 +1,408 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+
+#include "AI/TankPathPlannerSubsystem.h"
+
+#include "TankGame.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Shared/TankGameSettings.h"
+
+DECLARE_CYCLE_STAT(TEXT("Tank Path Planner"), STAT_TankPathPlanner, STATGROUP_TankGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Tank Paths In Flight"), STAT_TankPathsInFlight, STATGROUP_TankGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Tank Paths Planned"), STAT_TankPathsPlanned, STATGROUP_TankGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Tank Paths From Cache"), STAT_TankPathsFromCache, STATGROUP_TankGame);
+DECLARE_MEMORY_STAT(TEXT("Tank Path Grid Memory"), STAT_TankPathGridMemory, STATGROUP_TankGame);
+
+namespace
+{
+	constexpr int32 kMaxCachedPathsPerGoal = 4;
+	constexpr float kReuseHeadingTolerance = 30.f;
+	constexpr float kGridTraceHeight = 100000.f;
+
+	TSharedPtr<const FTankPath> PlanOnWorker(TSharedPtr<const FTankCostGrid> Grid, FTankPlannerParams Params, FVector2D Start, float StartYaw,
+		FVector2D Goal)
+	{
+		return MakeShared<FTankPath>(FTankPathPlanner::PlanPath(*Grid, Params, Start, StartYaw, Goal));
+	}
+}
+
+bool UTankPathPlannerSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UTankPathPlannerSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	const UTankGameSettings* Settings = GetDefault<UTankGameSettings>();
+
+	PlannerParams.TurningRadius = Settings->TankTurningRadius;
+	PlannerParams.MaxSlopeDegrees = Settings->TankMaxSlope;
+	PlannerParams.GoalTolerance = Settings->PathGridCellSize * 1.5f;
+
+	const int32 CellsPerSide = FMath::CeilToInt32(Settings->PathGridHalfExtent * 2.f / Settings->PathGridCellSize);
+
+	PendingGrid = MakeUnique<FTankCostGrid>();
+	PendingGrid->Init(Settings->PathGridCenter - FVector2D(Settings->PathGridHalfExtent), Settings->PathGridCellSize, CellsPerSide, CellsPerSide);
+	NextGridRow = 0;
+}
+
+void UTankPathPlannerSubsystem::Deinitialize()
+{
+	// Tasks hold their own reference to the grid, so they can finish safely after this.
+	Jobs.Empty();
+	DeferredRequests.Empty();
+	CachedResults.Empty();
+	PathCache.Empty();
+	PendingGrid.Reset();
+
+	if (CostGrid)
+	{
+		DEC_MEMORY_STAT_BY(STAT_TankPathGridMemory, CostGrid->GetAllocatedSize());
+		CostGrid.Reset();
+	}
+
+	Super::Deinitialize();
+}
+
+TStatId UTankPathPlannerSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UTankPathPlannerSubsystem, STATGROUP_Tickables);
+}
+
+void UTankPathPlannerSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_TankPathPlanner);
+
+	Super::Tick(DeltaTime);
+
+	if (PendingGrid)
+	{
+		SampleGridRows(GetDefault<UTankGameSettings>()->PathGridRowsPerFrame);
+	}
+
+	if (CachedResults.Num() > 0)
+	{
+		TArray<TPair<FPathRequest, TSharedPtr<const FTankPath>>> Results = MoveTemp(CachedResults);
+
+		for (TPair<FPathRequest, TSharedPtr<const FTankPath>>& Result : Results)
+		{
+			Result.Key.OnPlanned.ExecuteIfBound(Result.Value);
+		}
+	}
+
+	for (int32 JobIndex = Jobs.Num() - 1; JobIndex >= 0; --JobIndex)
+	{
+		if (!Jobs[JobIndex].Task.IsCompleted())
+		{
+			continue;
+		}
+
+		// Remove before calling out, so callbacks may request new paths.
+		FPlanJob Job = MoveTemp(Jobs[JobIndex]);
+		Jobs.RemoveAtSwap(JobIndex, EAllowShrinking::No);
+
+		const TSharedPtr<const FTankPath> Path = Job.Task.GetResult();
+
+		if (Path->bReachedGoal)
+		{
+			AddToCache(Job.GoalCell, Path);
+		}
+
+		for (FPathRequest& Request : Job.Requests)
+		{
+			Request.OnPlanned.ExecuteIfBound(Path);
+		}
+	}
+
+	SET_DWORD_STAT(STAT_TankPathsInFlight, Jobs.Num());
+}
+
+void UTankPathPlannerSubsystem::SampleGridRows(int32 NumRows)
+{
+	const FCollisionObjectQueryParams ObjectParams(ECC_WorldStatic);
+	const FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(TankPathGrid), false);
+
+	if (!GridTraceDelegate.IsBound())
+	{
+		GridTraceDelegate.BindUObject(this, &UTankPathPlannerSubsystem::OnGridTraceDone);
+	}
+
+	// Traces run asynchronously alongside the frame and report back through OnGridTraceDone, so only issuing them costs game thread time.
+	const int32 EndRow = FMath::Min(NextGridRow + FMath::Max(NumRows, 1), PendingGrid->SizeY);
+
+	for (; NextGridRow < EndRow; ++NextGridRow)
+	{
+		for (int32 CellX = 0; CellX < PendingGrid->SizeX; ++CellX)
+		{
+			const FIntPoint Cell(CellX, NextGridRow);
+			const FVector2D Location = PendingGrid->CellToWorld(Cell);
+
+			GetWorld()->AsyncLineTraceByObjectType(EAsyncTraceType::Single, FVector(Location, kGridTraceHeight), FVector(Location, -kGridTraceHeight),
+				ObjectParams, TraceParams, &GridTraceDelegate, static_cast<uint32>(PendingGrid->GetIndex(Cell)));
+
+			++NumGridTracesInFlight;
+		}
+	}
+
+	if (NextGridRow >= PendingGrid->SizeY && NumGridTracesInFlight == 0)
+	{
+		FinishGrid();
+	}
+}
+
+void UTankPathPlannerSubsystem::OnGridTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum)
+{
+	--NumGridTracesInFlight;
+
+	if (!PendingGrid || TraceDatum.OutHits.IsEmpty())
+	{
+		return;
+	}
+
+	const FHitResult& Hit = TraceDatum.OutHits[0];
+	const int32 CellIndex = static_cast<int32>(TraceDatum.UserData);
+	const float MaxSlope = PlannerParams.MaxSlopeDegrees;
+	const float Slope = FMath::RadiansToDegrees(FMath::Acos(FMath::Clamp(Hit.ImpactNormal.Z, -1.0, 1.0)));
+
+	PendingGrid->Heights[CellIndex] = Hit.ImpactPoint.Z;
+	PendingGrid->Costs[CellIndex] = Slope > MaxSlope ? FTankCostGrid::BlockedCost : static_cast<uint8>(Slope / MaxSlope * 128.f);
+}
+
+void UTankPathPlannerSubsystem::FinishGrid()
+{
+	CostGrid = TSharedPtr<const FTankCostGrid>(PendingGrid.Release());
+
+	INC_MEMORY_STAT_BY(STAT_TankPathGridMemory, CostGrid->GetAllocatedSize());
+	UE_LOG(LogTankGame, Log, TEXT("TankPathPlanner: sampled %dx%d cost grid (%llu bytes)"), CostGrid->SizeX, CostGrid->SizeY,
+		static_cast<uint64>(CostGrid->GetAllocatedSize()));
+
+	for (FPathRequest& Request : DeferredRequests)
+	{
+		StartRequest(MoveTemp(Request));
+	}
+
+	DeferredRequests.Empty();
+}
+
+uint32 UTankPathPlannerSubsystem::RequestPath(const FVector& Start, float StartYaw, const FVector& Goal, FOnTankPathPlanned OnPlanned)
+{
+	FPathRequest Request;
+	Request.RequestId = ++NextRequestId;
+	Request.Start = FVector2D(Start);
+	Request.StartYaw = StartYaw;
+	Request.Goal = FVector2D(Goal);
+	Request.OnPlanned = MoveTemp(OnPlanned);
+
+	const uint32 RequestId = Request.RequestId;
+
+	if (CostGrid)
+	{
+		StartRequest(MoveTemp(Request));
+	}
+	else
+	{
+		DeferredRequests.Add(MoveTemp(Request));
+	}
+
+	return RequestId;
+}
+
+void UTankPathPlannerSubsystem::CancelRequest(uint32 RequestId)
+{
+	const auto MatchesRequest = [RequestId](const FPathRequest& Request) { return Request.RequestId == RequestId; };
+
+	DeferredRequests.RemoveAll(MatchesRequest);
+	CachedResults.RemoveAll([&MatchesRequest](const TPair<FPathRequest, TSharedPtr<const FTankPath>>& Result) { return MatchesRequest(Result.Key); });
+
+	// The task keeps running; its result still feeds the cache.
+	for (FPlanJob& Job : Jobs)
+	{
+		Job.Requests.RemoveAll(MatchesRequest);
+	}
+}
+
+void UTankPathPlannerSubsystem::StartRequest(FPathRequest&& Request)
+{
+	if (TSharedPtr<const FTankPath> CachedPath = FindReusablePath(Request))
+	{
+		INC_DWORD_STAT(STAT_TankPathsFromCache);
+
+		CachedResults.Emplace(MoveTemp(Request), MoveTemp(CachedPath));
+		return;
+	}
+
+	const uint64 JobKey = MakeJobKey(Request);
+
+	if (FPlanJob* ExistingJob = Jobs.FindByPredicate([JobKey](const FPlanJob& Job) { return Job.Key == JobKey; }))
+	{
+		ExistingJob->Requests.Add(MoveTemp(Request));
+		return;
+	}
+
+	INC_DWORD_STAT(STAT_TankPathsPlanned);
+
+	FPlanJob& Job = Jobs.AddDefaulted_GetRef();
+	Job.Key = JobKey;
+	Job.GoalCell = CostGrid->WorldToCell(Request.Goal);
+	Job.Task = UE::Tasks::Launch(UE_SOURCE_LOCATION,
+		[Grid = CostGrid, Params = PlannerParams, Start = Request.Start, StartYaw = Request.StartYaw, Goal = Request.Goal]()
+		{
+			return PlanOnWorker(Grid, Params, Start, StartYaw, Goal);
+		});
+	Job.Requests.Add(MoveTemp(Request));
+}
+
+uint64 UTankPathPlannerSubsystem::MakeJobKey(const FPathRequest& Request) const
+{
+	const uint64 StartIndex = static_cast<uint32>(CostGrid->GetIndex(CostGrid->WorldToCell(Request.Start)));
+	const uint64 GoalIndex = static_cast<uint32>(CostGrid->GetIndex(CostGrid->WorldToCell(Request.Goal)));
+	const uint64 HeadingBin = static_cast<uint32>(FMath::FloorToInt32((FRotator::NormalizeAxis(Request.StartYaw) + 180.f) / 22.5f)) & 0xF;
+
+	return GoalIndex << 36 | StartIndex << 4 | HeadingBin;
+}
+
+TSharedPtr<const FTankPath> UTankPathPlannerSubsystem::FindReusablePath(const FPathRequest& Request) const
+{
+	const TArray<TSharedPtr<const FTankPath>>* CachedPaths = PathCache.Find(CostGrid->WorldToCell(Request.Goal));
+
+	if (CachedPaths == nullptr)
+	{
+		return nullptr;
+	}
+
+	const double JoinDistanceSquared = FMath::Square(CostGrid->CellSize * 1.5f);
+
+	for (const TSharedPtr<const FTankPath>& CachedPath : *CachedPaths)
+	{
+		for (int32 PoseIndex = 0; PoseIndex < CachedPath->Poses.Num(); ++PoseIndex)
+		{
+			const FTankPathPose& Pose = CachedPath->Poses[PoseIndex];
+
+			if (FVector2D::DistSquared(FVector2D(Pose.Location), Request.Start) > JoinDistanceSquared
+				|| FMath::Abs(FMath::FindDeltaAngleDegrees(Pose.Yaw, Request.StartYaw)) > kReuseHeadingTolerance)
+			{
+				continue;
+			}
+
+			// Join the cached path here: start pose, then the rest of the cached path.
+			TSharedPtr<FTankPath> JoinedPath = MakeShared<FTankPath>();
+			JoinedPath->bReachedGoal = true;
+			JoinedPath->Poses.Reserve(CachedPath->Poses.Num() - PoseIndex);
+
+			FTankPathPose& StartPose = JoinedPath->Poses.AddDefaulted_GetRef();
+			StartPose.Location = FVector(Request.Start, Pose.Location.Z);
+			StartPose.Yaw = Request.StartYaw;
+
+			JoinedPath->Poses.Append(CachedPath->Poses.GetData() + PoseIndex + 1, CachedPath->Poses.Num() - PoseIndex - 1);
+
+			return JoinedPath;
+		}
+	}
+
+	return nullptr;
+}
+
+void UTankPathPlannerSubsystem::AddToCache(const FIntPoint& GoalCell, const TSharedPtr<const FTankPath>& Path)
+{
+	TArray<TSharedPtr<const FTankPath>>& CachedPaths = PathCache.FindOrAdd(GoalCell);
+
+	if (CachedPaths.Num() >= kMaxCachedPathsPerGoal)
+	{
+		CachedPaths.RemoveAt(0);
+	}
+
+	CachedPaths.Add(Path);
+}
+
+#if !UE_BUILD_SHIPPING
+namespace
+{
+	TSharedPtr<const FTankCostGrid> MakeBenchmarkGrid()
+	{
+		// Open ground with scattered impassable blocks, a 2 km square at 5 m cells.
+		TSharedPtr<FTankCostGrid> Grid = MakeShared<FTankCostGrid>();
+		Grid->Init(FVector2D(-100000.0), 500.f, 400, 400);
+
+		FRandomStream Random(0x7A4B);
+
+		for (int32 CellIndex = 0; CellIndex < Grid->Costs.Num(); ++CellIndex)
+		{
+			Grid->Costs[CellIndex] = static_cast<uint8>(Random.RandRange(0, 32));
+		}
+
+		for (int32 Block = 0; Block < 300; ++Block)
+		{
+			const FIntPoint Corner(Random.RandRange(0, Grid->SizeX - 8), Random.RandRange(0, Grid->SizeY - 8));
+
+			for (int32 Y = 0; Y < 6; ++Y)
+			{
+				for (int32 X = 0; X < 6; ++X)
+				{
+					Grid->Costs[Grid->GetIndex(Corner + FIntPoint(X, Y))] = FTankCostGrid::BlockedCost;
+				}
+			}
+		}
+
+		return Grid;
+	}
+
+	void RunTankPathBenchmark(const TArray<FString>& Args, UWorld* World)
+	{
+		const int32 NumTanks = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 50;
+
+		const UTankPathPlannerSubsystem* Planner = World ? World->GetSubsystem<UTankPathPlannerSubsystem>() : nullptr;
+		TSharedPtr<const FTankCostGrid> Grid = Planner ? Planner->GetCostGrid() : nullptr;
+		const FTankPlannerParams Params = Planner ? Planner->GetPlannerParams() : FTankPlannerParams();
+
+		if (!Grid)
+		{
+			Grid = MakeBenchmarkGrid();
+		}
+
+		const FVector2D GridSize(Grid->SizeX * Grid->CellSize, Grid->SizeY * Grid->CellSize);
+		FRandomStream Random(0x50);
+
+		TArray<UE::Tasks::TTask<TSharedPtr<const FTankPath>>> Tasks;
+		Tasks.Reserve(NumTanks);
+
+		const double StartTime = FPlatformTime::Seconds();
+
+		for (int32 TankIndex = 0; TankIndex < NumTanks; ++TankIndex)
+		{
+			const FVector2D Start = Grid->Origin + GridSize * FVector2D(Random.FRandRange(0.1f, 0.4f), Random.FRandRange(0.1f, 0.9f));
+			const FVector2D Goal = Grid->Origin + GridSize * FVector2D(Random.FRandRange(0.6f, 0.9f), Random.FRandRange(0.1f, 0.9f));
+			const float StartYaw = Random.FRandRange(-180.f, 180.f);
+
+			Tasks.Add(UE::Tasks::Launch(UE_SOURCE_LOCATION, [Grid, Params, Start, StartYaw, Goal]()
+			{
+				return PlanOnWorker(Grid, Params, Start, StartYaw, Goal);
+			}));
+		}
+
+		// Blocking is fine in a development command; the planner itself never waits on the game thread.
+		UE::Tasks::Wait(Tasks);
+
+		const double Elapsed = FPlatformTime::Seconds() - StartTime;
+
+		int32 NumReached = 0;
+		int64 TotalExpansions = 0;
+
+		for (const UE::Tasks::TTask<TSharedPtr<const FTankPath>>& Task : Tasks)
+		{
+			NumReached += Task.GetResult()->bReachedGoal ? 1 : 0;
+			TotalExpansions += Task.GetResult()->Expansions;
+		}
+
+		UE_LOG(LogTankGame, Display, TEXT("Tank path benchmark: %d paths on a %dx%d grid in %.2f ms wall time, %d reached goal, %.0f expansions per path"),
+			NumTanks, Grid->SizeX, Grid->SizeY, Elapsed * 1000.0, NumReached, static_cast<double>(TotalExpansions) / NumTanks);
+	}
+
+	FAutoConsoleCommandWithWorldAndArgs TankPathBenchmarkCommand(
+		TEXT("TankGame.TankPaths.Benchmark"),
+		TEXT("Plans N tank paths (default 50) concurrently on worker threads over the world's cost grid, or a synthetic one when none is loaded, and logs the wall time."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunTankPathBenchmark));
+}
+#endif
@@ -0,0 +1,195 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+
+#include "Animation/AnimationBudgetSubsystem.h"
+
+#include "TankGame.h"
+#include "Animation/CharacterAnimInstance.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Character/MainCharacter.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+
+DECLARE_CYCLE_STAT(TEXT("Animation Budget"), STAT_AnimationBudget, STATGROUP_TankGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Anim Meshes Every Frame"), STAT_AnimMeshesRate1, STATGROUP_TankGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Anim Meshes Every 2 Frames"), STAT_AnimMeshesRate2, STATGROUP_TankGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Anim Meshes Every 4 Frames"), STAT_AnimMeshesRate4, STATGROUP_TankGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Anim Meshes Every 8 Frames"), STAT_AnimMeshesRate8, STATGROUP_TankGame);
+
+namespace
+{
+	TAutoConsoleVariable<bool> CVarAnimBudgetEnabled(
+		TEXT("tg.AnimBudget.Enabled"),
+		true,
+		TEXT("Throttle NPC animation update rates to fit tg.AnimBudget.BudgetMs."));
+
+	TAutoConsoleVariable<float> CVarAnimBudgetMs(
+		TEXT("tg.AnimBudget.BudgetMs"),
+		1.5f,
+		TEXT("Game thread time per frame, in ms, that NPC animation updates may use."));
+
+	TAutoConsoleVariable<float> CVarAnimBudgetMeshCostMs(
+		TEXT("tg.AnimBudget.MeshCostMs"),
+		0.03f,
+		TEXT("Estimated cost, in ms, of one full animation update and evaluation of an NPC mesh."));
+
+	TAutoConsoleVariable<float> CVarAnimBudgetAimOffsetDistance(
+		TEXT("tg.AnimBudget.AimOffsetDistance"),
+		2500.f,
+		TEXT("NPCs further than this from every player camera, or off-screen, do not evaluate aim offsets."));
+
+	TAutoConsoleVariable<bool> CVarAnimBudgetInterpolate(
+		TEXT("tg.AnimBudget.InterpolateSkippedFrames"),
+		true,
+		TEXT("Interpolate poses on frames a throttled mesh does not evaluate."));
+
+	constexpr uint8 kUpdateRates[] = { 1, 2, 4, 8 };
+	constexpr int32 kNumUpdateRates = UE_ARRAY_COUNT(kUpdateRates);
+
+	/** Engaging NPCs always outrank every other NPC. */
+	constexpr float kEngagingSignificance = 1000.f;
+
+	/** Significance changes slowly, so the ranking is only re-sorted every this many frames or when NPCs register. */
+	constexpr uint32 kResortInterval = 8;
+}
+
+bool UAnimationBudgetSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UAnimationBudgetSubsystem::Deinitialize()
+{
+	Characters.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId UAnimationBudgetSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UAnimationBudgetSubsystem, STATGROUP_Tickables);
+}
+
+void UAnimationBudgetSubsystem::RegisterCharacter(AMainCharacter* Character)
+{
+	if (Character && !Characters.ContainsByPredicate([Character](const FBudgetedCharacter& Budgeted) { return Budgeted.Character == Character; }))
+	{
+		Characters.AddDefaulted_GetRef().Character = Character;
+		Character->GetMesh()->bEnableUpdateRateOptimizations = true;
+		bNeedsSort = true;
+	}
+}
+
+void UAnimationBudgetSubsystem::UnregisterCharacter(AMainCharacter* Character)
+{
+	Characters.RemoveAll([Character](const FBudgetedCharacter& Budgeted) { return Budgeted.Character == Character; });
+}
+
+void UAnimationBudgetSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AnimationBudget);
+
+	Super::Tick(DeltaTime);
+
+	// Removal keeps order so the ranking from the last sort stays valid.
+	Characters.RemoveAll([](const FBudgetedCharacter& Budgeted) { return !Budgeted.Character.IsValid(); });
+
+	TArray<FVector, TInlineAllocator<4>> ViewLocations;
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (const APlayerController* PlayerController = It->Get(); PlayerController && PlayerController->PlayerCameraManager)
+		{
+			ViewLocations.Add(PlayerController->PlayerCameraManager->GetCameraLocation());
+		}
+	}
+
+	for (FBudgetedCharacter& Budgeted : Characters)
+	{
+		UpdateSignificance(Budgeted, ViewLocations);
+	}
+
+	if (bNeedsSort || ++FramesSinceSort >= kResortInterval)
+	{
+		Characters.Sort([](const FBudgetedCharacter& A, const FBudgetedCharacter& B) { return A.Significance > B.Significance; });
+		FramesSinceSort = 0;
+		bNeedsSort = false;
+	}
+
+	// Budget in full-rate mesh updates per frame. A mesh at rate N costs 1/N of an update per frame on average.
+	const bool bBudgetEnabled = CVarAnimBudgetEnabled.GetValueOnGameThread();
+	float RemainingUpdates = CVarAnimBudgetMs.GetValueOnGameThread() / FMath::Max(CVarAnimBudgetMeshCostMs.GetValueOnGameThread(), UE_KINDA_SMALL_NUMBER);
+	int32 RateCounts[kNumUpdateRates] = {};
+
+	for (FBudgetedCharacter& Budgeted : Characters)
+	{
+		int32 RateIndex = 0;
+
+		if (bBudgetEnabled && !Budgeted.Character->IsPlayerControlled())
+		{
+			// Off-screen meshes never need to be evaluated every frame.
+			RateIndex = Budgeted.bOnScreen ? 0 : 1;
+
+			while (RateIndex < kNumUpdateRates - 1 && 1.f / kUpdateRates[RateIndex] > RemainingUpdates)
+			{
+				++RateIndex;
+			}
+		}
+
+		RemainingUpdates = FMath::Max(RemainingUpdates - 1.f / kUpdateRates[RateIndex], 0.f);
+		++RateCounts[RateIndex];
+
+		ApplyUpdateRate(Budgeted, kUpdateRates[RateIndex]);
+	}
+
+	SET_DWORD_STAT(STAT_AnimMeshesRate1, RateCounts[0]);
+	SET_DWORD_STAT(STAT_AnimMeshesRate2, RateCounts[1]);
+	SET_DWORD_STAT(STAT_AnimMeshesRate4, RateCounts[2]);
+	SET_DWORD_STAT(STAT_AnimMeshesRate8, RateCounts[3]);
+}
+
+void UAnimationBudgetSubsystem::UpdateSignificance(FBudgetedCharacter& Budgeted, const TArray<FVector, TInlineAllocator<4>>& ViewLocations) const
+{
+	const AMainCharacter* Character = Budgeted.Character.Get();
+	const FVector Location = Character->GetActorLocation();
+
+	double ClosestDistanceSquared = ViewLocations.IsEmpty() ? 0.0 : TNumericLimits<double>::Max();
+
+	for (const FVector& ViewLocation : ViewLocations)
+	{
+		ClosestDistanceSquared = FMath::Min(ClosestDistanceSquared, FVector::DistSquared(ViewLocation, Location));
+	}
+
+	Budgeted.DistanceToViewer = FMath::Sqrt(ClosestDistanceSquared);
+	Budgeted.bOnScreen = Character->GetMesh()->WasRecentlyRendered(0.2f);
+
+	const float VisibilityWeight = Budgeted.bOnScreen ? 1.f : 0.25f;
+	Budgeted.Significance = VisibilityWeight * 100.f / FMath::Max(Budgeted.DistanceToViewer, 100.f);
+
+	if (Character->IsInCombat())
+	{
+		Budgeted.Significance += kEngagingSignificance;
+	}
+}
+
+void UAnimationBudgetSubsystem::ApplyUpdateRate(FBudgetedCharacter& Budgeted, uint8 UpdateRate) const
+{
+	AMainCharacter* Character = Budgeted.Character.Get();
+	USkeletalMeshComponent* Mesh = Character->GetMesh();
+
+	if (Budgeted.UpdateRate != UpdateRate)
+	{
+		Budgeted.UpdateRate = UpdateRate;
+
+		Mesh->EnableExternalTickRateControl(UpdateRate > 1);
+		Mesh->SetExternalTickRate(UpdateRate);
+		Mesh->EnableExternalInterpolation(UpdateRate > 1 && CVarAnimBudgetInterpolate.GetValueOnGameThread());
+	}
+
+	if (UCharacterAnimInstance* AnimInstance = Cast<UCharacterAnimInstance>(Mesh->GetAnimInstance()))
+	{
+		AnimInstance->bEvaluateAimOffset = Budgeted.bOnScreen && Budgeted.DistanceToViewer <= CVarAnimBudgetAimOffsetDistance.GetValueOnGameThread();
+		AnimInstance->bRunCosmeticNotifies = Budgeted.bOnScreen || UpdateRate == 1;
+	}
+}
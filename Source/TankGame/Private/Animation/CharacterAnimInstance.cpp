@@ -5,6 +5,10 @@
 
 
 #include "KismetAnimationLibrary.h"
+#include "Animation/AnimNotifies/AnimNotify_PlayParticleEffect.h"
+#include "Animation/AnimNotifies/AnimNotify_PlaySound.h"
+#include "Animation/AnimNotifies/AnimNotifyState_TimedParticleEffect.h"
+#include "Animation/AnimNotifies/AnimNotifyState_Trail.h"
 #include "Character/MainCharacter.h"
 #include "GameFramework/PawnMovementComponent.h"
 
@@ -16,35 +20,70 @@ void UCharacterAnimInstance::NativeUpdateAnimation(float DeltaSeconds)
 	{
 		MainCharacter = Cast<AMainCharacter>(TryGetPawnOwner());
 	}
+
+	Gathered.bValid = MainCharacter != nullptr;
+
+	if (MainCharacter)
+	{
+		Gathered.Velocity = MainCharacter->GetVelocity();
+		Gathered.ActorRotation = MainCharacter->GetActorRotation();
+		Gathered.ControlRotation = MainCharacter->GetControlRotation();
+		Gathered.bFalling = MainCharacter->GetMovementComponent()->IsFalling();
+		Gathered.bAiming = MainCharacter->bIsAiming;
+		Gathered.bCrouched = MainCharacter->IsCrouched();
+	}
 }
 
-void UCharacterAnimInstance::UpdateAnimationProperties(float DeltaTime)
+void UCharacterAnimInstance::NativeThreadSafeUpdateAnimation(float DeltaSeconds)
 {
-	if (MainCharacter == nullptr)
+	Super::NativeThreadSafeUpdateAnimation(DeltaSeconds);
+
+	if (!Gathered.bValid)
 	{
-		MainCharacter = Cast<AMainCharacter>(TryGetPawnOwner());
+		return;
 	}
 
-	if (MainCharacter)
-	{
-		FVector Speed = MainCharacter->GetVelocity();
-		FVector LateralSpeed = FVector(Speed.X, Speed.Y, 0);
+	const FVector LateralSpeed = FVector(Gathered.Velocity.X, Gathered.Velocity.Y, 0);
+
+	MovementSpeed = LateralSpeed.Size();
+
+	bIsInAir = Gathered.bFalling;
+
+	Direction = UKismetAnimationLibrary::CalculateDirection(Gathered.Velocity, Gathered.ActorRotation);
 
-		MovementSpeed = LateralSpeed.Size();
-		
-		bIsInAir = MainCharacter->GetMovementComponent()->IsFalling();
-		
-		Direction = UKismetAnimationLibrary::CalculateDirection(Speed, MainCharacter->GetActorRotation());
+	bIsAiming = Gathered.bAiming;
+	bIsCrouching = Gathered.bCrouched;
 
-		bIsAiming = MainCharacter->bIsAiming;
-		bIsCrouching = MainCharacter->IsCrouched();
+	// Blend back to neutral rather than snapping when the budget turns the aim offset off.
+	const FRotator DeltaRotation = bEvaluateAimOffset ? Gathered.ControlRotation - Gathered.ActorRotation : FRotator::ZeroRotator;
 
-		FRotator PawnRotation = MainCharacter->GetActorRotation();
-		FRotator ControllerRotation = MainCharacter->GetControlRotation();
-		FRotator DeltaRotation = ControllerRotation - PawnRotation;
+	FRotator Interp = FMath::RInterpTo(FRotator(AimPitch, AimYaw, 0), DeltaRotation, DeltaSeconds, 15.0f);
+	AimPitch = FMath::ClampAngle(Interp.Pitch, -90, 90);
+	AimYaw = FMath::ClampAngle(Interp.Yaw, -90, 90);
+}
+
+bool UCharacterAnimInstance::HandleNotify(const FAnimNotifyEvent& AnimNotifyEvent)
+{
+	// Returning true marks the notify as handled, which skips it.
+	if (!bRunCosmeticNotifies && (Cast<UAnimNotify_PlaySound>(AnimNotifyEvent.Notify) || Cast<UAnimNotify_PlayParticleEffect>(AnimNotifyEvent.Notify)))
+	{
+		return true;
+	}
+
+	return Super::HandleNotify(AnimNotifyEvent);
+}
 
-		FRotator Interp = FMath::RInterpTo(FRotator(AimPitch, AimYaw, 0), DeltaRotation, DeltaTime, 15.0f);
-		AimPitch = FMath::ClampAngle(Interp.Pitch, -90, 90);
-		AimYaw = FMath::ClampAngle(Interp.Yaw, -90, 90);
+bool UCharacterAnimInstance::ShouldTriggerAnimNotifyState(const UAnimNotifyState* AnimNotifyState) const
+{
+	if (!bRunCosmeticNotifies && (Cast<UAnimNotifyState_TimedParticleEffect>(AnimNotifyState) || Cast<UAnimNotifyState_Trail>(AnimNotifyState)))
+	{
+		return false;
 	}
+
+	return Super::ShouldTriggerAnimNotifyState(AnimNotifyState);
+}
+
+void UCharacterAnimInstance::UpdateAnimationProperties(float DeltaTime)
+{
+	// Intentionally empty: updating here as well would step the aim offset interpolation twice per frame.
 }
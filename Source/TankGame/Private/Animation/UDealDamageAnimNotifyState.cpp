@@ -4,11 +4,12 @@
 #include "Animation/UDealDamageAnimNotifyState.h"
 
 #include "Character/MainCharacter.h"
+#include "Shared/GameplayDebugLog.h"
 
 void UDealDamageAnimNotifyState::NotifyBegin(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation,
 	float TotalDuration, const FAnimNotifyEventReference& EventReference)
 {
-	GEngine->AddOnScreenDebugMessage(-1, 4.5f, FColor::Yellow, TEXT("DealDamageAnimNotifyState: NotifyBegin"));
+	TG_DEBUG_EVENT(EDebugEvent::AttackNotifyBegin, MeshComp->GetOwner(), 0.f);
 
 	if (AMainCharacter* Character = Cast<AMainCharacter>(MeshComp->GetOwner()))
 	{
@@ -38,13 +39,15 @@ void UDealDamageAnimNotifyState::NotifyTick(USkeletalMeshComponent* MeshComp, UA
 	//
 	// if (Hit)
 	// {
-	// 	for (const FHitResult HitResult : HitArray)
+	// 	UDamageSubsystem* DamageSubsystem = MeshComp->GetWorld()->GetSubsystem<UDamageSubsystem>();
+	//
+	// 	for (const FHitResult& HitResult : HitArray)
 	// 	{
-	// 		UGameplayStatics::ApplyDamage(HitResult.GetActor(),
+	// 		DamageSubsystem->QueueDamage(HitResult.GetActor(),
 	// 			20,													// Damage
+	// 			EDamageKind::Melee,									// Damage kind
 	// 			Cast<APawn>(MeshComp->GetOwner())->GetController(),	// Instigator
-	// 			MeshComp->GetOwner(),								// Damage Causer (Actor)
-	// 			UDamageType::StaticClass());						// Default damage type
+	// 			MeshComp->GetOwner());								// Damage Causer (Actor)
 	// 	}
 	// }
 }
@@ -52,7 +55,7 @@ void UDealDamageAnimNotifyState::NotifyTick(USkeletalMeshComponent* MeshComp, UA
 void UDealDamageAnimNotifyState::NotifyEnd(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation,
 	const FAnimNotifyEventReference& EventReference)
 {
-	GEngine->AddOnScreenDebugMessage(-1, 4.5f, FColor::Yellow, TEXT("DealDamageAnimNotifyState: NotifyEnd"));
+	TG_DEBUG_EVENT(EDebugEvent::AttackNotifyEnd, MeshComp->GetOwner(), 0.f);
 
 	if (AMainCharacter* Character = Cast<AMainCharacter>(MeshComp->GetOwner()))
 	{
@@ -3,14 +3,28 @@
 
 #include "Character/MainCharacter.h"
 
+#include "AI/CrowdAvoidanceSubsystem.h"
+#include "AI/PerceptionSubsystem.h"
+#include "Animation/AnimationBudgetSubsystem.h"
 #include "Camera/CameraComponent.h"
+#include "Character/MainCharacterMovementComponent.h"
+#include "Character/MovementLODSubsystem.h"
+#include "Character/RagdollSubsystem.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "GameFramework/SpringArmComponent.h"
+#include "Input/InputLatencyTracker.h"
 #include "Components/CapsuleComponent.h"
+#include "Combat/DamageSubsystem.h"
+#include "Combat/HealthComponent.h"
+#include "Effects/ImpactEffectSubsystem.h"
 #include "Kismet/GameplayStatics.h"
+#include "Shared/GameplayDebugLog.h"
+#include "Shared/PawnSpatialHashSubsystem.h"
+#include "Tank/Tank.h"
 
 // Sets default values
-AMainCharacter::AMainCharacter()
+AMainCharacter::AMainCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UMainCharacterMovementComponent>(CharacterMovementComponentName))
 {
  	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
@@ -45,6 +59,8 @@ AMainCharacter::AMainCharacter()
 	EquippedWeapon = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("RightHandWeaponHoldSocket"));
 	BackWeapon = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("BackWeaponHoldSocket"));
 
+	HealthComponent = CreateDefaultSubobject<UHealthComponent>(TEXT("HealthComponent"));
+
 	CameraZoomTimeline = CreateDefaultSubobject<UTimelineComponent>(TEXT("CameraZoomTimeline"));
 }
 
@@ -68,6 +84,101 @@ void AMainCharacter::BeginPlay()
 		CameraZoomTimeline->SetTimelineFinishedFunc(CameraZoomTimelineFinished);
 		CameraZoomTimeline->SetLooping(false);
 	}
+
+	if (UAnimationBudgetSubsystem* AnimationBudget = GetWorld()->GetSubsystem<UAnimationBudgetSubsystem>())
+	{
+		AnimationBudget->RegisterCharacter(this);
+	}
+
+	if (UMovementLODSubsystem* MovementLOD = GetWorld()->GetSubsystem<UMovementLODSubsystem>())
+	{
+		MovementLOD->RegisterCharacter(this);
+	}
+
+	if (UPerceptionSubsystem* Perception = GetWorld()->GetSubsystem<UPerceptionSubsystem>())
+	{
+		Perception->RegisterPerceiver(this);
+	}
+
+	if (UCrowdAvoidanceSubsystem* CrowdAvoidance = GetWorld()->GetSubsystem<UCrowdAvoidanceSubsystem>())
+	{
+		CrowdAvoidance->RegisterCharacter(this);
+	}
+
+	HealthComponent->OnDeath.AddDynamic(this, &AMainCharacter::OnHealthDepleted);
+}
+
+void AMainCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UAnimationBudgetSubsystem* AnimationBudget = GetWorld()->GetSubsystem<UAnimationBudgetSubsystem>())
+	{
+		AnimationBudget->UnregisterCharacter(this);
+	}
+
+	if (UMovementLODSubsystem* MovementLOD = GetWorld()->GetSubsystem<UMovementLODSubsystem>())
+	{
+		MovementLOD->UnregisterCharacter(this);
+	}
+
+	if (UPerceptionSubsystem* Perception = GetWorld()->GetSubsystem<UPerceptionSubsystem>())
+	{
+		Perception->UnregisterPerceiver(this);
+	}
+
+	if (UCrowdAvoidanceSubsystem* CrowdAvoidance = GetWorld()->GetSubsystem<UCrowdAvoidanceSubsystem>())
+	{
+		CrowdAvoidance->UnregisterCharacter(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AMainCharacter::OnHealthDepleted(UHealthComponent* DeadHealthComponent, AController* Killer, AActor* DamageCauser)
+{
+	if (IsPlayerControlled())
+	{
+		return;
+	}
+
+	// Dead NPCs leave every per-character system; from here on only the ragdoll subsystem updates them.
+	if (UAnimationBudgetSubsystem* AnimationBudget = GetWorld()->GetSubsystem<UAnimationBudgetSubsystem>())
+	{
+		AnimationBudget->UnregisterCharacter(this);
+	}
+
+	if (UMovementLODSubsystem* MovementLOD = GetWorld()->GetSubsystem<UMovementLODSubsystem>())
+	{
+		MovementLOD->UnregisterCharacter(this);
+	}
+
+	if (UPerceptionSubsystem* Perception = GetWorld()->GetSubsystem<UPerceptionSubsystem>())
+	{
+		Perception->UnregisterPerceiver(this);
+	}
+
+	if (UCrowdAvoidanceSubsystem* CrowdAvoidance = GetWorld()->GetSubsystem<UCrowdAvoidanceSubsystem>())
+	{
+		CrowdAvoidance->UnregisterCharacter(this);
+	}
+
+	// The health component registered the pawn for proximity queries; the corpse should no longer show up in them.
+	if (UPawnSpatialHashSubsystem* SpatialHash = GetWorld()->GetSubsystem<UPawnSpatialHashSubsystem>())
+	{
+		SpatialHash->Unregister(this);
+	}
+
+	ActivateAttack(false);
+	StopAnimMontage();
+	DetachFromControllerPendingDestroy();
+
+	GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	GetCharacterMovement()->DisableMovement();
+	GetCharacterMovement()->SetComponentTickEnabled(false);
+
+	if (URagdollSubsystem* Ragdolls = GetWorld()->GetSubsystem<URagdollSubsystem>())
+	{
+		Ragdolls->QueueRagdoll(this);
+	}
 }
 
 void AMainCharacter::OnConstruction(const FTransform& Transform)
@@ -134,6 +245,13 @@ bool AMainCharacter::IsAttacking() const
 	return false;
 }
 
+bool AMainCharacter::IsInCombat() const
+{
+	constexpr float kRecentDamageSeconds = 5.f;
+
+	return IsAttacking() || bIsAiming || (HealthComponent && HealthComponent->WasRecentlyDamaged(kRecentDamageSeconds));
+}
+
 void AMainCharacter::ZoomCamera(float ActionValue)
 {
 	if (!bIsAiming && bIsZoomFinished)
@@ -147,22 +265,45 @@ void AMainCharacter::ZoomCamera(float ActionValue)
 	}
 }
 
+ATank* AMainCharacter::FindEnterableTank() const
+{
+	if (const UPawnSpatialHashSubsystem* SpatialHash = GetWorld()->GetSubsystem<UPawnSpatialHashSubsystem>())
+	{
+		return Cast<ATank>(SpatialHash->FindNearest(GetActorLocation(), EnterVehicleRadius, ATank::StaticClass(), this));
+	}
+
+	return nullptr;
+}
+
 void AMainCharacter::OnOverlapBegin_AttackCapsule(UPrimitiveComponent* OverlappedComp, AActor* OtherActor,
                                                   UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
 {
 	if (OtherActor != this && OtherActor->IsA(ACharacter::StaticClass()))
 	{
-		if (GEngine)
+		TG_DEBUG_EVENT(EDebugEvent::MeleeHitCharacter, OtherActor, 0.f);
+	}
+
+	if (UImpactEffectSubsystem* ImpactEffects = GetWorld()->GetSubsystem<UImpactEffectSubsystem>())
+	{
+		if (bFromSweep)
+		{
+			ImpactEffects->SpawnEffectAtHit(EImpactEffectType::MeleeImpact, SweepResult);
+		}
+		else
 		{
-			GEngine->AddOnScreenDebugMessage(-1, 2.0f, FColor::Blue, TEXT("Hit Other Character"));
+			ImpactEffects->SpawnEffect(EImpactEffectType::MeleeImpact, SurfaceType_Default,
+				AttackCapsule->GetComponentLocation(), AttackCapsule->GetComponentRotation());
 		}
 	}
 
-	UGameplayStatics::ApplyDamage(OtherActor,	// Damaged Actor
-		25,										// Damage
-		Cast<APawn>(this)->GetController(),		// Instigator (Controller)
-		this,									// Damage Causer (Actor)
-		UDamageType::StaticClass());			// Default damage type
+	if (UDamageSubsystem* DamageSubsystem = GetWorld()->GetSubsystem<UDamageSubsystem>())
+	{
+		DamageSubsystem->QueueDamage(OtherActor,	// Damaged Actor
+			25,										// Damage
+			EDamageKind::Melee,						// Damage kind
+			GetController(),						// Instigator (Controller)
+			this);									// Damage Causer (Actor)
+	}
 }
 
 void AMainCharacter::PerformLineTraceAndApplyDamage()
@@ -177,9 +318,15 @@ void AMainCharacter::PerformLineTraceAndApplyDamage()
 
 	FCollisionQueryParams TraceParams(FName(TEXT("InteractTrace")), true, nullptr);
 	TraceParams.bTraceComplex = false;
+	TraceParams.bReturnPhysicalMaterial = true;
 
 	FHitResult HitDetails = FHitResult(ForceInit);
 
+	if (IsPlayerControlled())
+	{
+		FInputLatencyTracker::Get().End(EInputLatencyAction::HitscanFire);
+	}
+
 	bool bIsHit = GetWorld()->LineTraceSingleByChannel(
 		HitDetails,		// FHitResult object that will be populated with hit info
 		Start,			// Starting position
@@ -189,24 +336,29 @@ void AMainCharacter::PerformLineTraceAndApplyDamage()
 
 	if (bIsHit)
 	{
-		GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Blue, TEXT("We hit something"));
+		TG_DEBUG_EVENT(EDebugEvent::HitscanHit, HitDetails.GetActor(), HitDetails.Distance);
 
 		DrawDebugLine(GetWorld(), Start, End, FColor::Green, false, 5.f, ECC_WorldStatic, 1.f);
 
-		GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Green, FString::Printf(TEXT("Hit Actor Name: %s"), *HitDetails.GetActor()->GetName()));
-		GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Green, FString::Printf(TEXT("Distance: %s"), *FString::SanitizeFloat(HitDetails.Distance)));
-
 		DrawDebugBox(GetWorld(), HitDetails.ImpactPoint, FVector(2.f, 2.f, 2.f), FColor::Blue, false, 5.f, ECC_WorldStatic, 1.f);
 
-		UGameplayStatics::ApplyDamage(HitDetails.GetActor(),	// Damaged Actor
-		                              100,												// Damage
-		                              GetController(),									// Instigator (Controller)
-		                              this,												// Damage Causer (Actor)
-		                              UDamageType::StaticClass());						// Default damage type
+		if (UImpactEffectSubsystem* ImpactEffects = GetWorld()->GetSubsystem<UImpactEffectSubsystem>())
+		{
+			ImpactEffects->SpawnEffectAtHit(EImpactEffectType::BulletImpact, HitDetails);
+		}
+
+		if (UDamageSubsystem* DamageSubsystem = GetWorld()->GetSubsystem<UDamageSubsystem>())
+		{
+			DamageSubsystem->QueueDamage(HitDetails.GetActor(),	// Damaged Actor
+				100,												// Damage
+				EDamageKind::Bullet,								// Damage kind
+				GetController(),									// Instigator (Controller)
+				this);												// Damage Causer (Actor)
+		}
 	}
 	else
 	{
-		GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("Nothing was hit"));
+		TG_DEBUG_EVENT(EDebugEvent::HitscanMiss, this, 0.f);
 
 		DrawDebugLine(GetWorld(), Start, End, FColor::Purple, false, 5.f, ECC_WorldStatic, 1.f);
 	}
@@ -214,28 +366,34 @@ void AMainCharacter::PerformLineTraceAndApplyDamage()
 
 void AMainCharacter::PlayMeleeAttackAnimation()
 {
+	const bool bPlayerControlled = IsPlayerControlled();
+
 	if (AttackMontage)
 	{
 		if (GetCurrentMontage() == nullptr)
 		{
 			PlayAnimMontage(AttackMontage);
 
-			Aim(false);
-		}
-		else
-		{
-			if (GEngine)
+			if (bPlayerControlled)
 			{
-				GEngine->AddOnScreenDebugMessage(1, 5.0f, FColor::Red, TEXT("MyBaseCharacter: AttackMontage already playing"));
+				FInputLatencyTracker::Get().End(EInputLatencyAction::MeleeAttack);
 			}
+
+			Aim(false);
+			return;
 		}
+
+		TG_DEBUG_EVENT(EDebugEvent::AttackMontageBusy, this, 0.f);
 	}
 	else
 	{
-		if (GEngine)
-		{
-			GEngine->AddOnScreenDebugMessage(1, 5.0f, FColor::Red, TEXT("MyBaseCharacter: Cannot play AttackMontage"));
-		}
+		TG_DEBUG_EVENT(EDebugEvent::AttackMontageMissing, this, 0.f);
+	}
+
+	// The press started no montage, so it has no latency to measure.
+	if (bPlayerControlled)
+	{
+		FInputLatencyTracker::Get().Cancel(EInputLatencyAction::MeleeAttack);
 	}
 }
 
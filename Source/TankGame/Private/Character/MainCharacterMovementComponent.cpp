@@ -0,0 +1,142 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+
+#include "Character/MainCharacterMovementComponent.h"
+
+#include "TankGame.h"
+#include "Misc/ScopeExit.h"
+
+DECLARE_CYCLE_STAT(TEXT("Character Movement (Full)"), STAT_CharacterMovementFull, STATGROUP_TankGame);
+DECLARE_CYCLE_STAT(TEXT("Character Movement (NavWalking)"), STAT_CharacterMovementNavWalking, STATGROUP_TankGame);
+DECLARE_CYCLE_STAT(TEXT("Character Movement (Kinematic)"), STAT_CharacterMovementKinematic, STATGROUP_TankGame);
+
+namespace
+{
+	/** Avoidance velocities older than this are ignored, so characters fall back to plain path following. */
+	constexpr double kAvoidanceVelocityMaxAge = 0.2;
+}
+
+#if !UE_BUILD_SHIPPING
+double UMainCharacterMovementComponent::TickSecondsByLOD[3] = {};
+#endif
+
+void UMainCharacterMovementComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	FullProjectionInterval = NavMeshProjectionInterval;
+	FullTickInterval = GetComponentTickInterval();
+}
+
+void UMainCharacterMovementComponent::TickComponent(float DeltaTime, ELevelTick TickType,
+	FActorComponentTickFunction* ThisTickFunction)
+{
+#if !UE_BUILD_SHIPPING
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	ON_SCOPE_EXIT
+	{
+		TickSecondsByLOD[static_cast<int32>(MovementLOD)] += FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles);
+	};
+#endif
+
+	switch (MovementLOD)
+	{
+	case EMovementLOD::NavWalking:
+		{
+			SCOPE_CYCLE_COUNTER(STAT_CharacterMovementNavWalking);
+			Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+			break;
+		}
+	case EMovementLOD::Kinematic:
+		{
+			SCOPE_CYCLE_COUNTER(STAT_CharacterMovementKinematic);
+			Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+			break;
+		}
+	default:
+		{
+			SCOPE_CYCLE_COUNTER(STAT_CharacterMovementFull);
+			Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+			break;
+		}
+	}
+}
+
+void UMainCharacterMovementComponent::RequestDirectMove(const FVector& MoveVelocity, bool bForceMaxSpeed)
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	// Forced max speed requests only carry a direction.
+	PreferredVelocity = bForceMaxSpeed ? MoveVelocity.GetSafeNormal() * GetMaxSpeed() : MoveVelocity.GetClampedToMaxSize(GetMaxSpeed());
+	PreferredVelocityTime = Now;
+
+	if (Now - AvoidanceVelocityTime > kAvoidanceVelocityMaxAge)
+	{
+		Super::RequestDirectMove(MoveVelocity, bForceMaxSpeed);
+		return;
+	}
+
+	// Avoidance only steers in the ground plane; path following keeps control of the vertical component.
+	Super::RequestDirectMove(FVector(AvoidanceVelocity.X, AvoidanceVelocity.Y, MoveVelocity.Z), false);
+}
+
+FVector UMainCharacterMovementComponent::GetPreferredVelocity(double MaxAge) const
+{
+	return GetWorld()->GetTimeSeconds() - PreferredVelocityTime <= MaxAge ? PreferredVelocity : FVector::ZeroVector;
+}
+
+void UMainCharacterMovementComponent::SetAvoidanceVelocity(const FVector& NewAvoidanceVelocity)
+{
+	AvoidanceVelocity = NewAvoidanceVelocity;
+	AvoidanceVelocityTime = GetWorld()->GetTimeSeconds();
+}
+
+void UMainCharacterMovementComponent::ClearAvoidanceVelocity()
+{
+	AvoidanceVelocity = FVector::ZeroVector;
+	AvoidanceVelocityTime = -UE_BIG_NUMBER;
+}
+
+void UMainCharacterMovementComponent::SetMovementLOD(EMovementLOD NewMovementLOD)
+{
+	if (MovementLOD == NewMovementLOD)
+	{
+		return;
+	}
+
+	MovementLOD = NewMovementLOD;
+
+	const EMovementMode GroundMode = MovementLOD == EMovementLOD::Full ? MOVE_Walking : MOVE_NavWalking;
+
+	switch (MovementLOD)
+	{
+	case EMovementLOD::Full:
+		bProjectNavMeshWalking = false;
+		bSweepWhileNavWalking = true;
+		NavMeshProjectionInterval = FullProjectionInterval;
+		SetComponentTickInterval(FullTickInterval);
+		break;
+
+	case EMovementLOD::NavWalking:
+		bProjectNavMeshWalking = true;
+		bSweepWhileNavWalking = true;
+		NavMeshProjectionInterval = NavWalkingProjectionInterval;
+		SetComponentTickInterval(NavWalkingTickInterval);
+		break;
+
+	case EMovementLOD::Kinematic:
+		bProjectNavMeshWalking = true;
+		bSweepWhileNavWalking = false;
+		NavMeshProjectionInterval = KinematicProjectionInterval;
+		SetComponentTickInterval(KinematicTickInterval);
+		break;
+	}
+
+	// Landing picks up the new ground mode; only switch immediately when already on the ground.
+	DefaultLandMovementMode = GroundMode;
+
+	if (IsMovingOnGround() && MovementMode != GroundMode)
+	{
+		SetMovementMode(GroundMode);
+	}
+}
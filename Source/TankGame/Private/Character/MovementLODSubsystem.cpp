@@ -0,0 +1,306 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+
+#include "Character/MovementLODSubsystem.h"
+
+#include "TankGame.h"
+#include "Character/MainCharacter.h"
+#include "Containers/Ticker.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerController.h"
+
+DECLARE_CYCLE_STAT(TEXT("Movement LOD"), STAT_MovementLOD, STATGROUP_TankGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Characters Full Movement"), STAT_MovementLODFull, STATGROUP_TankGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Characters NavWalking"), STAT_MovementLODNavWalking, STATGROUP_TankGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Characters Kinematic"), STAT_MovementLODKinematic, STATGROUP_TankGame);
+
+namespace
+{
+	TAutoConsoleVariable<bool> CVarMovementLODEnabled(
+		TEXT("tg.MovementLOD.Enabled"),
+		true,
+		TEXT("Reduce movement simulation detail for NPCs away from the player."));
+
+	TAutoConsoleVariable<int32> CVarMovementLODForce(
+		TEXT("tg.MovementLOD.Force"),
+		-1,
+		TEXT("Force every NPC to one movement LOD (0 full, 1 nav walking, 2 kinematic) for benchmarking. -1 to disable."));
+
+	TAutoConsoleVariable<float> CVarMovementLODNavWalkingDistance(
+		TEXT("tg.MovementLOD.NavWalkingDistance"),
+		2000.f,
+		TEXT("NPCs further than this from every player pawn switch to nav walking."));
+
+	TAutoConsoleVariable<float> CVarMovementLODKinematicDistance(
+		TEXT("tg.MovementLOD.KinematicDistance"),
+		5000.f,
+		TEXT("NPCs further than this from every player pawn switch to kinematic movement with no collision sweeps."));
+
+	TAutoConsoleVariable<float> CVarMovementLODHysteresis(
+		TEXT("tg.MovementLOD.Hysteresis"),
+		250.f,
+		TEXT("Distance an NPC has to move back inside a threshold before regaining detail."));
+
+	TAutoConsoleVariable<float> CVarMovementLODUpdateInterval(
+		TEXT("tg.MovementLOD.UpdateInterval"),
+		0.25f,
+		TEXT("Seconds between movement LOD re-evaluations."));
+}
+
+bool UMovementLODSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UMovementLODSubsystem::Deinitialize()
+{
+	Characters.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId UMovementLODSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UMovementLODSubsystem, STATGROUP_Tickables);
+}
+
+void UMovementLODSubsystem::RegisterCharacter(AMainCharacter* Character)
+{
+	if (Character && Cast<UMainCharacterMovementComponent>(Character->GetCharacterMovement()))
+	{
+		Characters.AddUnique(Character);
+	}
+}
+
+void UMovementLODSubsystem::UnregisterCharacter(AMainCharacter* Character)
+{
+	Characters.RemoveSwap(Character);
+}
+
+void UMovementLODSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	TimeUntilUpdate -= DeltaTime;
+
+	if (TimeUntilUpdate > 0.f)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_MovementLOD);
+
+	TimeUntilUpdate = CVarMovementLODUpdateInterval.GetValueOnGameThread();
+
+	Characters.RemoveAllSwap([](const TWeakObjectPtr<AMainCharacter>& Character) { return !Character.IsValid(); });
+
+	TArray<FVector, TInlineAllocator<4>> PlayerLocations;
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (const APawn* PlayerPawn = It->Get() ? It->Get()->GetPawn() : nullptr)
+		{
+			PlayerLocations.Add(PlayerPawn->GetActorLocation());
+		}
+	}
+
+	int32 LODCounts[3] = {};
+
+	for (const TWeakObjectPtr<AMainCharacter>& Character : Characters)
+	{
+		UMainCharacterMovementComponent* Movement = CastChecked<UMainCharacterMovementComponent>(Character->GetCharacterMovement());
+
+		const EMovementLOD MovementLOD = ChooseMovementLOD(Character.Get(), Movement->GetMovementLOD(), PlayerLocations);
+		Movement->SetMovementLOD(MovementLOD);
+
+		++LODCounts[static_cast<int32>(MovementLOD)];
+	}
+
+	SET_DWORD_STAT(STAT_MovementLODFull, LODCounts[0]);
+	SET_DWORD_STAT(STAT_MovementLODNavWalking, LODCounts[1]);
+	SET_DWORD_STAT(STAT_MovementLODKinematic, LODCounts[2]);
+}
+
+EMovementLOD UMovementLODSubsystem::ChooseMovementLOD(const AMainCharacter* Character, EMovementLOD CurrentLOD,
+	const TArray<FVector, TInlineAllocator<4>>& PlayerLocations) const
+{
+	const int32 ForcedLOD = CVarMovementLODForce.GetValueOnGameThread();
+
+	if (ForcedLOD >= 0 && !Character->IsPlayerControlled())
+	{
+		return static_cast<EMovementLOD>(FMath::Min(ForcedLOD, static_cast<int32>(EMovementLOD::Kinematic)));
+	}
+
+	if (!CVarMovementLODEnabled.GetValueOnGameThread() || Character->IsPlayerControlled() || Character->IsInCombat() || PlayerLocations.IsEmpty())
+	{
+		return EMovementLOD::Full;
+	}
+
+	double ClosestDistanceSquared = TNumericLimits<double>::Max();
+
+	for (const FVector& PlayerLocation : PlayerLocations)
+	{
+		ClosestDistanceSquared = FMath::Min(ClosestDistanceSquared, FVector::DistSquared(PlayerLocation, Character->GetActorLocation()));
+	}
+
+	const double Distance = FMath::Sqrt(ClosestDistanceSquared);
+	const float Hysteresis = CVarMovementLODHysteresis.GetValueOnGameThread();
+
+	// Thresholds the pawn is already beyond are relaxed, so it must come back inside by Hysteresis to gain detail.
+	const float NavWalkingDistance = CVarMovementLODNavWalkingDistance.GetValueOnGameThread() - (CurrentLOD != EMovementLOD::Full ? Hysteresis : 0.f);
+	const float KinematicDistance = CVarMovementLODKinematicDistance.GetValueOnGameThread() - (CurrentLOD == EMovementLOD::Kinematic ? Hysteresis : 0.f);
+
+	if (Distance > KinematicDistance)
+	{
+		return EMovementLOD::Kinematic;
+	}
+
+	if (Distance > NavWalkingDistance)
+	{
+		return EMovementLOD::NavWalking;
+	}
+
+	return EMovementLOD::Full;
+}
+
+#if !UE_BUILD_SHIPPING
+namespace
+{
+	/** Seconds each tier runs before measuring, long enough for every NPC to pick up the forced tier. */
+	constexpr double kBenchmarkWarmupSeconds = 1.0;
+	constexpr int32 kBenchmarkMeasuredFrames = 120;
+	constexpr int32 kNumMovementLODs = 3;
+
+	void RunMovementLODBenchmark(const TArray<FString>& Args, UWorld* World)
+	{
+		if (World == nullptr || World->GetSubsystem<UMovementLODSubsystem>() == nullptr)
+		{
+			UE_LOG(LogTankGame, Warning, TEXT("Movement LOD benchmark: needs a game world"));
+			return;
+		}
+
+		const int32 NumCharacters = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 100;
+
+		TArray<TWeakObjectPtr<AMainCharacter>> Characters;
+		const AMainCharacter* Template = nullptr;
+
+		for (TActorIterator<AMainCharacter> It(World); It; ++It)
+		{
+			if (!It->IsPlayerControlled() && Cast<UMainCharacterMovementComponent>(It->GetCharacterMovement()))
+			{
+				Template = Template ? Template : *It;
+				Characters.Add(*It);
+			}
+		}
+
+		if (Template == nullptr)
+		{
+			UE_LOG(LogTankGame, Warning, TEXT("Movement LOD benchmark: needs at least one NPC in the world to copy"));
+			return;
+		}
+
+		// Make up the numbers with copies of an existing NPC in a grid around it, each with its own AI controller.
+		constexpr float kSpacing = 250.f;
+		const FTransform TemplateTransform = Template->GetActorTransform();
+
+		for (int32 Index = Characters.Num(); Index < NumCharacters; ++Index)
+		{
+			const FVector Offset(((Index / 10) - 5) * kSpacing, ((Index % 10) - 5) * kSpacing, 0.f);
+			const FTransform SpawnTransform(TemplateTransform.GetRotation(), TemplateTransform.TransformPosition(Offset));
+
+			FActorSpawnParameters SpawnParams;
+			SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+			if (AMainCharacter* Character = World->SpawnActor<AMainCharacter>(Template->GetClass(), SpawnTransform, SpawnParams))
+			{
+				if (Character->GetController() == nullptr)
+				{
+					Character->SpawnDefaultController();
+				}
+
+				Characters.Add(Character);
+			}
+		}
+
+		struct FBenchmarkState
+		{
+			int32 Tier = 0;
+			int32 Frame = 0;
+			double TierStartTime = 0.0;
+			double FrameSeconds = 0.0;
+			int32 PreviousForce = -1;
+		};
+
+		IConsoleVariable* ForceVariable = IConsoleManager::Get().FindConsoleVariable(TEXT("tg.MovementLOD.Force"));
+		check(ForceVariable);
+
+		TSharedRef<FBenchmarkState> State = MakeShared<FBenchmarkState>();
+		State->PreviousForce = ForceVariable->GetInt();
+		State->TierStartTime = FPlatformTime::Seconds();
+		ForceVariable->Set(0, ECVF_SetByConsole);
+
+		TWeakObjectPtr<UWorld> WeakWorld = World;
+
+		FTSTicker::GetCoreTicker().AddTicker(TEXT("MovementLODBenchmark"), 0.f, [State, Characters, WeakWorld, ForceVariable](float DeltaTime)
+		{
+			if (!WeakWorld.IsValid())
+			{
+				ForceVariable->Set(State->PreviousForce, ECVF_SetByConsole);
+				return false;
+			}
+
+			if (FPlatformTime::Seconds() - State->TierStartTime < kBenchmarkWarmupSeconds)
+			{
+				return true;
+			}
+
+			if (State->Frame == 0)
+			{
+				FMemory::Memzero(UMainCharacterMovementComponent::TickSecondsByLOD);
+				State->FrameSeconds = 0.0;
+			}
+			else
+			{
+				State->FrameSeconds += DeltaTime;
+			}
+
+			if (++State->Frame <= kBenchmarkMeasuredFrames)
+			{
+				return true;
+			}
+
+			int32 NumAlive = 0;
+
+			for (const TWeakObjectPtr<AMainCharacter>& Character : Characters)
+			{
+				NumAlive += Character.IsValid() ? 1 : 0;
+			}
+
+			static const TCHAR* TierNames[kNumMovementLODs] = { TEXT("Full"), TEXT("NavWalking"), TEXT("Kinematic") };
+			const double MovementMs = UMainCharacterMovementComponent::TickSecondsByLOD[State->Tier] * 1000.0 / kBenchmarkMeasuredFrames;
+
+			UE_LOG(LogTankGame, Display, TEXT("Movement LOD benchmark %s: %.3f ms movement per frame for %d NPCs, %.3f ms per 100 NPCs (frame %.2f ms)"),
+				TierNames[State->Tier], MovementMs, NumAlive, MovementMs * 100.0 / FMath::Max(NumAlive, 1),
+				State->FrameSeconds * 1000.0 / kBenchmarkMeasuredFrames);
+
+			if (++State->Tier == kNumMovementLODs)
+			{
+				ForceVariable->Set(State->PreviousForce, ECVF_SetByConsole);
+				return false;
+			}
+
+			ForceVariable->Set(State->Tier, ECVF_SetByConsole);
+			State->TierStartTime = FPlatformTime::Seconds();
+			State->Frame = 0;
+
+			return true;
+		});
+	}
+
+	FAutoConsoleCommandWithWorldAndArgs MovementLODBenchmarkCommand(
+		TEXT("TankGame.MovementLOD.Benchmark"),
+		TEXT("Forces [Count] NPCs (default 100) through each movement LOD tier in turn, spawning copies of an existing NPC as needed, and logs movement cost per frame and per 100 NPCs at each tier."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunMovementLODBenchmark));
+}
+#endif
@@ -0,0 +1,289 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+
+#include "Character/RagdollSubsystem.h"
+
+#include "TankGame.h"
+#include "Character/MainCharacter.h"
+#include "Combat/DamageSubsystem.h"
+#include "Combat/HealthComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerController.h"
+#include "PhysicsEngine/PhysicsAsset.h"
+
+DECLARE_CYCLE_STAT(TEXT("Ragdoll Update"), STAT_RagdollUpdate, STATGROUP_TankGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Ragdolls Simulating"), STAT_RagdollsSimulating, STATGROUP_TankGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Ragdolls Pending"), STAT_RagdollsPending, STATGROUP_TankGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Frozen Corpses"), STAT_RagdollCorpses, STATGROUP_TankGame);
+
+namespace
+{
+	TAutoConsoleVariable<int32> CVarRagdollMaxSimulating(
+		TEXT("tg.Ragdoll.MaxSimulating"),
+		12,
+		TEXT("Maximum number of ragdolls simulating at once. Starting another freezes the oldest."));
+
+	TAutoConsoleVariable<int32> CVarRagdollStartsPerFrame(
+		TEXT("tg.Ragdoll.StartsPerFrame"),
+		4,
+		TEXT("Maximum number of ragdolls started per frame. Further deaths wait in a queue."));
+
+	TAutoConsoleVariable<int32> CVarRagdollMaxCorpses(
+		TEXT("tg.Ragdoll.MaxCorpses"),
+		48,
+		TEXT("Maximum number of frozen corpses kept in the world. The oldest is destroyed to make room."));
+
+	TAutoConsoleVariable<float> CVarRagdollSimplifiedDistance(
+		TEXT("tg.Ragdoll.SimplifiedDistance"),
+		2500.f,
+		TEXT("NPCs dying further than this from every player camera use their simplified ragdoll physics asset."));
+
+	TAutoConsoleVariable<float> CVarRagdollFreezeDistance(
+		TEXT("tg.Ragdoll.FreezeDistance"),
+		8000.f,
+		TEXT("NPCs dying further than this from every player camera are frozen in their death pose without a ragdoll."));
+
+	TAutoConsoleVariable<float> CVarRagdollSettleSpeed(
+		TEXT("tg.Ragdoll.SettleSpeed"),
+		15.f,
+		TEXT("Root body speed below which a ragdoll counts as resting."));
+
+	TAutoConsoleVariable<float> CVarRagdollSettleTime(
+		TEXT("tg.Ragdoll.SettleTime"),
+		0.5f,
+		TEXT("Seconds a ragdoll has to rest before it is frozen."));
+
+	TAutoConsoleVariable<float> CVarRagdollMaxSimulateTime(
+		TEXT("tg.Ragdoll.MaxSimulateTime"),
+		6.f,
+		TEXT("Seconds after which a ragdoll is frozen even if it has not settled."));
+}
+
+bool URagdollSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void URagdollSubsystem::Deinitialize()
+{
+	PendingDeaths.Empty();
+	Simulating.Empty();
+	Corpses.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId URagdollSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(URagdollSubsystem, STATGROUP_Tickables);
+}
+
+void URagdollSubsystem::QueueRagdoll(AMainCharacter* Character)
+{
+	if (Character == nullptr || PendingDeaths.Contains(Character))
+	{
+		return;
+	}
+
+	// Hold the death pose while waiting instead of animating.
+	Character->GetMesh()->bPauseAnims = true;
+
+	PendingDeaths.Add(Character);
+}
+
+void URagdollSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SCOPE_CYCLE_COUNTER(STAT_RagdollUpdate);
+
+	PendingDeaths.RemoveAll([](const TWeakObjectPtr<AMainCharacter>& Character) { return !Character.IsValid(); });
+	Simulating.RemoveAll([](const FRagdoll& Ragdoll) { return !Ragdoll.Character.IsValid(); });
+	Corpses.RemoveAll([](const TWeakObjectPtr<AMainCharacter>& Character) { return !Character.IsValid(); });
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	const float SettleSpeed = CVarRagdollSettleSpeed.GetValueOnGameThread();
+	const float SettleTime = CVarRagdollSettleTime.GetValueOnGameThread();
+	const float MaxSimulateTime = CVarRagdollMaxSimulateTime.GetValueOnGameThread();
+
+	Simulating.RemoveAll([&](FRagdoll& Ragdoll)
+	{
+		AMainCharacter* Character = Ragdoll.Character.Get();
+		const USkeletalMeshComponent* Mesh = Character->GetMesh();
+
+		const bool bResting = !Mesh->RigidBodyIsAwake() || Mesh->GetPhysicsLinearVelocity().SizeSquared() < FMath::Square(SettleSpeed);
+		Ragdoll.SettledTime = bResting ? Ragdoll.SettledTime + DeltaTime : 0.f;
+
+		if (Ragdoll.SettledTime >= SettleTime || Now - Ragdoll.StartTime >= MaxSimulateTime)
+		{
+			FreezeCorpse(Character);
+			return true;
+		}
+
+		return false;
+	});
+
+	if (!PendingDeaths.IsEmpty())
+	{
+		TArray<FVector, TInlineAllocator<4>> ViewLocations;
+
+		for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+		{
+			if (const APlayerController* PlayerController = It->Get(); PlayerController && PlayerController->PlayerCameraManager)
+			{
+				ViewLocations.Add(PlayerController->PlayerCameraManager->GetCameraLocation());
+			}
+		}
+
+		const int32 MaxSimulating = FMath::Max(CVarRagdollMaxSimulating.GetValueOnGameThread(), 0);
+		const int32 MaxStarts = FMath::Max(CVarRagdollStartsPerFrame.GetValueOnGameThread(), 1);
+		int32 NumStarted = 0;
+		int32 NumHandled = 0;
+
+		for (; NumHandled < PendingDeaths.Num() && NumStarted < MaxStarts; ++NumHandled)
+		{
+			AMainCharacter* Character = PendingDeaths[NumHandled].Get();
+			const ERagdollLOD RagdollLOD = MaxSimulating > 0 ? ChooseRagdollLOD(Character, ViewLocations) : ERagdollLOD::Frozen;
+
+			// Freezing in place is cheap, so it does not count against the per-frame start budget.
+			if (RagdollLOD == ERagdollLOD::Frozen)
+			{
+				FreezeCorpse(Character);
+				continue;
+			}
+
+			if (Simulating.Num() >= MaxSimulating)
+			{
+				FreezeCorpse(Simulating[0].Character.Get());
+				Simulating.RemoveAt(0);
+			}
+
+			StartRagdoll(Character, RagdollLOD);
+			++NumStarted;
+		}
+
+		PendingDeaths.RemoveAt(0, NumHandled);
+	}
+
+	SET_DWORD_STAT(STAT_RagdollsSimulating, Simulating.Num());
+	SET_DWORD_STAT(STAT_RagdollsPending, PendingDeaths.Num());
+	SET_DWORD_STAT(STAT_RagdollCorpses, Corpses.Num());
+}
+
+URagdollSubsystem::ERagdollLOD URagdollSubsystem::ChooseRagdollLOD(const AMainCharacter* Character,
+	const TArray<FVector, TInlineAllocator<4>>& ViewLocations) const
+{
+	if (ViewLocations.IsEmpty())
+	{
+		return ERagdollLOD::Full;
+	}
+
+	double ClosestDistanceSquared = TNumericLimits<double>::Max();
+
+	for (const FVector& ViewLocation : ViewLocations)
+	{
+		ClosestDistanceSquared = FMath::Min(ClosestDistanceSquared, FVector::DistSquared(ViewLocation, Character->GetActorLocation()));
+	}
+
+	if (ClosestDistanceSquared > FMath::Square(CVarRagdollFreezeDistance.GetValueOnGameThread()))
+	{
+		return ERagdollLOD::Frozen;
+	}
+
+	if (ClosestDistanceSquared > FMath::Square(CVarRagdollSimplifiedDistance.GetValueOnGameThread()))
+	{
+		return ERagdollLOD::Simplified;
+	}
+
+	return ERagdollLOD::Full;
+}
+
+void URagdollSubsystem::StartRagdoll(AMainCharacter* Character, ERagdollLOD RagdollLOD)
+{
+	USkeletalMeshComponent* Mesh = Character->GetMesh();
+
+	// Physics drives every bone from here on, so the mesh has to tick every frame but need not animate.
+	Mesh->EnableExternalTickRateControl(false);
+	Mesh->EnableExternalInterpolation(false);
+
+	if (RagdollLOD == ERagdollLOD::Simplified && Character->DistantRagdollPhysicsAsset)
+	{
+		Mesh->SetPhysicsAsset(Character->DistantRagdollPhysicsAsset, true);
+	}
+
+	Mesh->SetCollisionProfileName(UCollisionProfile::Ragdoll_ProfileName);
+	Mesh->SetSimulatePhysics(true);
+	Mesh->WakeAllRigidBodies();
+
+	FRagdoll& Ragdoll = Simulating.AddDefaulted_GetRef();
+	Ragdoll.Character = Character;
+	Ragdoll.StartTime = GetWorld()->GetTimeSeconds();
+}
+
+void URagdollSubsystem::FreezeCorpse(AMainCharacter* Character)
+{
+	USkeletalMeshComponent* Mesh = Character->GetMesh();
+
+	// With the mesh no longer ticking its bone transforms are never refreshed, so it keeps the last simulated pose.
+	Mesh->bPauseAnims = true;
+	Mesh->SetComponentTickEnabled(false);
+	Mesh->SetSimulatePhysics(false);
+	Mesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Mesh->DestroyPhysicsState();
+
+	Character->SetActorTickEnabled(false);
+
+	const int32 MaxCorpses = FMath::Max(CVarRagdollMaxCorpses.GetValueOnGameThread(), 1);
+
+	while (Corpses.Num() >= MaxCorpses)
+	{
+		if (AMainCharacter* OldestCorpse = Corpses[0].Get())
+		{
+			OldestCorpse->Destroy();
+		}
+
+		Corpses.RemoveAt(0);
+	}
+
+	Corpses.Add(Character);
+}
+
+#if !UE_BUILD_SHIPPING
+namespace
+{
+	FAutoConsoleCommandWithWorldAndArgs RagdollBurstCommand(
+		TEXT("TankGame.Ragdoll.Burst"),
+		TEXT("Kills up to [Count] NPCs (default 100) in a single frame through the damage subsystem. Watch 'stat TankGame' and 'stat Physics' while the burst resolves."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			UDamageSubsystem* DamageSubsystem = World ? World->GetSubsystem<UDamageSubsystem>() : nullptr;
+
+			if (DamageSubsystem == nullptr)
+			{
+				UE_LOG(LogTankGame, Warning, TEXT("Ragdoll burst: needs a game world"));
+				return;
+			}
+
+			const int32 MaxKills = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 100;
+			int32 NumKills = 0;
+
+			for (TActorIterator<AMainCharacter> It(World); It && NumKills < MaxKills; ++It)
+			{
+				const UHealthComponent* HealthComponent = It->HealthComponent;
+
+				if (It->IsPlayerControlled() || HealthComponent == nullptr || HealthComponent->IsDead())
+				{
+					continue;
+				}
+
+				DamageSubsystem->QueueDamage(*It, HealthComponent->GetMaxHealth() * 10.f, EDamageKind::Shell, nullptr, nullptr);
+				++NumKills;
+			}
+
+			UE_LOG(LogTankGame, Display, TEXT("Ragdoll burst: killing %d NPCs"), NumKills);
+		}));
+}
+#endif
@@ -0,0 +1,206 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+
+#include "Combat/DamageSubsystem.h"
+
+#include "TankGame.h"
+#include "Combat/HealthComponent.h"
+#include "Engine/DamageEvents.h"
+#include "Engine/World.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/DamageType.h"
+#include "Shared/TankGameSettings.h"
+
+DECLARE_CYCLE_STAT(TEXT("Resolve Damage"), STAT_ResolveDamage, STATGROUP_TankGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Damage Records Queued"), STAT_DamageRecordsQueued, STATGROUP_TankGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Damage Records Merged"), STAT_DamageRecordsMerged, STATGROUP_TankGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Damage Events Applied"), STAT_DamageEventsApplied, STATGROUP_TankGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Deaths"), STAT_DamageDeaths, STATGROUP_TankGame);
+
+bool UDamageSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UDamageSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	ResistanceTable = GetDefault<UTankGameSettings>()->DamageResistanceTable.LoadSynchronous();
+}
+
+void UDamageSubsystem::Deinitialize()
+{
+	PendingRecords.Empty();
+	ResolvingRecords.Empty();
+	DedupeLookup.Empty();
+	HealthComponents.Empty();
+	ResistanceCache.Empty();
+
+	Super::Deinitialize();
+}
+
+void UDamageSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (PendingRecords.Num() > 0)
+	{
+		ResolveQueuedDamage();
+	}
+}
+
+TStatId UDamageSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UDamageSubsystem, STATGROUP_Tickables);
+}
+
+void UDamageSubsystem::QueueDamage(AActor* Target, float Amount, EDamageKind DamageKind, AController* Instigator,
+	AActor* DamageCauser)
+{
+	if (Target == nullptr || Amount <= 0.f)
+	{
+		return;
+	}
+
+	FDamageRecord& Record = PendingRecords.AddDefaulted_GetRef();
+	Record.Target = Target;
+	Record.Instigator = Instigator;
+	Record.DamageCauser = DamageCauser;
+	Record.Amount = Amount;
+	Record.DamageKind = DamageKind;
+
+	INC_DWORD_STAT(STAT_DamageRecordsQueued);
+}
+
+void UDamageSubsystem::RegisterHealthComponent(UHealthComponent* HealthComponent)
+{
+	HealthComponents.Add(FObjectKey(HealthComponent->GetOwner()), HealthComponent);
+}
+
+void UDamageSubsystem::UnregisterHealthComponent(UHealthComponent* HealthComponent)
+{
+	HealthComponents.Remove(FObjectKey(HealthComponent->GetOwner()));
+}
+
+UHealthComponent* UDamageSubsystem::FindHealthComponent(const AActor* Actor) const
+{
+	const TWeakObjectPtr<UHealthComponent>* HealthComponent = HealthComponents.Find(FObjectKey(Actor));
+
+	return HealthComponent ? HealthComponent->Get() : nullptr;
+}
+
+void UDamageSubsystem::ResolveQueuedDamage()
+{
+	SCOPE_CYCLE_COUNTER(STAT_ResolveDamage);
+
+	// Swap so anything queued by handlers below lands in the next frame's batch.
+	Swap(PendingRecords, ResolvingRecords);
+	PendingRecords.Reset();
+
+	// Hits on the same target from the same causer and damage kind (pellets, a melee swing plus its splash) are merged
+	// into one event carrying their summed amount, so no damage is lost. The merged record keeps the first occurrence's
+	// position so resolution order stays deterministic.
+	int32 NumUnique = 0;
+	DedupeLookup.Reset();
+
+	for (int32 RecordIndex = 0; RecordIndex < ResolvingRecords.Num(); ++RecordIndex)
+	{
+		const FDamageRecord& Record = ResolvingRecords[RecordIndex];
+		const TTuple<FObjectKey, FObjectKey, EDamageKind> Key(FObjectKey(Record.Target.Get()), FObjectKey(Record.DamageCauser.Get()), Record.DamageKind);
+
+		if (const int32* ExistingIndex = DedupeLookup.Find(Key))
+		{
+			FDamageRecord& Existing = ResolvingRecords[*ExistingIndex];
+			Existing.Amount += Record.Amount;
+
+			INC_DWORD_STAT(STAT_DamageRecordsMerged);
+			continue;
+		}
+
+		DedupeLookup.Add(Key, NumUnique);
+		ResolvingRecords[NumUnique++] = Record;
+	}
+
+	ResolvingRecords.SetNum(NumUnique, EAllowShrinking::No);
+
+	TArray<TTuple<UHealthComponent*, AController*, AActor*>, TInlineAllocator<16>> Deaths;
+
+	for (const FDamageRecord& Record : ResolvingRecords)
+	{
+		AActor* Target = Record.Target.Get();
+
+		if (Target == nullptr)
+		{
+			continue;
+		}
+
+		const float Amount = Record.Amount * GetResistance(Target->GetClass()).Multipliers[static_cast<int32>(Record.DamageKind)];
+
+		if (Amount <= 0.f)
+		{
+			continue;
+		}
+
+		INC_DWORD_STAT(STAT_DamageEventsApplied);
+
+		if (UHealthComponent* HealthComponent = FindHealthComponent(Target))
+		{
+			if (HealthComponent->ReceiveDamage(Amount, Record.DamageCauser.Get()))
+			{
+				Deaths.Emplace(HealthComponent, Record.Instigator.Get(), Record.DamageCauser.Get());
+			}
+		}
+
+		// Always route through TakeDamage as well so Blueprint AnyDamage and OnTakeAnyDamage handlers keep firing.
+		Target->TakeDamage(Amount, FDamageEvent(UDamageType::StaticClass()), Record.Instigator.Get(), Record.DamageCauser.Get());
+	}
+
+	for (const TTuple<UHealthComponent*, AController*, AActor*>& Death : Deaths)
+	{
+		INC_DWORD_STAT(STAT_DamageDeaths);
+
+		Death.Get<0>()->OnDeath.Broadcast(Death.Get<0>(), Death.Get<1>(), Death.Get<2>());
+	}
+
+	ResolvingRecords.Reset();
+}
+
+const UDamageSubsystem::FResolvedResistance& UDamageSubsystem::GetResistance(const UClass* ActorClass)
+{
+	if (const FResolvedResistance* Cached = ResistanceCache.Find(ActorClass))
+	{
+		return *Cached;
+	}
+
+	FResolvedResistance& Resolved = ResistanceCache.Add(ActorClass);
+
+	for (float& Multiplier : Resolved.Multipliers)
+	{
+		Multiplier = 1.f;
+	}
+
+	if (ResistanceTable)
+	{
+		const FDamageResistance* BestMatch = nullptr;
+
+		for (const FDamageResistance& Resistance : ResistanceTable->Resistances)
+		{
+			if (Resistance.ActorClass && ActorClass->IsChildOf(Resistance.ActorClass)
+				&& (BestMatch == nullptr || Resistance.ActorClass->IsChildOf(BestMatch->ActorClass)))
+			{
+				BestMatch = &Resistance;
+			}
+		}
+
+		if (BestMatch)
+		{
+			for (const TPair<EDamageKind, float>& Multiplier : BestMatch->Multipliers)
+			{
+				Resolved.Multipliers[static_cast<int32>(Multiplier.Key)] = Multiplier.Value;
+			}
+		}
+	}
+
+	return Resolved;
+}
@@ -0,0 +1,91 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+
+#include "Combat/HealthComponent.h"
+
+#include "Combat/DamageSubsystem.h"
+#include "Effects/DestructionSubsystem.h"
+#include "Shared/PawnSpatialHashSubsystem.h"
+
+UHealthComponent::UHealthComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+void UHealthComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	Health = MaxHealth;
+
+	if (UDamageSubsystem* DamageSubsystem = GetWorld()->GetSubsystem<UDamageSubsystem>())
+	{
+		DamageSubsystem->RegisterHealthComponent(this);
+	}
+
+	if (UPawnSpatialHashSubsystem* SpatialHash = GetWorld()->GetSubsystem<UPawnSpatialHashSubsystem>())
+	{
+		SpatialHash->Register(GetOwner());
+	}
+
+	if (bShatterOnDeath)
+	{
+		OnDeath.AddDynamic(this, &UHealthComponent::ShatterOwner);
+	}
+}
+
+void UHealthComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UDamageSubsystem* DamageSubsystem = GetWorld()->GetSubsystem<UDamageSubsystem>())
+	{
+		DamageSubsystem->UnregisterHealthComponent(this);
+	}
+
+	if (UPawnSpatialHashSubsystem* SpatialHash = GetWorld()->GetSubsystem<UPawnSpatialHashSubsystem>())
+	{
+		SpatialHash->Unregister(GetOwner());
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+bool UHealthComponent::ReceiveDamage(float Damage, AActor* DamageCauser)
+{
+	if (IsDead() || Damage <= 0.f)
+	{
+		return false;
+	}
+
+	LastDamageTime = GetWorld()->GetTimeSeconds();
+
+	const float OldHealth = Health;
+	Health = FMath::Max(Health - Damage, 0.f);
+
+	OnHealthChanged.Broadcast(this, Health, Health - OldHealth, DamageCauser);
+
+	return IsDead();
+}
+
+void UHealthComponent::SetHealth(float NewHealth)
+{
+	const float OldHealth = Health;
+	Health = FMath::Clamp(NewHealth, 0.f, MaxHealth);
+
+	if (Health != OldHealth)
+	{
+		OnHealthChanged.Broadcast(this, Health, Health - OldHealth, nullptr);
+	}
+}
+
+bool UHealthComponent::WasRecentlyDamaged(float Seconds) const
+{
+	return GetWorld()->GetTimeSeconds() - LastDamageTime <= Seconds;
+}
+
+void UHealthComponent::ShatterOwner(UHealthComponent* DeadHealthComponent, AController* Killer, AActor* DamageCauser)
+{
+	if (UDestructionSubsystem* Destruction = GetWorld()->GetSubsystem<UDestructionSubsystem>())
+	{
+		Destruction->Shatter(GetOwner());
+	}
+}
@@ -0,0 +1,609 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+
+#include "Effects/DestructionSubsystem.h"
+
+#include "TankGame.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Chaos/CacheCollection.h"
+#include "Chaos/CacheManagerActor.h"
+#include "Combat/DamageSubsystem.h"
+#include "Combat/HealthComponent.h"
+#include "Containers/Ticker.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerController.h"
+#include "GeometryCollection/GeometryCollectionActor.h"
+#include "GeometryCollection/GeometryCollectionComponent.h"
+#include "GeometryCollection/GeometryCollectionObject.h"
+#include "Input/CharacterPlayerController.h"
+#include "Shared/TankGameSettings.h"
+#include "Tank/Tank.h"
+
+#if WITH_EDITOR
+#include "AssetRegistry/IAssetRegistry.h"
+#include "Misc/PackageName.h"
+#include "UObject/Package.h"
+#endif
+
+DECLARE_CYCLE_STAT(TEXT("Destruction Update"), STAT_DestructionUpdate, STATGROUP_TankGame);
+DECLARE_CYCLE_STAT(TEXT("Spawn Wreck"), STAT_DestructionSpawnWreck, STATGROUP_TankGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Wrecks Pending"), STAT_DestructionPending, STATGROUP_TankGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Wrecks Live"), STAT_DestructionLive, STATGROUP_TankGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Wrecks Cached"), STAT_DestructionCached, STATGROUP_TankGame);
+
+namespace
+{
+	TAutoConsoleVariable<int32> CVarDestructionSpawnsPerFrame(
+		TEXT("tg.Destruction.SpawnsPerFrame"),
+		3,
+		TEXT("Maximum number of wrecks spawned per frame. Further destructions wait in a queue."));
+
+	TAutoConsoleVariable<int32> CVarDestructionMaxLive(
+		TEXT("tg.Destruction.MaxLive"),
+		2,
+		TEXT("Maximum number of wrecks simulated live at once. Further wrecks play their recorded cache."));
+
+	TAutoConsoleVariable<float> CVarDestructionLiveDistance(
+		TEXT("tg.Destruction.LiveDistance"),
+		2500.f,
+		TEXT("Wrecks closer than this to a player camera are simulated live when the budget allows."));
+
+	TAutoConsoleVariable<int32> CVarDestructionMaxWrecks(
+		TEXT("tg.Destruction.MaxWrecks"),
+		32,
+		TEXT("Maximum number of wrecks in the world. The oldest is removed to make room."));
+
+	TAutoConsoleVariable<bool> CVarDestructionForceCached(
+		TEXT("tg.Destruction.ForceCached"),
+		false,
+		TEXT("Play every wreck from its recorded cache, even next to the camera, for benchmarking."));
+}
+
+bool UDestructionSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UDestructionSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	CacheSet = GetDefault<UTankGameSettings>()->DestructionCacheSet.LoadSynchronous();
+
+	if (CacheSet == nullptr)
+	{
+		UE_LOG(LogTankGame, Warning, TEXT("DestructionSubsystem: no DestructionCacheSet configured, destroyed actors leave no wrecks"));
+	}
+}
+
+void UDestructionSubsystem::Deinitialize()
+{
+	for (const FWreck& Wreck : Wrecks)
+	{
+		DestroyWreck(Wreck);
+	}
+
+	Wrecks.Empty();
+	PendingDestructions.Empty();
+	DefinitionLookup.Empty();
+	NumLiveWrecks = 0;
+
+	Super::Deinitialize();
+}
+
+TStatId UDestructionSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UDestructionSubsystem, STATGROUP_Tickables);
+}
+
+int32 UDestructionSubsystem::FindDefinition(const UClass* ActorClass)
+{
+	if (const int32* Cached = DefinitionLookup.Find(ActorClass))
+	{
+		return *Cached;
+	}
+
+	int32 DefinitionIndex = INDEX_NONE;
+
+	// Walk up from the actor's class so the closest listed parent wins.
+	for (const UClass* Class = ActorClass; Class && DefinitionIndex == INDEX_NONE; Class = Class->GetSuperClass())
+	{
+		DefinitionIndex = CacheSet->Definitions.IndexOfByPredicate([Class](const FDestructionCacheDefinition& Definition)
+		{
+			return Definition.ActorClass == Class && Definition.GeometryCollection;
+		});
+	}
+
+	DefinitionLookup.Add(ActorClass, DefinitionIndex);
+
+	return DefinitionIndex;
+}
+
+bool UDestructionSubsystem::Shatter(AActor* Actor)
+{
+	if (CacheSet == nullptr || !IsValid(Actor))
+	{
+		return false;
+	}
+
+	const int32 DefinitionIndex = FindDefinition(Actor->GetClass());
+
+	if (DefinitionIndex == INDEX_NONE || PendingDestructions.ContainsByPredicate([Actor](const FPendingDestruction& Pending) { return Pending.Actor == Actor; }))
+	{
+		return false;
+	}
+
+	// A player's vehicle hands its driver back first, so the character parked inside is not destroyed with it.
+	if (APawn* Pawn = Cast<APawn>(Actor))
+	{
+		if (ACharacterPlayerController* PlayerController = Cast<ACharacterPlayerController>(Pawn->GetController()))
+		{
+			PlayerController->ExitVehicle();
+		}
+
+		// Never take a player's only pawn away.
+		if (Pawn->IsPlayerControlled())
+		{
+			return false;
+		}
+	}
+
+	// The actor disappears now; the wreck and the actor's destruction are paid for on the frame the wreck spawns.
+	Actor->SetActorHiddenInGame(true);
+	Actor->SetActorEnableCollision(false);
+	Actor->SetActorTickEnabled(false);
+
+	FPendingDestruction& Pending = PendingDestructions.AddDefaulted_GetRef();
+	Pending.Actor = Actor;
+	Pending.Transform = CacheSet->Definitions[DefinitionIndex].RelativeTransform * Actor->GetActorTransform();
+	Pending.DefinitionIndex = DefinitionIndex;
+
+	return true;
+}
+
+void UDestructionSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SCOPE_CYCLE_COUNTER(STAT_DestructionUpdate);
+
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	Wrecks.RemoveAll([this, Now](const FWreck& Wreck)
+	{
+		if (Now < Wreck.ExpireTime && Wreck.GeometryActor.IsValid())
+		{
+			return false;
+		}
+
+		DestroyWreck(Wreck);
+		NumLiveWrecks -= Wreck.bLive ? 1 : 0;
+		return true;
+	});
+
+	const int32 MaxSpawns = FMath::Max(CVarDestructionSpawnsPerFrame.GetValueOnGameThread(), 1);
+	const int32 NumSpawns = FMath::Min(PendingDestructions.Num(), MaxSpawns);
+
+	for (int32 Index = 0; Index < NumSpawns; ++Index)
+	{
+		const FPendingDestruction& Pending = PendingDestructions[Index];
+
+		SpawnWreck(Pending, ShouldSimulateLive(Pending.Transform.GetLocation()));
+
+		if (AActor* Actor = Pending.Actor.Get())
+		{
+			Actor->Destroy();
+		}
+	}
+
+	PendingDestructions.RemoveAt(0, NumSpawns);
+
+	SET_DWORD_STAT(STAT_DestructionPending, PendingDestructions.Num());
+	SET_DWORD_STAT(STAT_DestructionLive, NumLiveWrecks);
+	SET_DWORD_STAT(STAT_DestructionCached, Wrecks.Num() - NumLiveWrecks);
+}
+
+bool UDestructionSubsystem::ShouldSimulateLive(const FVector& Location) const
+{
+	if (CVarDestructionForceCached.GetValueOnGameThread() || NumLiveWrecks >= CVarDestructionMaxLive.GetValueOnGameThread())
+	{
+		return false;
+	}
+
+	const float LiveDistanceSquared = FMath::Square(CVarDestructionLiveDistance.GetValueOnGameThread());
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (const APlayerController* PlayerController = It->Get(); PlayerController && PlayerController->PlayerCameraManager)
+		{
+			if (FVector::DistSquared(PlayerController->PlayerCameraManager->GetCameraLocation(), Location) <= LiveDistanceSquared)
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+void UDestructionSubsystem::SpawnWreck(const FPendingDestruction& Pending, bool bLive)
+{
+	SCOPE_CYCLE_COUNTER(STAT_DestructionSpawnWreck);
+
+	const FDestructionCacheDefinition& Definition = CacheSet->Definitions[Pending.DefinitionIndex];
+
+	// Without a recorded cache the only way to show the wreck is to simulate it.
+	bLive |= Definition.CacheCollection == nullptr;
+
+	const int32 MaxWrecks = FMath::Max(CVarDestructionMaxWrecks.GetValueOnGameThread(), 1);
+
+	while (Wrecks.Num() >= MaxWrecks)
+	{
+		DestroyWreck(Wrecks[0]);
+		NumLiveWrecks -= Wrecks[0].bLive ? 1 : 0;
+		Wrecks.RemoveAt(0);
+	}
+
+	UWorld* World = GetWorld();
+
+	AGeometryCollectionActor* GeometryActor = World->SpawnActorDeferred<AGeometryCollectionActor>(AGeometryCollectionActor::StaticClass(),
+		Pending.Transform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+
+	if (GeometryActor == nullptr)
+	{
+		return;
+	}
+
+	UGeometryCollectionComponent* GeometryComponent = GeometryActor->GetGeometryCollectionComponent();
+	GeometryComponent->SetRestCollection(Definition.GeometryCollection);
+
+	// Cached pieces are only ever moved by the cache, never by the solver.
+	GeometryComponent->ObjectType = bLive ? EObjectStateTypeEnum::Chaos_Object_Dynamic : EObjectStateTypeEnum::Chaos_Object_Kinematic;
+
+	GeometryActor->FinishSpawning(Pending.Transform);
+
+	FWreck& Wreck = Wrecks.AddDefaulted_GetRef();
+	Wreck.GeometryActor = GeometryActor;
+	Wreck.ExpireTime = World->GetTimeSeconds() + Definition.WreckLifeSpan;
+	Wreck.bLive = bLive;
+
+	if (bLive)
+	{
+		GeometryComponent->CrumbleActiveClusters();
+		++NumLiveWrecks;
+		return;
+	}
+
+	AChaosCacheManager* CacheManager = World->SpawnActorDeferred<AChaosCacheManager>(AChaosCacheManager::StaticClass(),
+		Pending.Transform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+
+	if (CacheManager == nullptr)
+	{
+		return;
+	}
+
+	// Playback starts as the manager begins play, driving the pieces from the recording.
+	CacheManager->CacheCollection = Definition.CacheCollection;
+	CacheManager->CacheMode = ECacheMode::Play;
+	CacheManager->StartMode = EStartMode::Timed;
+	CacheManager->StartTime = 0.f;
+	CacheManager->AddNewObservedComponent(GeometryComponent).CacheName = Definition.CacheName;
+
+	CacheManager->FinishSpawning(Pending.Transform);
+
+	Wreck.CacheManager = CacheManager;
+}
+
+void UDestructionSubsystem::DestroyWreck(const FWreck& Wreck) const
+{
+	if (AActor* CacheManager = Wreck.CacheManager.Get())
+	{
+		CacheManager->Destroy();
+	}
+
+	if (AActor* GeometryActor = Wreck.GeometryActor.Get())
+	{
+		GeometryActor->Destroy();
+	}
+}
+
+#if !UE_BUILD_SHIPPING
+namespace
+{
+	/** Frames sampled before and after the kills. The first frame after the command is skipped as it pays for any spawns. */
+	constexpr int32 kBenchmarkBaselineFrames = 30;
+	constexpr int32 kBenchmarkMeasuredFrames = 120;
+
+	void RunDestructionBenchmark(const TArray<FString>& Args, UWorld* World)
+	{
+		UDamageSubsystem* DamageSubsystem = World ? World->GetSubsystem<UDamageSubsystem>() : nullptr;
+		const APlayerController* PlayerController = World ? World->GetFirstPlayerController() : nullptr;
+
+		if (DamageSubsystem == nullptr || PlayerController == nullptr || PlayerController->GetPawn() == nullptr)
+		{
+			UE_LOG(LogTankGame, Warning, TEXT("Destruction benchmark: needs a game world with a player pawn"));
+			return;
+		}
+
+		const int32 NumKills = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 20;
+
+		TArray<TWeakObjectPtr<ATank>> Tanks;
+		UClass* TankClass = nullptr;
+
+		for (TActorIterator<ATank> It(World); It; ++It)
+		{
+			TankClass = It->GetClass();
+
+			if (!It->IsPlayerControlled() && It->HealthComponent && !It->HealthComponent->IsDead() && Tanks.Num() < NumKills)
+			{
+				Tanks.Add(*It);
+			}
+		}
+
+		if (TankClass == nullptr)
+		{
+			UE_LOG(LogTankGame, Warning, TEXT("Destruction benchmark: needs at least one tank in the world to copy"));
+			return;
+		}
+
+		// Make up the numbers with copies of an existing tank in a grid ahead of the player.
+		const FTransform PlayerTransform = PlayerController->GetPawn()->GetActorTransform();
+		constexpr float kSpacing = 1200.f;
+
+		for (int32 Index = Tanks.Num(); Index < NumKills; ++Index)
+		{
+			const FVector Offset(3000.f + (Index / 5) * kSpacing, ((Index % 5) - 2) * kSpacing, 200.f);
+			const FTransform SpawnTransform(PlayerTransform.GetRotation(), PlayerTransform.TransformPosition(Offset));
+
+			FActorSpawnParameters SpawnParams;
+			SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+			if (ATank* Tank = World->SpawnActor<ATank>(TankClass, SpawnTransform, SpawnParams))
+			{
+				Tanks.Add(Tank);
+			}
+		}
+
+		struct FBenchmarkState
+		{
+			int32 Frame = -1;
+			double BaselineTotal = 0.0;
+			double BaselineWorst = 0.0;
+			double MeasuredTotal = 0.0;
+			double MeasuredWorst = 0.0;
+		};
+
+		TSharedRef<FBenchmarkState> State = MakeShared<FBenchmarkState>();
+		TWeakObjectPtr<UWorld> WeakWorld = World;
+		TWeakObjectPtr<UDamageSubsystem> WeakDamageSubsystem = DamageSubsystem;
+
+		FTSTicker::GetCoreTicker().AddTicker(TEXT("DestructionBenchmark"), 0.f, [State, Tanks, WeakWorld, WeakDamageSubsystem](float DeltaTime)
+		{
+			if (!WeakWorld.IsValid() || !WeakDamageSubsystem.IsValid())
+			{
+				return false;
+			}
+
+			const double FrameMs = DeltaTime * 1000.0;
+			++State->Frame;
+
+			if (State->Frame == 0)
+			{
+				return true;
+			}
+
+			if (State->Frame <= kBenchmarkBaselineFrames)
+			{
+				State->BaselineTotal += FrameMs;
+				State->BaselineWorst = FMath::Max(State->BaselineWorst, FrameMs);
+
+				if (State->Frame == kBenchmarkBaselineFrames)
+				{
+					int32 NumQueued = 0;
+
+					for (const TWeakObjectPtr<ATank>& Tank : Tanks)
+					{
+						if (ATank* LiveTank = Tank.Get(); LiveTank && LiveTank->HealthComponent)
+						{
+							WeakDamageSubsystem->QueueDamage(LiveTank, LiveTank->HealthComponent->GetMaxHealth() * 10.f, EDamageKind::Shell, nullptr, nullptr);
+							++NumQueued;
+						}
+					}
+
+					UE_LOG(LogTankGame, Display, TEXT("Destruction benchmark: killing %d tanks this frame"), NumQueued);
+				}
+
+				return true;
+			}
+
+			State->MeasuredTotal += FrameMs;
+			State->MeasuredWorst = FMath::Max(State->MeasuredWorst, FrameMs);
+
+			if (State->Frame < kBenchmarkBaselineFrames + kBenchmarkMeasuredFrames)
+			{
+				return true;
+			}
+
+			UE_LOG(LogTankGame, Display, TEXT("Destruction benchmark: before the kills %.2f ms average, %.2f ms worst; after %.2f ms average, %.2f ms worst over %d frames"),
+				State->BaselineTotal / kBenchmarkBaselineFrames, State->BaselineWorst,
+				State->MeasuredTotal / kBenchmarkMeasuredFrames, State->MeasuredWorst, kBenchmarkMeasuredFrames);
+
+			return false;
+		});
+	}
+
+	FAutoConsoleCommandWithWorldAndArgs DestructionBenchmarkCommand(
+		TEXT("TankGame.Destruction.Benchmark"),
+		TEXT("Kills [Count] tanks (default 20) in one frame, spawning copies of an existing tank as needed, and logs frame times before and after. Toggle tg.Destruction.ForceCached to compare with live simulation."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunDestructionBenchmark));
+
+#if WITH_EDITOR
+	struct FCacheRecording
+	{
+		int32 DefinitionIndex = INDEX_NONE;
+		FName CacheName;
+		TWeakObjectPtr<AActor> GeometryActor;
+		TWeakObjectPtr<AActor> CacheManager;
+	};
+
+	/** Cache collection for definitions that have none yet, created next to the cache set on first use. */
+	UChaosCacheCollection* CreateCacheCollection(const UDestructionCacheSet* CacheSet)
+	{
+		const FString AssetName = CacheSet->GetName() + TEXT("_Caches");
+		const FString PackageName = FPackageName::GetLongPackagePath(CacheSet->GetOutermost()->GetName()) / AssetName;
+
+		UPackage* Package = CreatePackage(*PackageName);
+
+		if (UChaosCacheCollection* Existing = FindObject<UChaosCacheCollection>(Package, *AssetName))
+		{
+			return Existing;
+		}
+
+		UChaosCacheCollection* Collection = NewObject<UChaosCacheCollection>(Package, *AssetName, RF_Public | RF_Standalone);
+		IAssetRegistry::GetChecked().AssetCreated(Collection);
+		Collection->MarkPackageDirty();
+
+		return Collection;
+	}
+
+	void RecordDestructionCaches(const TArray<FString>& Args, UWorld* World)
+	{
+		UDestructionCacheSet* CacheSet = GetDefault<UTankGameSettings>()->DestructionCacheSet.LoadSynchronous();
+		const APlayerController* PlayerController = World && World->IsPlayInEditor() ? World->GetFirstPlayerController() : nullptr;
+
+		if (CacheSet == nullptr || PlayerController == nullptr || PlayerController->GetPawn() == nullptr)
+		{
+			UE_LOG(LogTankGame, Warning, TEXT("Destruction cache recording: needs a DestructionCacheSet and a Play In Editor world with a player pawn"));
+			return;
+		}
+
+		const float Duration = Args.Num() > 0 ? FMath::Max(FCString::Atof(*Args[0]), 1.f) : 10.f;
+
+		// Every definition is broken at once, in a row ahead of the player so the pieces land on real ground.
+		const FTransform PlayerTransform = PlayerController->GetPawn()->GetActorTransform();
+		constexpr float kSpacing = 2000.f;
+
+		UChaosCacheCollection* SharedCollection = nullptr;
+		TArray<FCacheRecording> Recordings;
+
+		for (int32 Index = 0; Index < CacheSet->Definitions.Num(); ++Index)
+		{
+			FDestructionCacheDefinition& Definition = CacheSet->Definitions[Index];
+
+			if (Definition.GeometryCollection == nullptr)
+			{
+				continue;
+			}
+
+			if (Definition.CacheCollection == nullptr)
+			{
+				SharedCollection = SharedCollection ? SharedCollection : CreateCacheCollection(CacheSet);
+				Definition.CacheCollection = SharedCollection;
+			}
+
+			const FVector Offset(3000.f, (Recordings.Num() - CacheSet->Definitions.Num() / 2) * kSpacing, 0.f);
+			const FTransform SpawnTransform = Definition.RelativeTransform
+				* FTransform(PlayerTransform.GetRotation(), PlayerTransform.TransformPosition(Offset));
+
+			AGeometryCollectionActor* GeometryActor = World->SpawnActorDeferred<AGeometryCollectionActor>(AGeometryCollectionActor::StaticClass(),
+				SpawnTransform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+
+			AChaosCacheManager* CacheManager = World->SpawnActorDeferred<AChaosCacheManager>(AChaosCacheManager::StaticClass(),
+				SpawnTransform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+
+			if (GeometryActor == nullptr || CacheManager == nullptr)
+			{
+				continue;
+			}
+
+			UGeometryCollectionComponent* GeometryComponent = GeometryActor->GetGeometryCollectionComponent();
+			GeometryComponent->SetRestCollection(Definition.GeometryCollection);
+			GeometryComponent->ObjectType = EObjectStateTypeEnum::Chaos_Object_Dynamic;
+
+			GeometryActor->FinishSpawning(SpawnTransform);
+
+			FCacheRecording& Recording = Recordings.AddDefaulted_GetRef();
+			Recording.DefinitionIndex = Index;
+			Recording.CacheName = !Definition.CacheName.IsNone() ? Definition.CacheName
+				: Definition.ActorClass ? Definition.ActorClass->GetFName() : Definition.GeometryCollection->GetFName();
+			Recording.GeometryActor = GeometryActor;
+			Recording.CacheManager = CacheManager;
+
+			// Recording starts as the manager begins play, the same way SpawnWreck starts playback.
+			CacheManager->CacheCollection = Definition.CacheCollection;
+			CacheManager->CacheMode = ECacheMode::Record;
+			CacheManager->StartMode = EStartMode::Timed;
+			CacheManager->StartTime = 0.f;
+			CacheManager->AddNewObservedComponent(GeometryComponent).CacheName = Recording.CacheName;
+
+			CacheManager->FinishSpawning(SpawnTransform);
+
+			GeometryComponent->CrumbleActiveClusters();
+		}
+
+		if (Recordings.IsEmpty())
+		{
+			UE_LOG(LogTankGame, Warning, TEXT("Destruction cache recording: no definition in %s has a geometry collection"), *CacheSet->GetName());
+			return;
+		}
+
+		UE_LOG(LogTankGame, Display, TEXT("Destruction cache recording: recording %d caches for %.1f s"), Recordings.Num(), Duration);
+
+		TSharedRef<float> Elapsed = MakeShared<float>(0.f);
+		TWeakObjectPtr<UWorld> WeakWorld = World;
+		TWeakObjectPtr<UDestructionCacheSet> WeakCacheSet = CacheSet;
+
+		FTSTicker::GetCoreTicker().AddTicker(TEXT("DestructionCacheRecording"), 0.f, [Elapsed, Duration, Recordings, WeakWorld, WeakCacheSet](float DeltaTime)
+		{
+			if (!WeakWorld.IsValid() || !WeakCacheSet.IsValid())
+			{
+				UE_LOG(LogTankGame, Warning, TEXT("Destruction cache recording: play ended before the recording finished, nothing was saved"));
+				return false;
+			}
+
+			*Elapsed += DeltaTime;
+
+			if (*Elapsed < Duration)
+			{
+				return true;
+			}
+
+			UDestructionCacheSet* CacheSet = WeakCacheSet.Get();
+
+			for (const FCacheRecording& Recording : Recordings)
+			{
+				// Ending play flushes the recorded frames into the collection.
+				if (AActor* CacheManager = Recording.CacheManager.Get())
+				{
+					CacheManager->Destroy();
+				}
+
+				if (AActor* GeometryActor = Recording.GeometryActor.Get())
+				{
+					GeometryActor->Destroy();
+				}
+
+				FDestructionCacheDefinition& Definition = CacheSet->Definitions[Recording.DefinitionIndex];
+				Definition.CacheName = Recording.CacheName;
+				Definition.CacheCollection->MarkPackageDirty();
+
+				UE_LOG(LogTankGame, Display, TEXT("Destruction cache recording: recorded %s into %s"),
+					*Recording.CacheName.ToString(), *Definition.CacheCollection->GetPathName());
+			}
+
+			CacheSet->MarkPackageDirty();
+
+			UE_LOG(LogTankGame, Display, TEXT("Destruction cache recording: done, save %s and its cache collections to keep the recordings"), *CacheSet->GetName());
+
+			return false;
+		});
+	}
+
+	FAutoConsoleCommandWithWorldAndArgs RecordDestructionCachesCommand(
+		TEXT("TankGame.Destruction.RecordCaches"),
+		TEXT("Play In Editor only. Breaks every geometry collection in the project's DestructionCacheSet ahead of the player, records [Seconds] (default 10) of each into its cache collection, creating one next to the set if needed, and fills in CacheCollection and CacheName."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RecordDestructionCaches));
+#endif
+}
+#endif
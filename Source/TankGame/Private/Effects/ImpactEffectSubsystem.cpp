@@ -0,0 +1,535 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+
+#include "Effects/ImpactEffectSubsystem.h"
+
+#include "TankGame.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Combat/HealthComponent.h"
+#include "Components/DecalComponent.h"
+#include "Containers/Ticker.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerController.h"
+#include "Particles/ParticleSystemComponent.h"
+#include "PhysicalMaterials/PhysicalMaterial.h"
+#include "Shared/TankGameSettings.h"
+#include "Tank/Tank.h"
+#include "UObject/UObjectIterator.h"
+
+DECLARE_CYCLE_STAT(TEXT("Spawn Effect"), STAT_ImpactEffectSpawn, STATGROUP_TankGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Effect Components Allocated"), STAT_ImpactEffectComponentsAllocated, STATGROUP_TankGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Active Effect Particles"), STAT_ImpactEffectActiveParticles, STATGROUP_TankGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Active Effect Decals"), STAT_ImpactEffectActiveDecals, STATGROUP_TankGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Effects Culled"), STAT_ImpactEffectsCulled, STATGROUP_TankGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Effects Stolen"), STAT_ImpactEffectsStolen, STATGROUP_TankGame);
+
+namespace
+{
+	uint16 MakeDefinitionKey(EImpactEffectType EffectType, EPhysicalSurface SurfaceType)
+	{
+		return static_cast<uint16>(static_cast<uint8>(EffectType)) << 8 | static_cast<uint8>(SurfaceType);
+	}
+
+	/** Oldest active slot using DefinitionIndex, or the oldest active slot of any kind when DefinitionIndex is INDEX_NONE. */
+	template <typename SlotType>
+	int32 FindOldestSlot(const TArray<SlotType>& Slots, int32 DefinitionIndex)
+	{
+		int32 OldestIndex = INDEX_NONE;
+		double OldestTime = TNumericLimits<double>::Max();
+
+		for (int32 SlotIndex = 0; SlotIndex < Slots.Num(); ++SlotIndex)
+		{
+			const SlotType& Slot = Slots[SlotIndex];
+
+			if (Slot.DefinitionIndex == INDEX_NONE || (DefinitionIndex != INDEX_NONE && Slot.DefinitionIndex != DefinitionIndex))
+			{
+				continue;
+			}
+
+			if (Slot.SpawnTime < OldestTime)
+			{
+				OldestTime = Slot.SpawnTime;
+				OldestIndex = SlotIndex;
+			}
+		}
+
+		return OldestIndex;
+	}
+}
+
+bool UImpactEffectSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UImpactEffectSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	const UTankGameSettings* Settings = GetDefault<UTankGameSettings>();
+
+	EffectSet = Settings->ImpactEffectSet.LoadSynchronous();
+
+	if (EffectSet == nullptr)
+	{
+		UE_LOG(LogTankGame, Warning, TEXT("ImpactEffectSubsystem: no ImpactEffectSet configured, impact effects are disabled"));
+		return;
+	}
+
+	for (int32 DefinitionIndex = 0; DefinitionIndex < EffectSet->Effects.Num(); ++DefinitionIndex)
+	{
+		const FImpactEffectDefinition& Definition = EffectSet->Effects[DefinitionIndex];
+		DefinitionLookup.Add(MakeDefinitionKey(Definition.EffectType, Definition.SurfaceType), DefinitionIndex);
+	}
+
+	ActiveParticleCounts.Init(0, EffectSet->Effects.Num());
+	ActiveDecalCounts.Init(0, EffectSet->Effects.Num());
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.Name = TEXT("ImpactEffectPool");
+	SpawnParams.ObjectFlags |= RF_Transient;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	PoolOwner = InWorld.SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParams);
+
+	if (PoolOwner == nullptr)
+	{
+		return;
+	}
+
+	ParticleComponents.Reserve(Settings->MaxPooledParticles);
+	ParticleSlots.SetNum(Settings->MaxPooledParticles);
+	FreeParticleSlots.Reserve(Settings->MaxPooledParticles);
+
+	for (int32 SlotIndex = 0; SlotIndex < Settings->MaxPooledParticles; ++SlotIndex)
+	{
+		UParticleSystemComponent* Component = NewObject<UParticleSystemComponent>(PoolOwner, NAME_None, RF_Transient);
+		Component->bAutoActivate = false;
+		Component->bAutoDestroy = false;
+		Component->SetUsingAbsoluteLocation(true);
+		Component->SetUsingAbsoluteRotation(true);
+		Component->SetUsingAbsoluteScale(true);
+		Component->OnSystemFinished.AddDynamic(this, &UImpactEffectSubsystem::OnParticleSystemFinished);
+		Component->RegisterComponent();
+
+		ParticleComponents.Add(Component);
+		FreeParticleSlots.Add(SlotIndex);
+	}
+
+	DecalComponents.Reserve(Settings->MaxPooledDecals);
+	DecalSlots.SetNum(Settings->MaxPooledDecals);
+	FreeDecalSlots.Reserve(Settings->MaxPooledDecals);
+
+	for (int32 SlotIndex = 0; SlotIndex < Settings->MaxPooledDecals; ++SlotIndex)
+	{
+		UDecalComponent* Component = NewObject<UDecalComponent>(PoolOwner, NAME_None, RF_Transient);
+		Component->SetUsingAbsoluteLocation(true);
+		Component->SetUsingAbsoluteRotation(true);
+		Component->SetUsingAbsoluteScale(true);
+		Component->SetVisibility(false);
+		Component->RegisterComponent();
+
+		DecalComponents.Add(Component);
+		FreeDecalSlots.Add(SlotIndex);
+	}
+
+	INC_DWORD_STAT_BY(STAT_ImpactEffectComponentsAllocated, ParticleComponents.Num() + DecalComponents.Num());
+}
+
+void UImpactEffectSubsystem::Deinitialize()
+{
+	DEC_DWORD_STAT_BY(STAT_ImpactEffectComponentsAllocated, ParticleComponents.Num() + DecalComponents.Num());
+
+	if (IsValid(PoolOwner))
+	{
+		PoolOwner->Destroy();
+	}
+
+	PoolOwner = nullptr;
+	ParticleComponents.Reset();
+	DecalComponents.Reset();
+	ParticleSlots.Reset();
+	DecalSlots.Reset();
+	FreeParticleSlots.Reset();
+	FreeDecalSlots.Reset();
+	DefinitionLookup.Reset();
+	NumActiveDecals = 0;
+
+	Super::Deinitialize();
+}
+
+void UImpactEffectSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (NumActiveDecals > 0)
+	{
+		const double Now = GetWorld()->GetTimeSeconds();
+
+		for (int32 SlotIndex = 0; SlotIndex < DecalSlots.Num(); ++SlotIndex)
+		{
+			const FPooledEffectSlot& Slot = DecalSlots[SlotIndex];
+
+			if (Slot.DefinitionIndex != INDEX_NONE && Slot.ExpireTime <= Now)
+			{
+				ReleaseDecalSlot(SlotIndex);
+			}
+		}
+	}
+
+	SET_DWORD_STAT(STAT_ImpactEffectActiveParticles, ParticleSlots.Num() - FreeParticleSlots.Num());
+	SET_DWORD_STAT(STAT_ImpactEffectActiveDecals, NumActiveDecals);
+}
+
+TStatId UImpactEffectSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UImpactEffectSubsystem, STATGROUP_Tickables);
+}
+
+bool UImpactEffectSubsystem::SpawnEffect(EImpactEffectType EffectType, EPhysicalSurface SurfaceType, const FVector& Location,
+	const FRotator& Rotation)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ImpactEffectSpawn);
+
+	const int32 DefinitionIndex = FindDefinition(EffectType, SurfaceType);
+
+	if (DefinitionIndex == INDEX_NONE)
+	{
+		return false;
+	}
+
+	const FImpactEffectDefinition& Definition = EffectSet->Effects[DefinitionIndex];
+
+	if (!IsRelevantToAnyPlayer(Location, Definition.CullDistance))
+	{
+		INC_DWORD_STAT(STAT_ImpactEffectsCulled);
+		return false;
+	}
+
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	if (Definition.ParticleTemplate && ParticleSlots.Num() > 0)
+	{
+		const int32 SlotIndex = AcquireSlot(ParticleSlots, FreeParticleSlots, ActiveParticleCounts, DefinitionIndex);
+
+		FPooledEffectSlot& Slot = ParticleSlots[SlotIndex];
+		Slot.DefinitionIndex = DefinitionIndex;
+		Slot.SpawnTime = Now;
+
+		UParticleSystemComponent* Component = ParticleComponents[SlotIndex];
+
+		if (Component->Template != Definition.ParticleTemplate)
+		{
+			Component->SetTemplate(Definition.ParticleTemplate);
+		}
+
+		Component->SetWorldLocationAndRotation(Location, Rotation);
+		Component->Activate(true);
+	}
+
+	if (Definition.DecalMaterial && DecalSlots.Num() > 0)
+	{
+		const int32 SlotIndex = AcquireSlot(DecalSlots, FreeDecalSlots, ActiveDecalCounts, DefinitionIndex);
+
+		FPooledEffectSlot& Slot = DecalSlots[SlotIndex];
+		Slot.DefinitionIndex = DefinitionIndex;
+		Slot.SpawnTime = Now;
+		Slot.ExpireTime = Now + Definition.DecalLifeSpan;
+
+		// Decals project along their X axis, so face into the surface rather than out of it.
+		UDecalComponent* Component = DecalComponents[SlotIndex];
+		Component->DecalSize = Definition.DecalSize;
+		Component->SetDecalMaterial(Definition.DecalMaterial);
+		Component->SetWorldLocationAndRotation(Location, (-Rotation.Vector()).Rotation());
+		Component->SetVisibility(true);
+
+		++NumActiveDecals;
+	}
+
+	return true;
+}
+
+bool UImpactEffectSubsystem::SpawnEffectAtHit(EImpactEffectType EffectType, const FHitResult& Hit)
+{
+	const EPhysicalSurface SurfaceType = UPhysicalMaterial::DetermineSurfaceType(Hit.PhysMaterial.Get());
+
+	return SpawnEffect(EffectType, SurfaceType, Hit.ImpactPoint, Hit.ImpactNormal.Rotation());
+}
+
+int32 UImpactEffectSubsystem::FindDefinition(EImpactEffectType EffectType, EPhysicalSurface SurfaceType) const
+{
+	if (const int32* DefinitionIndex = DefinitionLookup.Find(MakeDefinitionKey(EffectType, SurfaceType)))
+	{
+		return *DefinitionIndex;
+	}
+
+	if (const int32* DefaultIndex = DefinitionLookup.Find(MakeDefinitionKey(EffectType, SurfaceType_Default)))
+	{
+		return *DefaultIndex;
+	}
+
+	return INDEX_NONE;
+}
+
+bool UImpactEffectSubsystem::IsRelevantToAnyPlayer(const FVector& Location, float CullDistance) const
+{
+	const UTankGameSettings* Settings = GetDefault<UTankGameSettings>();
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+
+		if (PlayerController == nullptr || PlayerController->PlayerCameraManager == nullptr)
+		{
+			continue;
+		}
+
+		const APlayerCameraManager* CameraManager = PlayerController->PlayerCameraManager;
+		const FVector ToEffect = Location - CameraManager->GetCameraLocation();
+		const double DistanceSquared = ToEffect.SizeSquared();
+
+		if (DistanceSquared > FMath::Square(CullDistance))
+		{
+			continue;
+		}
+
+		if (DistanceSquared <= FMath::Square(Settings->EffectAlwaysRelevantDistance))
+		{
+			return true;
+		}
+
+		const float HalfAngle = FMath::Min(CameraManager->GetFOVAngle() * 0.5f + Settings->EffectOffScreenMargin, 180.f);
+		const double CosAngle = (ToEffect * FMath::InvSqrt(DistanceSquared)) | CameraManager->GetCameraRotation().Vector();
+
+		if (CosAngle >= FMath::Cos(FMath::DegreesToRadians(HalfAngle)))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+int32 UImpactEffectSubsystem::AcquireSlot(TArray<FPooledEffectSlot>& Slots, TArray<int32>& FreeSlots, TArray<int32>& ActiveCounts,
+	int32 DefinitionIndex)
+{
+	const bool bIsParticlePool = &Slots == &ParticleSlots;
+	int32 StealIndex = INDEX_NONE;
+
+	if (ActiveCounts[DefinitionIndex] >= EffectSet->Effects[DefinitionIndex].MaxActive)
+	{
+		StealIndex = FindOldestSlot(Slots, DefinitionIndex);
+	}
+	else if (FreeSlots.IsEmpty())
+	{
+		StealIndex = FindOldestSlot(Slots, INDEX_NONE);
+	}
+
+	if (StealIndex != INDEX_NONE)
+	{
+		INC_DWORD_STAT(STAT_ImpactEffectsStolen);
+
+		if (bIsParticlePool)
+		{
+			ReleaseParticleSlot(StealIndex);
+		}
+		else
+		{
+			ReleaseDecalSlot(StealIndex);
+		}
+	}
+
+	++ActiveCounts[DefinitionIndex];
+
+	return FreeSlots.Pop(EAllowShrinking::No);
+}
+
+void UImpactEffectSubsystem::ReleaseParticleSlot(int32 SlotIndex)
+{
+	FPooledEffectSlot& Slot = ParticleSlots[SlotIndex];
+
+	if (Slot.DefinitionIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	--ActiveParticleCounts[Slot.DefinitionIndex];
+	Slot.DefinitionIndex = INDEX_NONE;
+	FreeParticleSlots.Push(SlotIndex);
+
+	// The slot is already free, so the OnSystemFinished this may broadcast is ignored.
+	UParticleSystemComponent* Component = ParticleComponents[SlotIndex];
+
+	if (Component->IsActive())
+	{
+		Component->DeactivateImmediate();
+	}
+}
+
+void UImpactEffectSubsystem::ReleaseDecalSlot(int32 SlotIndex)
+{
+	FPooledEffectSlot& Slot = DecalSlots[SlotIndex];
+
+	if (Slot.DefinitionIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	--ActiveDecalCounts[Slot.DefinitionIndex];
+	--NumActiveDecals;
+	Slot.DefinitionIndex = INDEX_NONE;
+	FreeDecalSlots.Push(SlotIndex);
+
+	DecalComponents[SlotIndex]->SetVisibility(false);
+}
+
+void UImpactEffectSubsystem::OnParticleSystemFinished(UParticleSystemComponent* ParticleSystem)
+{
+	const int32 SlotIndex = ParticleComponents.IndexOfByKey(ParticleSystem);
+
+	if (SlotIndex != INDEX_NONE)
+	{
+		ReleaseParticleSlot(SlotIndex);
+	}
+}
+
+#if !UE_BUILD_SHIPPING
+namespace
+{
+	/** Particle and decal components currently alive in World, pooled or not. */
+	int32 CountEffectComponents(const UWorld* World)
+	{
+		int32 Count = 0;
+
+		for (TObjectIterator<UParticleSystemComponent> It; It; ++It)
+		{
+			Count += It->GetWorld() == World ? 1 : 0;
+		}
+
+		for (TObjectIterator<UDecalComponent> It; It; ++It)
+		{
+			Count += It->GetWorld() == World ? 1 : 0;
+		}
+
+		return Count;
+	}
+
+	void RunImpactEffectStress(const TArray<FString>& Args, UWorld* World)
+	{
+		const APlayerController* PlayerController = World ? World->GetFirstPlayerController() : nullptr;
+
+		if (PlayerController == nullptr || PlayerController->GetPawn() == nullptr || World->GetSubsystem<UImpactEffectSubsystem>() == nullptr)
+		{
+			UE_LOG(LogTankGame, Warning, TEXT("Impact effect stress: needs a game world with a player pawn"));
+			return;
+		}
+
+		const int32 NumTanks = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 30;
+		const float Duration = Args.Num() > 1 ? FMath::Max(FCString::Atof(*Args[1]), 1.f) : 10.f;
+		const float ShotsPerSecond = Args.Num() > 2 ? FMath::Max(FCString::Atof(*Args[2]), 0.1f) : 4.f;
+
+		TArray<TWeakObjectPtr<ATank>> Tanks;
+		UClass* TankClass = nullptr;
+
+		for (TActorIterator<ATank> It(World); It; ++It)
+		{
+			TankClass = It->GetClass();
+
+			if (!It->IsPlayerControlled() && Tanks.Num() < NumTanks)
+			{
+				Tanks.Add(*It);
+			}
+		}
+
+		if (TankClass == nullptr)
+		{
+			UE_LOG(LogTankGame, Warning, TEXT("Impact effect stress: needs at least one tank in the world to copy"));
+			return;
+		}
+
+		// Make up the numbers with copies of an existing tank in a grid ahead of the player, all facing the same way.
+		const FTransform PlayerTransform = PlayerController->GetPawn()->GetActorTransform();
+		constexpr float kSpacing = 1200.f;
+
+		for (int32 Index = Tanks.Num(); Index < NumTanks; ++Index)
+		{
+			const FVector Offset(3000.f + (Index / 6) * kSpacing, ((Index % 6) - 2.5f) * kSpacing, 200.f);
+			const FTransform SpawnTransform(PlayerTransform.GetRotation(), PlayerTransform.TransformPosition(Offset));
+
+			FActorSpawnParameters SpawnParams;
+			SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+			if (ATank* Tank = World->SpawnActor<ATank>(TankClass, SpawnTransform, SpawnParams))
+			{
+				Tanks.Add(Tank);
+			}
+		}
+
+		struct FStressState
+		{
+			int32 Frame = -1;
+			int32 ComponentsAtStart = 0;
+			int32 ShotsFired = 0;
+			double ElapsedSeconds = 0.0;
+			double ShotAccumulator = 0.0;
+		};
+
+		TSharedRef<FStressState> State = MakeShared<FStressState>();
+		TWeakObjectPtr<UWorld> WeakWorld = World;
+
+		FTSTicker::GetCoreTicker().AddTicker(TEXT("ImpactEffectStress"), 0.f, [State, Tanks, WeakWorld, Duration, ShotsPerSecond](float DeltaTime)
+		{
+			UWorld* LiveWorld = WeakWorld.Get();
+
+			if (LiveWorld == nullptr)
+			{
+				return false;
+			}
+
+			// Count after the spawn frame so the tanks' own components are part of the baseline.
+			if (++State->Frame == 0)
+			{
+				State->ComponentsAtStart = CountEffectComponents(LiveWorld);
+				UE_LOG(LogTankGame, Display, TEXT("Impact effect stress: %d tanks firing %.1f shots/s each for %.0f s"), Tanks.Num(), ShotsPerSecond, Duration);
+				return true;
+			}
+
+			State->ElapsedSeconds += DeltaTime;
+			State->ShotAccumulator += DeltaTime * ShotsPerSecond;
+
+			const int32 Volleys = FMath::FloorToInt32(State->ShotAccumulator);
+			State->ShotAccumulator -= Volleys;
+
+			for (int32 Volley = 0; Volley < Volleys; ++Volley)
+			{
+				for (const TWeakObjectPtr<ATank>& Tank : Tanks)
+				{
+					if (ATank* LiveTank = Tank.Get(); LiveTank && LiveTank->HealthComponent && !LiveTank->HealthComponent->IsDead())
+					{
+						LiveTank->FireGun();
+						++State->ShotsFired;
+					}
+				}
+			}
+
+			if (State->ElapsedSeconds < Duration)
+			{
+				return true;
+			}
+
+			const int32 ComponentsAtEnd = CountEffectComponents(LiveWorld);
+
+			UE_LOG(LogTankGame, Display, TEXT("Impact effect stress: %d shots, particle and decal components %d -> %d (%+d)"),
+				State->ShotsFired, State->ComponentsAtStart, ComponentsAtEnd, ComponentsAtEnd - State->ComponentsAtStart);
+
+			return false;
+		});
+	}
+
+	FAutoConsoleCommandWithWorldAndArgs ImpactEffectStressCommand(
+		TEXT("TankGame.Effects.Stress"),
+		TEXT("Sustained fire from [Count] tanks (default 30) for [Seconds] (default 10) at [ShotsPerSecond] each (default 4), spawning copies of an existing tank as needed. Logs how many particle and decal components were created while firing, which should be zero."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunImpactEffectStress));
+}
+#endif
@@ -4,21 +4,22 @@
 #include "Input/CharacterPlayerController.h"
 
 #include "Character/MainCharacter.h"
+#include "Components/CapsuleComponent.h"
 #include "EnhancedInputComponent.h"
 #include "EnhancedInputSubsystems.h"
 #include "GameFramework/Character.h"
 #include "GameFramework/CharacterMovementComponent.h"
+#include "Input/InputLatencyTracker.h"
+#include "Tank/Tank.h"
 
 void ACharacterPlayerController::BeginPlay()
 {
 	Super::BeginPlay();
 
-	if (UEnhancedInputLocalPlayerSubsystem* Subsystem = ULocalPlayer::GetSubsystem<UEnhancedInputLocalPlayerSubsystem>(GetLocalPlayer()))
-	{
-		Subsystem->AddMappingContext(DefaultMappingContext, 0);
-	}
+	// The local player may not have existed yet when the pawn was first set.
+	RefreshControlledPawn();
 
-	if (ACharacter* ControlledCharacter = GetCharacter())
+	if (ControlledCharacter)
 	{
 		ControlledCharacter->GetCharacterMovement()->MaxWalkSpeed = WalkSpeed;
 	}
@@ -46,40 +47,158 @@ void ACharacterPlayerController::SetupInputComponent()
 
 		EnhancedInputComponent->BindAction(CrouchAction, ETriggerEvent::Triggered, this, &ACharacterPlayerController::ToggleCrouch);
 
-		EnhancedInputComponent->BindAction(CameraZoomAction, ETriggerEvent::Triggered, this, &ACharacterPlayerController::CameraZoom);		
+		EnhancedInputComponent->BindAction(CameraZoomAction, ETriggerEvent::Triggered, this, &ACharacterPlayerController::CameraZoom);
+
+		EnhancedInputComponent->BindAction(EnterVehicleAction, ETriggerEvent::Started, this, &ACharacterPlayerController::EnterVehicle);
+
+		EnhancedInputComponent->BindAction(TankThrottleAction, ETriggerEvent::Started, this, &ACharacterPlayerController::StartTankThrottle);
+		EnhancedInputComponent->BindAction(TankThrottleAction, ETriggerEvent::Triggered, this, &ACharacterPlayerController::TankThrottle);
+		EnhancedInputComponent->BindAction(TankThrottleAction, ETriggerEvent::Completed, this, &ACharacterPlayerController::TankThrottle);
+
+		EnhancedInputComponent->BindAction(TankSteerAction, ETriggerEvent::Triggered, this, &ACharacterPlayerController::TankSteer);
+		EnhancedInputComponent->BindAction(TankSteerAction, ETriggerEvent::Completed, this, &ACharacterPlayerController::TankSteer);
+
+		EnhancedInputComponent->BindAction(TankHandbrakeAction, ETriggerEvent::Triggered, this, &ACharacterPlayerController::TankHandbrake);
+		EnhancedInputComponent->BindAction(TankHandbrakeAction, ETriggerEvent::Completed, this, &ACharacterPlayerController::TankHandbrake);
+
+		EnhancedInputComponent->BindAction(TankFireAction, ETriggerEvent::Started, this, &ACharacterPlayerController::TankFire);
+		EnhancedInputComponent->BindAction(ExitVehicleAction, ETriggerEvent::Started, this, &ACharacterPlayerController::ExitVehicle);
+	}
+}
+
+void ACharacterPlayerController::SetPawn(APawn* InPawn)
+{
+	Super::SetPawn(InPawn);
+
+	RefreshControlledPawn();
+}
+
+void ACharacterPlayerController::RefreshControlledPawn()
+{
+	APawn* ControlledPawn = GetPawn();
+
+	ControlledCharacter = Cast<AMainCharacter>(ControlledPawn);
+	IVehicle* Vehicle = Cast<IVehicle>(ControlledPawn);
+	ControlledVehicle.SetObject(Vehicle ? ControlledPawn : nullptr);
+	ControlledVehicle.SetInterface(Vehicle);
+
+	UInputMappingContext* DesiredMappingContext = ControlledVehicle ? TankMappingContext : DefaultMappingContext;
+	UEnhancedInputLocalPlayerSubsystem* Subsystem = ULocalPlayer::GetSubsystem<UEnhancedInputLocalPlayerSubsystem>(GetLocalPlayer());
+
+	if (Subsystem == nullptr || DesiredMappingContext == ActiveMappingContext)
+	{
+		return;
+	}
+
+	if (ActiveMappingContext)
+	{
+		Subsystem->RemoveMappingContext(ActiveMappingContext);
+	}
+
+	if (DesiredMappingContext)
+	{
+		Subsystem->AddMappingContext(DesiredMappingContext, 0);
+	}
+
+	ActiveMappingContext = DesiredMappingContext;
+}
+
+void ACharacterPlayerController::PreProcessInput(const float DeltaTime, const bool bGamePaused)
+{
+	Super::PreProcessInput(DeltaTime, bGamePaused);
+
+	FInputLatencyTracker::Get().MarkInputSampled();
+}
+
+void ACharacterPlayerController::PlayerTick(float DeltaTime)
+{
+	Super::PlayerTick(DeltaTime);
+
+	FInputLatencyTracker::Get().UpdateStats();
+}
+
+void ACharacterPlayerController::EnterVehicle()
+{
+	if (ControlledCharacter == nullptr)
+	{
+		return;
+	}
+
+	EnterTank(ControlledCharacter->FindEnterableTank());
+}
+
+void ACharacterPlayerController::EnterTank(ATank* Tank)
+{
+	if (ControlledCharacter == nullptr || Tank == nullptr || Tank->GetController() != nullptr)
+	{
+		return;
 	}
+
+	// The character rides along hidden inside the tank until it exits.
+	ParkedCharacter = ControlledCharacter;
+	ParkedCharacter->GetCharacterMovement()->StopMovementImmediately();
+	ParkedCharacter->SetActorHiddenInGame(true);
+	ParkedCharacter->SetActorEnableCollision(false);
+	ParkedCharacter->AttachToActor(Tank, FAttachmentTransformRules::KeepWorldTransform);
+
+	Tank->EnterVehicle();
+	Possess(Tank);
+}
+
+void ACharacterPlayerController::ExitVehicle()
+{
+	if (!ControlledVehicle || ParkedCharacter == nullptr)
+	{
+		return;
+	}
+
+	IVehicle* Vehicle = ControlledVehicle.GetInterface();
+
+	Vehicle->SetThrottleInput(0.f);
+	Vehicle->SetSteeringInput(0.f);
+	Vehicle->SetHandbrakeInput(true);
+	Vehicle->ExitVehicle();
+
+	const FTransform ExitTransform = Vehicle->GetExitTransform();
+
+	AMainCharacter* Character = ParkedCharacter;
+	ParkedCharacter = nullptr;
+
+	Character->DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+	Character->SetActorLocationAndRotation(ExitTransform.GetLocation(), ExitTransform.GetRotation(), false, nullptr,
+		ETeleportType::ResetPhysics);
+	Character->SetActorEnableCollision(true);
+	Character->SetActorHiddenInGame(false);
+
+	Possess(Character);
+
+	Character->GetCharacterMovement()->SetMovementMode(MOVE_Walking);
 }
 
 void ACharacterPlayerController::Move(const FInputActionValue& Value)
 {
 	FVector2D MovementVector = Value.Get<FVector2D>();
 
-	if (GetCharacter())
+	if (ControlledCharacter)
 	{
-		if (ACharacter* ControlledCharacter = GetCharacter())
-		{
-			ControlledCharacter->GetCharacterMovement()->bOrientRotationToMovement = false;
+		ControlledCharacter->GetCharacterMovement()->bOrientRotationToMovement = false;
 
-			const FRotator Rotation = GetControlRotation();
-			const FRotator CameraRotation(0, Rotation.Yaw, 0);
+		const FRotator Rotation = GetControlRotation();
+		const FRotator CameraRotation(0, Rotation.Yaw, 0);
 
-			const FVector ForwardDirection = FRotationMatrix(CameraRotation).GetUnitAxis(EAxis::X);
-			ControlledCharacter->AddMovementInput(ForwardDirection, MovementVector.Y);
+		const FVector ForwardDirection = FRotationMatrix(CameraRotation).GetUnitAxis(EAxis::X);
+		ControlledCharacter->AddMovementInput(ForwardDirection, MovementVector.Y);
 
-			const FVector RightDirection = FRotationMatrix(CameraRotation).GetUnitAxis(EAxis::Y);
-			ControlledCharacter->AddMovementInput(RightDirection, MovementVector.X);
-		}
+		const FVector RightDirection = FRotationMatrix(CameraRotation).GetUnitAxis(EAxis::Y);
+		ControlledCharacter->AddMovementInput(RightDirection, MovementVector.X);
 	}
 }
 
 void ACharacterPlayerController::StopMove()
 {
-	if (GetCharacter())
+	if (ControlledCharacter)
 	{
-		if (ACharacter* ControlledCharacter = CastChecked<ACharacter>(GetCharacter()))
-		{
-			ControlledCharacter->GetCharacterMovement()->bOrientRotationToMovement = true;
-		}
+		ControlledCharacter->GetCharacterMovement()->bOrientRotationToMovement = true;
 	}
 }
 
@@ -93,109 +212,130 @@ void ACharacterPlayerController::Look(const FInputActionValue& Value)
 
 void ACharacterPlayerController::Jump()
 {
-	if (GetCharacter())
+	if (ControlledCharacter)
 	{
-		if (ACharacter* ControlledCharacter = GetCharacter())
-		{
-			ControlledCharacter->Jump();
-		}
+		ControlledCharacter->Jump();
 	}
 }
 
 void ACharacterPlayerController::StopJumping()
 {
-	if (GetCharacter())
+	if (ControlledCharacter)
 	{
-		if (ACharacter* ControlledCharacter = GetCharacter())
-		{
-			ControlledCharacter->StopJumping();
-		}
+		ControlledCharacter->StopJumping();
 	}
 }
 
 void ACharacterPlayerController::StartSprint()
 {
-	if (GetCharacter())
+	if (ControlledCharacter)
 	{
-		if (ACharacter* ControlledCharacter = GetCharacter())
-		{
-			ControlledCharacter->GetCharacterMovement()->MaxWalkSpeed = RunSpeed;
-		}
+		ControlledCharacter->GetCharacterMovement()->MaxWalkSpeed = RunSpeed;
 	}
 }
 
 void ACharacterPlayerController::StopSprint()
 {
-	if (GetCharacter())
+	if (ControlledCharacter)
 	{
-		if (ACharacter* ControlledCharacter = GetCharacter())
-		{
-			ControlledCharacter->GetCharacterMovement()->MaxWalkSpeed = WalkSpeed;
-		}
+		ControlledCharacter->GetCharacterMovement()->MaxWalkSpeed = WalkSpeed;
 	}
 }
 
 void ACharacterPlayerController::Attack()
 {
-	if (GetCharacter())
+	if (ControlledCharacter)
 	{
-		if (AMainCharacter* ControlledCharacter = CastChecked<AMainCharacter>(GetCharacter()))
-		{
-			ControlledCharacter->Attack();
-		}
+		FInputLatencyTracker::Get().Begin(ControlledCharacter->bIsAiming ? EInputLatencyAction::HitscanFire : EInputLatencyAction::MeleeAttack);
+
+		ControlledCharacter->Attack();
 	}
 }
 
 void ACharacterPlayerController::ToggleAim()
 {
-	if (GetCharacter())
+	if (ControlledCharacter)
 	{
-		if (AMainCharacter* ControlledCharacter = CastChecked<AMainCharacter>(GetCharacter()))
+		if (ControlledCharacter->IsAttacking())
+		{
+			return;
+		}
+
+		if (ControlledCharacter->bIsAiming)
+		{
+			ControlledCharacter->Aim(false);
+		}
+		else
 		{
-			if (ControlledCharacter->IsAttacking())
-			{
-				return;
-			}
-
-			if (ControlledCharacter->bIsAiming)
-			{
-				ControlledCharacter->Aim(false);
-			}
-			else
-			{
-				ControlledCharacter->Aim(true);
-			}
+			ControlledCharacter->Aim(true);
 		}
 	}
 }
 
 void ACharacterPlayerController::ToggleCrouch()
 {
-	if (GetCharacter())
+	if (ControlledCharacter)
 	{
-		if (AMainCharacter* ControlledCharacter = CastChecked<AMainCharacter>(GetCharacter()))
+		if (ControlledCharacter->IsCrouched())
 		{
-			if (ControlledCharacter->IsCrouched())
-			{
-				ControlledCharacter->UnCrouch();
-			}
-			else
-			{
-				ControlledCharacter->Crouch();
-			}
+			ControlledCharacter->UnCrouch();
+		}
+		else
+		{
+			ControlledCharacter->Crouch();
 		}
 	}
 }
 
 void ACharacterPlayerController::CameraZoom(const FInputActionValue& Value)
 {
-	if (GetCharacter())
+	if (ControlledCharacter)
 	{
-		if (AMainCharacter* ControlledCharacter = CastChecked<AMainCharacter>(GetCharacter()))
-		{
-			float ActionValue = Value.Get<float>();
-			
-			ControlledCharacter->ZoomCamera(ActionValue);
-		}
+		float ActionValue = Value.Get<float>();
+
+		ControlledCharacter->ZoomCamera(ActionValue);
+	}
+}
+
+void ACharacterPlayerController::TankThrottle(const FInputActionValue& Value)
+{
+	if (ControlledVehicle)
+	{
+		ControlledVehicle->SetThrottleInput(Value.Get<float>());
+	}
+}
+
+void ACharacterPlayerController::StartTankThrottle()
+{
+	// Only the press is measured. Triggered fires every frame the throttle is held, after Started on the first.
+	if (ControlledVehicle)
+	{
+		FInputLatencyTracker::Get().Begin(EInputLatencyAction::TankThrottle);
+	}
+}
+
+void ACharacterPlayerController::TankSteer(const FInputActionValue& Value)
+{
+	if (ControlledVehicle)
+	{
+		ControlledVehicle->SetSteeringInput(Value.Get<float>());
+	}
+}
+
+void ACharacterPlayerController::TankHandbrake(const FInputActionValue& Value)
+{
+	if (ControlledVehicle)
+	{
+		ControlledVehicle->SetHandbrakeInput(Value.Get<bool>());
+	}
+}
+
+void ACharacterPlayerController::TankFire()
+{
+	if (ControlledVehicle)
+	{
+		FInputLatencyTracker::Get().Begin(EInputLatencyAction::TankFire);
+
+		ControlledVehicle->FirePrimary();
 	}
 }
@@ -0,0 +1,228 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+
+#include "Input/InputLatencyTracker.h"
+
+#include "TankGame.h"
+#include "Framework/Application/IInputProcessor.h"
+#include "Framework/Application/SlateApplication.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_STATS_GROUP(TEXT("TankGameInput"), STATGROUP_TankGameInput, STATCAT_Advanced);
+
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Melee Attack p50 (ms)"), STAT_InputLatencyMeleeP50, STATGROUP_TankGameInput);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Melee Attack p95 (ms)"), STAT_InputLatencyMeleeP95, STATGROUP_TankGameInput);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Melee Attack p99 (ms)"), STAT_InputLatencyMeleeP99, STATGROUP_TankGameInput);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Hitscan Fire p50 (ms)"), STAT_InputLatencyHitscanP50, STATGROUP_TankGameInput);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Hitscan Fire p95 (ms)"), STAT_InputLatencyHitscanP95, STATGROUP_TankGameInput);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Hitscan Fire p99 (ms)"), STAT_InputLatencyHitscanP99, STATGROUP_TankGameInput);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Tank Throttle p50 (ms)"), STAT_InputLatencyThrottleP50, STATGROUP_TankGameInput);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Tank Throttle p95 (ms)"), STAT_InputLatencyThrottleP95, STATGROUP_TankGameInput);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Tank Throttle p99 (ms)"), STAT_InputLatencyThrottleP99, STATGROUP_TankGameInput);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Tank Fire p50 (ms)"), STAT_InputLatencyTankFireP50, STATGROUP_TankGameInput);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Tank Fire p95 (ms)"), STAT_InputLatencyTankFireP95, STATGROUP_TankGameInput);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Tank Fire p99 (ms)"), STAT_InputLatencyTankFireP99, STATGROUP_TankGameInput);
+
+namespace
+{
+	constexpr double kStatsInterval = 0.5;
+
+	/** Input older than this when the controller processes input was not what triggered this frame's events. */
+	constexpr double kMaxInputAge = 0.25;
+
+	/** Analog inputs count as a press when they move past this from rest. */
+	constexpr float kAnalogPressThreshold = 0.1f;
+
+	const TCHAR* const kActionNames[] = { TEXT("MeleeAttack"), TEXT("HitscanFire"), TEXT("TankThrottle"), TEXT("TankFire") };
+	static_assert(UE_ARRAY_COUNT(kActionNames) == static_cast<int32>(EInputLatencyAction::MAX), "Name every input latency action");
+
+	/** Timestamps presses as Slate receives them, before any widget or the game viewport handles them. Never consumes input. */
+	class FInputLatencyProcessor : public IInputProcessor
+	{
+	public:
+		virtual void Tick(const float DeltaTime, FSlateApplication& SlateApp, TSharedRef<ICursor> Cursor) override
+		{
+		}
+
+		virtual bool HandleKeyDownEvent(FSlateApplication& SlateApp, const FKeyEvent& InKeyEvent) override
+		{
+			if (!InKeyEvent.IsRepeat())
+			{
+				FInputLatencyTracker::Get().MarkInputEvent();
+			}
+
+			return false;
+		}
+
+		virtual bool HandleMouseButtonDownEvent(FSlateApplication& SlateApp, const FPointerEvent& MouseEvent) override
+		{
+			FInputLatencyTracker::Get().MarkInputEvent();
+			return false;
+		}
+
+		virtual bool HandleAnalogInputEvent(FSlateApplication& SlateApp, const FAnalogInputEvent& InAnalogInputEvent) override
+		{
+			const FKey Key = InAnalogInputEvent.GetKey();
+
+			if (FMath::Abs(InAnalogInputEvent.GetAnalogValue()) <= kAnalogPressThreshold)
+			{
+				DeflectedKeys.Remove(Key);
+			}
+			else if (!DeflectedKeys.Contains(Key))
+			{
+				DeflectedKeys.Add(Key);
+				FInputLatencyTracker::Get().MarkInputEvent();
+			}
+
+			return false;
+		}
+
+		virtual const TCHAR* GetDebugName() const override { return TEXT("InputLatency"); }
+
+	private:
+		TSet<FKey> DeflectedKeys;
+	};
+}
+
+FInputLatencyTracker& FInputLatencyTracker::Get()
+{
+	static FInputLatencyTracker Tracker;
+	return Tracker;
+}
+
+void FInputLatencyTracker::MarkInputSampled()
+{
+	if (!InputProcessor.IsValid() && FSlateApplication::IsInitialized())
+	{
+		InputProcessor = MakeShared<FInputLatencyProcessor>();
+		FSlateApplication::Get().RegisterInputPreProcessor(InputProcessor);
+	}
+
+	const double Now = FPlatformTime::Seconds();
+
+	InputSampleTime = (LastInputEventTime <= Now && Now - LastInputEventTime <= kMaxInputAge) ? LastInputEventTime : Now;
+}
+
+void FInputLatencyTracker::MarkInputEvent()
+{
+	LastInputEventTime = FPlatformTime::Seconds();
+}
+
+void FInputLatencyTracker::Begin(EInputLatencyAction Action)
+{
+	Actions[static_cast<int32>(Action)].PendingStart = InputSampleTime;
+}
+
+void FInputLatencyTracker::End(EInputLatencyAction Action)
+{
+	FActionSamples& Samples = Actions[static_cast<int32>(Action)];
+
+	if (Samples.PendingStart < 0.0)
+	{
+		return;
+	}
+
+	const float LatencyMs = static_cast<float>((FPlatformTime::Seconds() - Samples.PendingStart) * 1000.0);
+	Samples.PendingStart = -1.0;
+
+	if (Samples.LatencyMs.Num() < MaxSamples)
+	{
+		Samples.LatencyMs.Add(LatencyMs);
+	}
+	else
+	{
+		Samples.LatencyMs[Samples.NextSample] = LatencyMs;
+		Samples.NextSample = (Samples.NextSample + 1) % MaxSamples;
+	}
+}
+
+void FInputLatencyTracker::Cancel(EInputLatencyAction Action)
+{
+	Actions[static_cast<int32>(Action)].PendingStart = -1.0;
+}
+
+bool FInputLatencyTracker::GetPercentiles(EInputLatencyAction Action, float& OutP50, float& OutP95, float& OutP99) const
+{
+	const FActionSamples& Samples = Actions[static_cast<int32>(Action)];
+
+	if (Samples.LatencyMs.Num() == 0)
+	{
+		return false;
+	}
+
+	TArray<float, TInlineAllocator<MaxSamples>> Sorted(Samples.LatencyMs);
+	Sorted.Sort();
+
+	const auto Percentile = [&Sorted](float Fraction) { return Sorted[FMath::Min(FMath::FloorToInt32(Fraction * Sorted.Num()), Sorted.Num() - 1)]; };
+
+	OutP50 = Percentile(0.5f);
+	OutP95 = Percentile(0.95f);
+	OutP99 = Percentile(0.99f);
+	return true;
+}
+
+void FInputLatencyTracker::UpdateStats()
+{
+#if STATS
+	const double Now = FPlatformTime::Seconds();
+
+	if (Now - LastStatsTime < kStatsInterval)
+	{
+		return;
+	}
+
+	LastStatsTime = Now;
+
+	const FName StatNames[][3] =
+	{
+		{ GET_STATFNAME(STAT_InputLatencyMeleeP50), GET_STATFNAME(STAT_InputLatencyMeleeP95), GET_STATFNAME(STAT_InputLatencyMeleeP99) },
+		{ GET_STATFNAME(STAT_InputLatencyHitscanP50), GET_STATFNAME(STAT_InputLatencyHitscanP95), GET_STATFNAME(STAT_InputLatencyHitscanP99) },
+		{ GET_STATFNAME(STAT_InputLatencyThrottleP50), GET_STATFNAME(STAT_InputLatencyThrottleP95), GET_STATFNAME(STAT_InputLatencyThrottleP99) },
+		{ GET_STATFNAME(STAT_InputLatencyTankFireP50), GET_STATFNAME(STAT_InputLatencyTankFireP95), GET_STATFNAME(STAT_InputLatencyTankFireP99) },
+	};
+	static_assert(UE_ARRAY_COUNT(StatNames) == static_cast<int32>(EInputLatencyAction::MAX), "Declare stats for every input latency action");
+
+	for (int32 ActionIndex = 0; ActionIndex < UE_ARRAY_COUNT(StatNames); ++ActionIndex)
+	{
+		float Percentiles[3];
+
+		if (GetPercentiles(static_cast<EInputLatencyAction>(ActionIndex), Percentiles[0], Percentiles[1], Percentiles[2]))
+		{
+			for (int32 Index = 0; Index < 3; ++Index)
+			{
+				FThreadStats::AddMessage(StatNames[ActionIndex][Index], EStatOperation::Set, static_cast<double>(Percentiles[Index]));
+			}
+		}
+	}
+#endif
+}
+
+void FInputLatencyTracker::LogPercentiles() const
+{
+	for (int32 ActionIndex = 0; ActionIndex < static_cast<int32>(EInputLatencyAction::MAX); ++ActionIndex)
+	{
+		float P50;
+		float P95;
+		float P99;
+
+		if (GetPercentiles(static_cast<EInputLatencyAction>(ActionIndex), P50, P95, P99))
+		{
+			UE_LOG(LogTankGame, Display, TEXT("Input latency %-12s p50 %6.2f ms  p95 %6.2f ms  p99 %6.2f ms  (%d samples)"), kActionNames[ActionIndex],
+				P50, P95, P99, Actions[ActionIndex].LatencyMs.Num());
+		}
+		else
+		{
+			UE_LOG(LogTankGame, Display, TEXT("Input latency %-12s no samples"), kActionNames[ActionIndex]);
+		}
+	}
+}
+
+#if !UE_BUILD_SHIPPING
+namespace
+{
+	FAutoConsoleCommand InputLatencyDumpCommand(
+		TEXT("TankGame.InputLatency.Dump"),
+		TEXT("Logs input-to-effect latency percentiles for every tracked action."),
+		FConsoleCommandDelegate::CreateLambda([]() { FInputLatencyTracker::Get().LogPercentiles(); }));
+}
+#endif
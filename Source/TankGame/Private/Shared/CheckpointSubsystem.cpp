@@ -0,0 +1,576 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+
+#include "Shared/CheckpointSubsystem.h"
+
+#include "EngineUtils.h"
+#include "TankGame.h"
+#include "Character/MainCharacter.h"
+#include "Combat/HealthComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "Input/CharacterPlayerController.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Tank/Tank.h"
+
+DECLARE_CYCLE_STAT(TEXT("Checkpoint Capture"), STAT_CheckpointCapture, STATGROUP_TankGame);
+DECLARE_CYCLE_STAT(TEXT("Checkpoint Restore Batch"), STAT_CheckpointRestoreBatch, STATGROUP_TankGame);
+
+namespace
+{
+	TAutoConsoleVariable<int32> CVarCheckpointSpawnsPerFrame(
+		TEXT("tg.Checkpoint.SpawnsPerFrame"),
+		16,
+		TEXT("Maximum number of actors respawned per frame while restoring a checkpoint."));
+
+	TAutoConsoleVariable<int32> CVarCheckpointDestroysPerFrame(
+		TEXT("tg.Checkpoint.DestroysPerFrame"),
+		32,
+		TEXT("Maximum number of current actors destroyed per frame before a checkpoint's actors are respawned."));
+
+	bool IsPlayerPawn(const APawn* Pawn)
+	{
+		return Pawn->IsPlayerControlled();
+	}
+
+	/** True for a character parked inside a player's tank by ACharacterPlayerController. */
+	bool IsParkedInPlayerVehicle(const AMainCharacter* Character)
+	{
+		const APawn* Vehicle = Cast<APawn>(Character->GetAttachParentActor());
+		return Vehicle && Vehicle->IsPlayerControlled();
+	}
+
+	float GetHealth(const AActor* Actor)
+	{
+		const UHealthComponent* HealthComponent = Actor->FindComponentByClass<UHealthComponent>();
+		return HealthComponent ? HealthComponent->GetHealth() : 0.f;
+	}
+
+	void SetHealth(AActor* Actor, float Health)
+	{
+		if (UHealthComponent* HealthComponent = Actor->FindComponentByClass<UHealthComponent>())
+		{
+			HealthComponent->SetHealth(Health);
+		}
+	}
+}
+
+bool UCheckpointSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCheckpointSubsystem::Deinitialize()
+{
+	// A save in flight owns its snapshot and finishes writing on its own.
+	LoadTask = {};
+	RestoreSnapshot.Reset();
+	PendingDestroy.Reset();
+
+	Super::Deinitialize();
+}
+
+TStatId UCheckpointSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCheckpointSubsystem, STATGROUP_Tickables);
+}
+
+FString UCheckpointSubsystem::GetCheckpointPath(const FString& SlotName)
+{
+	return FPaths::ProjectSavedDir() / TEXT("Checkpoints") / SlotName + TEXT(".tgcp");
+}
+
+void UCheckpointSubsystem::CaptureWorld(FWorldSnapshot& OutSnapshot) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_CheckpointCapture);
+
+	OutSnapshot.Reset();
+
+	for (TActorIterator<ATank> It(GetWorld()); It; ++It)
+	{
+		ATank* Tank = *It;
+
+		if (Tank->IsActorBeingDestroyed())
+		{
+			continue;
+		}
+
+		FTankSnapshot& State = OutSnapshot.Tanks.AddDefaulted_GetRef();
+		State.Location = Tank->GetActorLocation();
+		State.Rotation = Tank->GetActorQuat();
+		State.TurretAngle = Tank->TurretAngle;
+		State.GunAngle = Tank->GunAngle;
+		State.Health = GetHealth(Tank);
+		State.ClassIndex = OutSnapshot.AddClass(Tank->GetClass());
+		State.bLightsOn = Tank->LightsOn;
+		State.bOccupied = Tank->GetController() != nullptr;
+		State.bPlayerControlled = IsPlayerPawn(Tank);
+
+		if (const UPrimitiveComponent* Root = Cast<UPrimitiveComponent>(Tank->GetRootComponent()))
+		{
+			State.LinearVelocity = Root->GetPhysicsLinearVelocity();
+			State.AngularVelocity = Root->GetPhysicsAngularVelocityInDegrees();
+		}
+	}
+
+	for (TActorIterator<AMainCharacter> It(GetWorld()); It; ++It)
+	{
+		AMainCharacter* Character = *It;
+
+		// Corpses are left behind rather than restored as living characters.
+		if (Character->IsActorBeingDestroyed() || (Character->HealthComponent && Character->HealthComponent->IsDead()))
+		{
+			continue;
+		}
+
+		FCharacterSnapshot& State = OutSnapshot.Characters.AddDefaulted_GetRef();
+		State.Location = Character->GetActorLocation();
+		State.Rotation = Character->GetActorRotation();
+		State.Velocity = Character->GetVelocity();
+		State.Health = GetHealth(Character);
+		State.ClassIndex = OutSnapshot.AddClass(Character->GetClass());
+		State.bAiming = Character->bIsAiming;
+		State.bCrouched = Character->bIsCrouched;
+		State.bInVehicle = IsParkedInPlayerVehicle(Character);
+		State.bOccupied = Character->GetController() != nullptr;
+		State.bPlayerControlled = IsPlayerPawn(Character) || State.bInVehicle;
+	}
+}
+
+bool UCheckpointSubsystem::SaveCheckpoint(const FString& SlotName)
+{
+	if (IsBusy())
+	{
+		return false;
+	}
+
+	TSharedPtr<FWorldSnapshot> Snapshot = MakeShared<FWorldSnapshot>();
+	CaptureWorld(*Snapshot);
+
+	SaveSlotName = SlotName;
+	SaveTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Snapshot, Path = GetCheckpointPath(SlotName)]()
+	{
+		TArray<uint8> Bytes;
+		return Snapshot->Encode(Bytes) && FFileHelper::SaveArrayToFile(Bytes, *Path);
+	});
+
+	return true;
+}
+
+bool UCheckpointSubsystem::LoadCheckpoint(const FString& SlotName)
+{
+	if (IsBusy())
+	{
+		return false;
+	}
+
+	LoadSlotName = SlotName;
+	LoadTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Path = GetCheckpointPath(SlotName)]() -> TSharedPtr<FWorldSnapshot>
+	{
+		TArray<uint8> Bytes;
+
+		if (!FFileHelper::LoadFileToArray(Bytes, *Path))
+		{
+			return nullptr;
+		}
+
+		TSharedPtr<FWorldSnapshot> Snapshot = MakeShared<FWorldSnapshot>();
+		return Snapshot->Decode(Bytes) ? Snapshot : nullptr;
+	});
+
+	return true;
+}
+
+void UCheckpointSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (SaveTask.IsValid() && SaveTask.IsCompleted())
+	{
+		const bool bSuccess = SaveTask.GetResult();
+		SaveTask = {};
+
+		UE_CLOG(!bSuccess, LogTankGame, Warning, TEXT("CheckpointSubsystem: failed to save checkpoint '%s'"), *SaveSlotName);
+		OnCheckpointSaved.Broadcast(SaveSlotName, bSuccess);
+	}
+
+	if (LoadTask.IsValid() && LoadTask.IsCompleted())
+	{
+		TSharedPtr<FWorldSnapshot> Snapshot = LoadTask.GetResult();
+		LoadTask = {};
+
+		if (Snapshot.IsValid())
+		{
+			BeginRestore(MoveTemp(Snapshot));
+		}
+		else
+		{
+			UE_LOG(LogTankGame, Warning, TEXT("CheckpointSubsystem: failed to load checkpoint '%s'"), *LoadSlotName);
+			OnCheckpointLoaded.Broadcast(LoadSlotName, false);
+		}
+	}
+
+	if (RestoreSnapshot.IsValid())
+	{
+		RestoreBatch(FMath::Max(CVarCheckpointSpawnsPerFrame.GetValueOnGameThread(), 1));
+	}
+}
+
+void UCheckpointSubsystem::BeginRestore(TSharedPtr<FWorldSnapshot> Snapshot)
+{
+	RestoreClasses.Reset(Snapshot->Classes.Num());
+
+	for (const FSoftClassPath& ClassPath : Snapshot->Classes)
+	{
+		// Classes of live actors are already loaded; anything else is loaded here, once per class.
+		RestoreClasses.Add(ClassPath.TryLoadClass<AActor>());
+	}
+
+	// A player driving now but on foot in the checkpoint gets out first, so the tank is restored like any other.
+	const bool bSavedInVehicle = Snapshot->Tanks.ContainsByPredicate([](const FTankSnapshot& State) { return State.bPlayerControlled; });
+
+	if (!bSavedInVehicle)
+	{
+		for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+		{
+			if (ACharacterPlayerController* PlayerController = Cast<ACharacterPlayerController>(It->Get()))
+			{
+				PlayerController->ExitVehicle();
+			}
+		}
+	}
+
+	// Player pawns, and characters parked in them, stay; they take the first saved player state of their class.
+	// Everything else is destroyed over the next frames, before any respawning starts.
+	PendingDestroy.Reset();
+
+	for (TActorIterator<ATank> It(GetWorld()); It; ++It)
+	{
+		if (!IsPlayerPawn(*It))
+		{
+			PendingDestroy.Add(*It);
+			continue;
+		}
+
+		for (FTankSnapshot& State : Snapshot->Tanks)
+		{
+			if (State.bPlayerControlled && RestoreClasses.IsValidIndex(State.ClassIndex) && RestoreClasses[State.ClassIndex] == It->GetClass())
+			{
+				ApplyTankState(*It, State);
+				State.ClassIndex = INDEX_NONE;
+				break;
+			}
+		}
+	}
+
+	for (TActorIterator<AMainCharacter> It(GetWorld()); It; ++It)
+	{
+		if (!IsPlayerPawn(*It) && !IsParkedInPlayerVehicle(*It))
+		{
+			PendingDestroy.Add(*It);
+			continue;
+		}
+
+		for (FCharacterSnapshot& State : Snapshot->Characters)
+		{
+			if (State.bPlayerControlled && RestoreClasses.IsValidIndex(State.ClassIndex) && RestoreClasses[State.ClassIndex] == It->GetClass())
+			{
+				ApplyCharacterState(*It, State);
+				State.ClassIndex = INDEX_NONE;
+				break;
+			}
+		}
+	}
+
+	RestoreSnapshot = MoveTemp(Snapshot);
+	NextTankRecord = 0;
+	NextCharacterRecord = 0;
+}
+
+void UCheckpointSubsystem::RestoreBatch(int32 MaxSpawns)
+{
+	SCOPE_CYCLE_COUNTER(STAT_CheckpointRestoreBatch);
+
+	UWorld* World = GetWorld();
+
+	if (PendingDestroy.Num() > 0)
+	{
+		const int32 NumToDestroy = FMath::Min(PendingDestroy.Num(), FMath::Max(CVarCheckpointDestroysPerFrame.GetValueOnGameThread(), 1));
+
+		for (int32 Index = PendingDestroy.Num() - NumToDestroy; Index < PendingDestroy.Num(); ++Index)
+		{
+			if (AActor* Actor = PendingDestroy[Index].Get())
+			{
+				Actor->Destroy();
+			}
+		}
+
+		PendingDestroy.RemoveAt(PendingDestroy.Num() - NumToDestroy, NumToDestroy, EAllowShrinking::No);
+		return;
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	int32 NumSpawned = 0;
+
+	while (NumSpawned < MaxSpawns && NextTankRecord < RestoreSnapshot->Tanks.Num())
+	{
+		const FTankSnapshot& State = RestoreSnapshot->Tanks[NextTankRecord++];
+		UClass* Class = RestoreClasses.IsValidIndex(State.ClassIndex) ? RestoreClasses[State.ClassIndex] : nullptr;
+
+		if (Class == nullptr || !Class->IsChildOf<ATank>())
+		{
+			continue;
+		}
+
+		if (ATank* Tank = World->SpawnActor<ATank>(Class, FTransform(State.Rotation, State.Location), SpawnParams))
+		{
+			ApplyTankState(Tank, State);
+
+			if (State.bPlayerControlled)
+			{
+				// The player was on foot when the load started but driving in the checkpoint: put them back inside.
+				EnterRestoredTank(Tank);
+			}
+			else if (State.bOccupied)
+			{
+				Tank->SpawnDefaultController();
+			}
+		}
+
+		++NumSpawned;
+	}
+
+	while (NumSpawned < MaxSpawns && NextCharacterRecord < RestoreSnapshot->Characters.Num())
+	{
+		const FCharacterSnapshot& State = RestoreSnapshot->Characters[NextCharacterRecord++];
+		UClass* Class = RestoreClasses.IsValidIndex(State.ClassIndex) ? RestoreClasses[State.ClassIndex] : nullptr;
+
+		if (Class == nullptr || !Class->IsChildOf<AMainCharacter>())
+		{
+			continue;
+		}
+
+		if (AMainCharacter* Character = World->SpawnActor<AMainCharacter>(Class, FTransform(State.Rotation, State.Location), SpawnParams))
+		{
+			if (State.bOccupied && !State.bPlayerControlled)
+			{
+				Character->SpawnDefaultController();
+			}
+
+			ApplyCharacterState(Character, State);
+		}
+
+		++NumSpawned;
+	}
+
+	if (NextTankRecord >= RestoreSnapshot->Tanks.Num() && NextCharacterRecord >= RestoreSnapshot->Characters.Num())
+	{
+		FinishRestore(true);
+	}
+}
+
+void UCheckpointSubsystem::EnterRestoredTank(ATank* Tank) const
+{
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		ACharacterPlayerController* PlayerController = Cast<ACharacterPlayerController>(It->Get());
+
+		if (PlayerController && Cast<AMainCharacter>(PlayerController->GetPawn()))
+		{
+			PlayerController->EnterTank(Tank);
+			return;
+		}
+	}
+}
+
+void UCheckpointSubsystem::FinishRestore(bool bSuccess)
+{
+	RestoreSnapshot.Reset();
+	RestoreClasses.Reset();
+	PendingDestroy.Reset();
+
+	OnCheckpointLoaded.Broadcast(LoadSlotName, bSuccess);
+}
+
+void UCheckpointSubsystem::ApplyTankState(ATank* Tank, const FTankSnapshot& State)
+{
+	Tank->SetActorLocationAndRotation(State.Location, State.Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+	Tank->TurretAngle = State.TurretAngle;
+	Tank->GunAngle = State.GunAngle;
+	Tank->LightsOn = State.bLightsOn;
+
+	if (UPrimitiveComponent* Root = Cast<UPrimitiveComponent>(Tank->GetRootComponent()))
+	{
+		Root->SetPhysicsLinearVelocity(State.LinearVelocity);
+		Root->SetPhysicsAngularVelocityInDegrees(State.AngularVelocity);
+	}
+
+	SetHealth(Tank, State.Health);
+}
+
+void UCheckpointSubsystem::ApplyCharacterState(AMainCharacter* Character, const FCharacterSnapshot& State)
+{
+	// A character parked in a tank rides along with it; only its health is its own.
+	if (IsParkedInPlayerVehicle(Character))
+	{
+		SetHealth(Character, State.Health);
+		return;
+	}
+
+	Character->SetActorLocationAndRotation(State.Location, State.Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+	Character->GetCharacterMovement()->Velocity = State.Velocity;
+
+	if (State.bCrouched && !Character->bIsCrouched)
+	{
+		Character->Crouch();
+	}
+	else if (!State.bCrouched && Character->bIsCrouched)
+	{
+		Character->UnCrouch();
+	}
+
+	if (State.bAiming != Character->bIsAiming)
+	{
+		Character->Aim(State.bAiming);
+	}
+
+	SetHealth(Character, State.Health);
+}
+
+#if !UE_BUILD_SHIPPING
+namespace
+{
+	void RunCheckpointBenchmark(const TArray<FString>& Args, UWorld* World)
+	{
+		const UCheckpointSubsystem* Checkpoints = World ? World->GetSubsystem<UCheckpointSubsystem>() : nullptr;
+
+		if (Checkpoints == nullptr)
+		{
+			UE_LOG(LogTankGame, Warning, TEXT("Checkpoint benchmark: needs a game world"));
+			return;
+		}
+
+		constexpr int32 kCaptureRuns = 100;
+
+		// Game-thread cost against the live world.
+		FWorldSnapshot LiveSnapshot;
+		double StartTime = FPlatformTime::Seconds();
+
+		for (int32 Run = 0; Run < kCaptureRuns; ++Run)
+		{
+			Checkpoints->CaptureWorld(LiveSnapshot);
+		}
+
+		const double CaptureMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / kCaptureRuns;
+		const int32 NumLiveActors = LiveSnapshot.Tanks.Num() + LiveSnapshot.Characters.Num();
+
+		UE_LOG(LogTankGame, Display, TEXT("Checkpoint benchmark: capturing %d tanks and %d characters takes %.3f ms on the game thread (%.2f us per actor)"),
+			LiveSnapshot.Tanks.Num(), LiveSnapshot.Characters.Num(), CaptureMs, NumLiveActors > 0 ? CaptureMs * 1000.0 / NumLiveActors : 0.0);
+
+		// Capture and encode cost against actor count. The world is topped up with copies of its own tanks and
+		// characters, in the live world's proportions, so CaptureWorld does the same actor and component work.
+		UClass* TankClass = nullptr;
+		UClass* CharacterClass = nullptr;
+
+		for (TActorIterator<ATank> It(World); It && TankClass == nullptr; ++It)
+		{
+			TankClass = It->GetClass();
+		}
+
+		for (TActorIterator<AMainCharacter> It(World); It && CharacterClass == nullptr; ++It)
+		{
+			CharacterClass = It->GetClass();
+		}
+
+		if (TankClass == nullptr && CharacterClass == nullptr)
+		{
+			UE_LOG(LogTankGame, Warning, TEXT("Checkpoint benchmark: needs at least one tank or character in the world to copy"));
+			return;
+		}
+
+		const float TankShare = TankClass == nullptr ? 0.f : (CharacterClass == nullptr ? 1.f
+			: (NumLiveActors > 0 ? static_cast<float>(LiveSnapshot.Tanks.Num()) / NumLiveActors : 0.25f));
+
+		constexpr int32 kSweepCaptureRuns = 10;
+		constexpr float kSpacing = 1500.f;
+
+		TArray<TWeakObjectPtr<AActor>> SpawnedActors;
+		int32 NumSpawned = 0;
+
+		for (const int32 NumActors : { 100, 250, 500, 1000, 2000 })
+		{
+			// Park the copies in a grid far below the playable area so they do not interact with the level.
+			for (; NumLiveActors + NumSpawned < NumActors; ++NumSpawned)
+			{
+				const bool bTank = NumSpawned < FMath::RoundToInt32((NumActors - NumLiveActors) * TankShare) || CharacterClass == nullptr;
+				const FVector Location((NumSpawned % 50) * kSpacing, (NumSpawned / 50) * kSpacing, -50000.f);
+
+				FActorSpawnParameters SpawnParams;
+				SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+				if (AActor* Actor = World->SpawnActor<AActor>(bTank ? TankClass : CharacterClass, FTransform(Location), SpawnParams))
+				{
+					SpawnedActors.Add(Actor);
+				}
+			}
+
+			FWorldSnapshot Snapshot;
+			StartTime = FPlatformTime::Seconds();
+
+			for (int32 Run = 0; Run < kSweepCaptureRuns; ++Run)
+			{
+				Checkpoints->CaptureWorld(Snapshot);
+			}
+
+			const double SweepCaptureMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / kSweepCaptureRuns;
+
+			TArray<uint8> Bytes;
+			StartTime = FPlatformTime::Seconds();
+			Snapshot.Encode(Bytes);
+			const double EncodeMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+			UE_LOG(LogTankGame, Display, TEXT("Checkpoint benchmark: %5d actors, capture %.3f ms (game thread), encode and compress %.3f ms (background), %d bytes"),
+				Snapshot.Tanks.Num() + Snapshot.Characters.Num(), SweepCaptureMs, EncodeMs, Bytes.Num());
+		}
+
+		for (const TWeakObjectPtr<AActor>& Actor : SpawnedActors)
+		{
+			if (Actor.IsValid())
+			{
+				Actor->Destroy();
+			}
+		}
+	}
+
+	FAutoConsoleCommandWithWorldAndArgs CheckpointBenchmarkCommand(
+		TEXT("TankGame.Checkpoint.Benchmark"),
+		TEXT("Times checkpoint capture against the live world, then capture and encode cost with the world topped up to 100 to 2000 tanks and characters, and logs the results."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunCheckpointBenchmark));
+
+	FAutoConsoleCommandWithWorldAndArgs CheckpointSaveCommand(
+		TEXT("TankGame.Checkpoint.Save"),
+		TEXT("Saves a checkpoint to the given slot (default 'Quick')."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UCheckpointSubsystem* Checkpoints = World ? World->GetSubsystem<UCheckpointSubsystem>() : nullptr)
+			{
+				Checkpoints->SaveCheckpoint(Args.Num() > 0 ? Args[0] : TEXT("Quick"));
+			}
+		}));
+
+	FAutoConsoleCommandWithWorldAndArgs CheckpointLoadCommand(
+		TEXT("TankGame.Checkpoint.Load"),
+		TEXT("Loads the checkpoint in the given slot (default 'Quick')."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UCheckpointSubsystem* Checkpoints = World ? World->GetSubsystem<UCheckpointSubsystem>() : nullptr)
+			{
+				Checkpoints->LoadCheckpoint(Args.Num() > 0 ? Args[0] : TEXT("Quick"));
+			}
+		}));
+}
+#endif
@@ -0,0 +1,253 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+
+#include "Shared/GameplayDebugLog.h"
+
+#if TG_DEBUG_EVENTS
+
+#include "TankGame.h"
+#include "Containers/Ticker.h"
+#include "Engine/Engine.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeLock.h"
+#include "ProfilingDebugging/MiscTrace.h"
+
+std::atomic<uint32> FGameplayDebugLog::RecordingMask{ 0 };
+
+namespace
+{
+	struct FDebugEventRecord
+	{
+		double Time = 0.0;
+		FName SubjectName;
+		float Value = 0.f;
+		EDebugEvent Event = EDebugEvent::MAX;
+	};
+
+	/** Written only by its owning thread and read only by the game thread in Flush. */
+	struct FDebugEventRing
+	{
+		static constexpr uint32 Capacity = 256;
+
+		FDebugEventRecord Records[Capacity];
+		std::atomic<uint32> Head{ 0 };
+		std::atomic<uint32> Tail{ 0 };
+		std::atomic<uint32> Dropped{ 0 };
+	};
+
+	const TCHAR* const kCategoryNames[] = { TEXT("Melee"), TEXT("Hitscan"), TEXT("Animation") };
+	static_assert(UE_ARRAY_COUNT(kCategoryNames) == static_cast<int32>(EDebugEventCategory::MAX), "Name every debug event category");
+
+	FCriticalSection RingsLock;
+	TArray<FDebugEventRing*> Rings;
+	thread_local FDebugEventRing* LocalRing = nullptr;
+
+	FTSTicker::FDelegateHandle FlushTickerHandle;
+
+	void OnViewerSettingsChanged(IConsoleVariable* Variable)
+	{
+		FGameplayDebugLog::RefreshRecordingMask();
+	}
+
+	TAutoConsoleVariable<bool> CVarDebugEventsScreen(
+		TEXT("tg.DebugEvents.Screen"),
+		false,
+		TEXT("Shows recorded gameplay debug events as on-screen messages."),
+		FConsoleVariableDelegate::CreateStatic(&OnViewerSettingsChanged));
+
+	TAutoConsoleVariable<bool> CVarDebugEventsLog(
+		TEXT("tg.DebugEvents.Log"),
+		false,
+		TEXT("Writes recorded gameplay debug events to the log."),
+		FConsoleVariableDelegate::CreateStatic(&OnViewerSettingsChanged));
+
+	TAutoConsoleVariable<bool> CVarDebugEventsInsights(
+		TEXT("tg.DebugEvents.Insights"),
+		false,
+		TEXT("Emits recorded gameplay debug events as Insights bookmarks."),
+		FConsoleVariableDelegate::CreateStatic(&OnViewerSettingsChanged));
+
+	TAutoConsoleVariable<FString> CVarDebugEventsCategories(
+		TEXT("tg.DebugEvents.Categories"),
+		TEXT("All"),
+		TEXT("Comma-separated debug event categories to record: All, Melee, Hitscan, Animation."),
+		FConsoleVariableDelegate::CreateStatic(&OnViewerSettingsChanged));
+
+	FDebugEventRing& GetLocalRing()
+	{
+		if (LocalRing == nullptr)
+		{
+			// Rings live for the process; threads that record events are long lived.
+			LocalRing = new FDebugEventRing();
+
+			FScopeLock Lock(&RingsLock);
+			Rings.Add(LocalRing);
+		}
+
+		return *LocalRing;
+	}
+
+	FString FormatEvent(const FDebugEventRecord& Record)
+	{
+		switch (Record.Event)
+		{
+		case EDebugEvent::AttackNotifyBegin:
+			return FString::Printf(TEXT("DealDamageAnimNotifyState: NotifyBegin on %s"), *Record.SubjectName.ToString());
+		case EDebugEvent::AttackNotifyEnd:
+			return FString::Printf(TEXT("DealDamageAnimNotifyState: NotifyEnd on %s"), *Record.SubjectName.ToString());
+		case EDebugEvent::MeleeHitCharacter:
+			return FString::Printf(TEXT("Melee hit character %s"), *Record.SubjectName.ToString());
+		case EDebugEvent::HitscanHit:
+			return FString::Printf(TEXT("Hitscan hit %s at %.0f cm"), *Record.SubjectName.ToString(), Record.Value);
+		case EDebugEvent::HitscanMiss:
+			return FString::Printf(TEXT("Hitscan from %s hit nothing"), *Record.SubjectName.ToString());
+		case EDebugEvent::AttackMontageBusy:
+			return FString::Printf(TEXT("%s: AttackMontage already playing"), *Record.SubjectName.ToString());
+		case EDebugEvent::AttackMontageMissing:
+			return FString::Printf(TEXT("%s: Cannot play AttackMontage"), *Record.SubjectName.ToString());
+		default:
+			return FString();
+		}
+	}
+
+	FColor GetEventColor(EDebugEvent Event)
+	{
+		switch (Event)
+		{
+		case EDebugEvent::HitscanHit:
+			return FColor::Green;
+		case EDebugEvent::HitscanMiss:
+		case EDebugEvent::AttackMontageBusy:
+		case EDebugEvent::AttackMontageMissing:
+			return FColor::Red;
+		case EDebugEvent::MeleeHitCharacter:
+			return FColor::Blue;
+		default:
+			return FColor::Yellow;
+		}
+	}
+
+	uint32 ParseCategoryMask(const FString& Categories)
+	{
+		TArray<FString> Names;
+		Categories.ParseIntoArray(Names, TEXT(","));
+
+		uint32 Mask = 0;
+
+		for (FString& Name : Names)
+		{
+			Name.TrimStartAndEndInline();
+
+			if (Name.Equals(TEXT("All"), ESearchCase::IgnoreCase))
+			{
+				return (1u << static_cast<uint32>(EDebugEventCategory::MAX)) - 1;
+			}
+
+			for (int32 CategoryIndex = 0; CategoryIndex < UE_ARRAY_COUNT(kCategoryNames); ++CategoryIndex)
+			{
+				if (Name.Equals(kCategoryNames[CategoryIndex], ESearchCase::IgnoreCase))
+				{
+					Mask |= 1u << CategoryIndex;
+				}
+			}
+		}
+
+		return Mask;
+	}
+}
+
+void FGameplayDebugLog::Record(EDebugEvent Event, const UObject* Subject, float Value)
+{
+	FDebugEventRing& Ring = GetLocalRing();
+
+	const uint32 Head = Ring.Head.load(std::memory_order_relaxed);
+
+	if (Head - Ring.Tail.load(std::memory_order_acquire) >= FDebugEventRing::Capacity)
+	{
+		Ring.Dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	FDebugEventRecord& Record = Ring.Records[Head % FDebugEventRing::Capacity];
+	Record.Time = FPlatformTime::Seconds();
+	Record.SubjectName = Subject ? Subject->GetFName() : NAME_None;
+	Record.Value = Value;
+	Record.Event = Event;
+
+	Ring.Head.store(Head + 1, std::memory_order_release);
+}
+
+void FGameplayDebugLog::Flush()
+{
+	check(IsInGameThread());
+
+	TArray<FDebugEventRing*, TInlineAllocator<16>> RingsToDrain;
+	{
+		FScopeLock Lock(&RingsLock);
+		RingsToDrain = Rings;
+	}
+
+	const bool bToScreen = CVarDebugEventsScreen.GetValueOnGameThread() && GEngine != nullptr;
+	const bool bToLog = CVarDebugEventsLog.GetValueOnGameThread();
+	const bool bToInsights = CVarDebugEventsInsights.GetValueOnGameThread();
+
+	for (FDebugEventRing* Ring : RingsToDrain)
+	{
+		const uint32 Head = Ring->Head.load(std::memory_order_acquire);
+
+		for (uint32 Tail = Ring->Tail.load(std::memory_order_relaxed); Tail != Head; ++Tail)
+		{
+			const FDebugEventRecord& Record = Ring->Records[Tail % FDebugEventRing::Capacity];
+			const FString Message = FormatEvent(Record);
+
+			if (bToScreen)
+			{
+				GEngine->AddOnScreenDebugMessage(-1, 5.f, GetEventColor(Record.Event), Message);
+			}
+
+			if (bToLog)
+			{
+				UE_LOG(LogTankGame, Log, TEXT("[%.3f] %s"), Record.Time, *Message);
+			}
+
+			if (bToInsights)
+			{
+				TRACE_BOOKMARK(TEXT("%s"), *Message);
+			}
+		}
+
+		Ring->Tail.store(Head, std::memory_order_release);
+
+		if (const uint32 Dropped = Ring->Dropped.exchange(0, std::memory_order_relaxed))
+		{
+			UE_LOG(LogTankGame, Warning, TEXT("GameplayDebugLog: dropped %u events from a full ring"), Dropped);
+		}
+	}
+}
+
+void FGameplayDebugLog::RefreshRecordingMask()
+{
+	const bool bAnyViewer = CVarDebugEventsScreen.GetValueOnGameThread() || CVarDebugEventsLog.GetValueOnGameThread()
+		|| CVarDebugEventsInsights.GetValueOnGameThread();
+
+	RecordingMask.store(bAnyViewer ? ParseCategoryMask(CVarDebugEventsCategories.GetValueOnGameThread()) : 0, std::memory_order_relaxed);
+
+	if (bAnyViewer && !FlushTickerHandle.IsValid())
+	{
+		FlushTickerHandle = FTSTicker::GetCoreTicker().AddTicker(TEXT("GameplayDebugLog"), 0.f, [](float DeltaTime)
+		{
+			Flush();
+			return true;
+		});
+	}
+	else if (!bAnyViewer && FlushTickerHandle.IsValid())
+	{
+		// Drain what was recorded before the last viewer detached, so it does not show up when one attaches again.
+		Flush();
+
+		FTSTicker::GetCoreTicker().RemoveTicker(FlushTickerHandle);
+		FlushTickerHandle.Reset();
+	}
+}
+
+#endif
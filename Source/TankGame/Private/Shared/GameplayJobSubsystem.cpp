@@ -0,0 +1,134 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+
+#include "Shared/GameplayJobSubsystem.h"
+
+#include "TankGame.h"
+#include "Async/ParallelFor.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+DECLARE_CYCLE_STAT(TEXT("Gameplay Jobs Gather"), STAT_GameplayJobsGather, STATGROUP_TankGame);
+DECLARE_CYCLE_STAT(TEXT("Gameplay Jobs Compute"), STAT_GameplayJobsCompute, STATGROUP_TankGame);
+DECLARE_CYCLE_STAT(TEXT("Gameplay Jobs Apply"), STAT_GameplayJobsApply, STATGROUP_TankGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Gameplay Job Batches"), STAT_GameplayJobBatches, STATGROUP_TankGame);
+
+namespace
+{
+	TAutoConsoleVariable<bool> CVarGameplayJobsParallel(
+		TEXT("tg.GameplayJobs.Parallel"),
+		true,
+		TEXT("Run the compute phase of gameplay jobs on worker threads. When off, it runs on the game thread for comparison."));
+
+	TAutoConsoleVariable<int32> CVarGameplayJobsBatchSize(
+		TEXT("tg.GameplayJobs.BatchSize"),
+		32,
+		TEXT("Compute items of one job handed to a worker at a time, for jobs that do not size their own batches."));
+}
+
+bool UGameplayJobSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UGameplayJobSubsystem::Deinitialize()
+{
+	Jobs.Empty();
+	Batches.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId UGameplayJobSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGameplayJobSubsystem, STATGROUP_Tickables);
+}
+
+void UGameplayJobSubsystem::RegisterJob(IGameplayJob* Job, FName JobName)
+{
+	check(!bRunningJobs);
+
+	if (Job == nullptr || Jobs.ContainsByPredicate([Job](const FRegisteredJob& Registered) { return Registered.Job == Job; }))
+	{
+		return;
+	}
+
+	FRegisteredJob& Registered = Jobs.AddDefaulted_GetRef();
+	Registered.Job = Job;
+	Registered.GatherScopeName = FString::Printf(TEXT("GameplayJobs.Gather.%s"), *JobName.ToString());
+	Registered.ComputeScopeName = FString::Printf(TEXT("GameplayJobs.Compute.%s"), *JobName.ToString());
+	Registered.ApplyScopeName = FString::Printf(TEXT("GameplayJobs.Apply.%s"), *JobName.ToString());
+}
+
+void UGameplayJobSubsystem::UnregisterJob(IGameplayJob* Job)
+{
+	check(!bRunningJobs);
+
+	Jobs.RemoveAll([Job](const FRegisteredJob& Registered) { return Registered.Job == Job; });
+}
+
+void UGameplayJobSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	TGuardValue<bool> RunningGuard(bRunningJobs, true);
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_GameplayJobsGather);
+
+		for (FRegisteredJob& Registered : Jobs)
+		{
+			TRACE_CPUPROFILER_EVENT_SCOPE_TEXT(*Registered.GatherScopeName);
+
+			Registered.NumItems = Registered.Job->GatherJob(DeltaTime);
+		}
+	}
+
+	// Batches never span two jobs, so each batch reports under its own job's scope.
+	const int32 DefaultBatchSize = FMath::Max(CVarGameplayJobsBatchSize.GetValueOnGameThread(), 1);
+	Batches.Reset();
+
+	for (int32 JobIndex = 0; JobIndex < Jobs.Num(); ++JobIndex)
+	{
+		const int32 ItemsPerBatch = Jobs[JobIndex].Job->GetItemsPerBatch();
+		const int32 BatchSize = ItemsPerBatch > 0 ? ItemsPerBatch : DefaultBatchSize;
+
+		for (int32 FirstItem = 0; FirstItem < Jobs[JobIndex].NumItems; FirstItem += BatchSize)
+		{
+			Batches.Add({ JobIndex, FirstItem, FMath::Min(FirstItem + BatchSize, Jobs[JobIndex].NumItems) });
+		}
+	}
+
+	if (!Batches.IsEmpty())
+	{
+		SCOPE_CYCLE_COUNTER(STAT_GameplayJobsCompute);
+
+		ParallelFor(TEXT("GameplayJobs.Compute"), Batches.Num(), 1, [this](int32 BatchIndex)
+		{
+			const FComputeBatch& Batch = Batches[BatchIndex];
+			const FRegisteredJob& Registered = Jobs[Batch.JobIndex];
+
+			TRACE_CPUPROFILER_EVENT_SCOPE_TEXT(*Registered.ComputeScopeName);
+
+			for (int32 Item = Batch.FirstItem; Item < Batch.LastItem; ++Item)
+			{
+				Registered.Job->ComputeJob(Item);
+			}
+		}, CVarGameplayJobsParallel.GetValueOnGameThread() ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
+	}
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_GameplayJobsApply);
+
+		for (FRegisteredJob& Registered : Jobs)
+		{
+			if (Registered.NumItems > 0)
+			{
+				TRACE_CPUPROFILER_EVENT_SCOPE_TEXT(*Registered.ApplyScopeName);
+
+				Registered.Job->ApplyJob();
+			}
+		}
+	}
+
+	SET_DWORD_STAT(STAT_GameplayJobBatches, Batches.Num());
+}
@@ -0,0 +1,336 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+
+#include "Shared/PawnSpatialHashSubsystem.h"
+
+#include "TankGame.h"
+#include "Engine/OverlapResult.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Shared/TankGameSettings.h"
+
+DECLARE_CYCLE_STAT(TEXT("Spatial Hash Update"), STAT_SpatialHashUpdate, STATGROUP_TankGame);
+DECLARE_CYCLE_STAT(TEXT("Spatial Hash Query"), STAT_SpatialHashQuery, STATGROUP_TankGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Spatial Hash Queries"), STAT_SpatialHashQueries, STATGROUP_TankGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Spatial Hash Cell Changes"), STAT_SpatialHashCellChanges, STATGROUP_TankGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Spatial Hash Entries"), STAT_SpatialHashEntries, STATGROUP_TankGame);
+
+bool UPawnSpatialHashSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UPawnSpatialHashSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	CellSize = FMath::Max(GetDefault<UTankGameSettings>()->SpatialHashCellSize, 100.f);
+	InvCellSize = 1.f / CellSize;
+}
+
+void UPawnSpatialHashSubsystem::Deinitialize()
+{
+	DEC_DWORD_STAT_BY(STAT_SpatialHashEntries, GetNumEntries());
+
+	Entries.Empty();
+	FreeEntries.Empty();
+	EntryLookup.Empty();
+	Cells.Empty();
+
+	Super::Deinitialize();
+}
+
+void UPawnSpatialHashSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SpatialHashUpdate);
+
+	Super::Tick(DeltaTime);
+
+	for (int32 EntryIndex = 0; EntryIndex < Entries.Num(); ++EntryIndex)
+	{
+		FEntry& Entry = Entries[EntryIndex];
+
+		if (Entry.IndexInCell == INDEX_NONE)
+		{
+			continue;
+		}
+
+		const AActor* Actor = Entry.Actor.Get();
+
+		if (Actor == nullptr)
+		{
+			RemoveEntry(EntryIndex);
+			continue;
+		}
+
+		Entry.Location = Actor->GetActorLocation();
+
+		const FIntPoint NewCell = GetCell(Entry.Location);
+
+		if (NewCell != Entry.Cell)
+		{
+			RemoveFromCell(EntryIndex);
+			Entry.Cell = NewCell;
+			AddToCell(EntryIndex);
+
+			INC_DWORD_STAT(STAT_SpatialHashCellChanges);
+		}
+	}
+}
+
+TStatId UPawnSpatialHashSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPawnSpatialHashSubsystem, STATGROUP_Tickables);
+}
+
+void UPawnSpatialHashSubsystem::Register(AActor* Actor)
+{
+	if (Actor == nullptr || EntryLookup.Contains(FObjectKey(Actor)))
+	{
+		return;
+	}
+
+	const int32 EntryIndex = FreeEntries.Num() > 0 ? FreeEntries.Pop(EAllowShrinking::No) : Entries.AddDefaulted();
+
+	FEntry& Entry = Entries[EntryIndex];
+	Entry.Actor = Actor;
+	Entry.Key = FObjectKey(Actor);
+	Entry.Location = Actor->GetActorLocation();
+	Entry.Cell = GetCell(Entry.Location);
+
+	AddToCell(EntryIndex);
+	EntryLookup.Add(Entry.Key, EntryIndex);
+
+	INC_DWORD_STAT(STAT_SpatialHashEntries);
+}
+
+void UPawnSpatialHashSubsystem::Unregister(AActor* Actor)
+{
+	if (const int32* EntryIndex = EntryLookup.Find(FObjectKey(Actor)))
+	{
+		RemoveEntry(*EntryIndex);
+	}
+}
+
+void UPawnSpatialHashSubsystem::RemoveEntry(int32 EntryIndex)
+{
+	FEntry& Entry = Entries[EntryIndex];
+
+	RemoveFromCell(EntryIndex);
+	EntryLookup.Remove(Entry.Key);
+
+	Entry = FEntry();
+	FreeEntries.Add(EntryIndex);
+
+	DEC_DWORD_STAT(STAT_SpatialHashEntries);
+}
+
+FIntPoint UPawnSpatialHashSubsystem::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt32(Location.X * InvCellSize), FMath::FloorToInt32(Location.Y * InvCellSize));
+}
+
+void UPawnSpatialHashSubsystem::AddToCell(int32 EntryIndex)
+{
+	FEntry& Entry = Entries[EntryIndex];
+	TArray<int32>& Cell = Cells.FindOrAdd(Entry.Cell);
+
+	Entry.IndexInCell = Cell.Add(EntryIndex);
+}
+
+void UPawnSpatialHashSubsystem::RemoveFromCell(int32 EntryIndex)
+{
+	FEntry& Entry = Entries[EntryIndex];
+	TArray<int32>* Cell = Cells.Find(Entry.Cell);
+
+	if (Cell == nullptr || Entry.IndexInCell == INDEX_NONE)
+	{
+		return;
+	}
+
+	// Swap-remove and patch the index of whichever entry moved into the hole.
+	Cell->RemoveAtSwap(Entry.IndexInCell, EAllowShrinking::No);
+
+	if (Cell->IsValidIndex(Entry.IndexInCell))
+	{
+		Entries[(*Cell)[Entry.IndexInCell]].IndexInCell = Entry.IndexInCell;
+	}
+
+	Entry.IndexInCell = INDEX_NONE;
+}
+
+template <typename VisitorType>
+void UPawnSpatialHashSubsystem::ForEachEntryInBounds(const FVector& Center, float HalfSize, VisitorType&& Visitor) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_SpatialHashQuery);
+	INC_DWORD_STAT(STAT_SpatialHashQueries);
+
+	const FIntPoint MinCell = GetCell(Center - FVector(HalfSize));
+	const FIntPoint MaxCell = GetCell(Center + FVector(HalfSize));
+
+	for (int32 CellX = MinCell.X; CellX <= MaxCell.X; ++CellX)
+	{
+		for (int32 CellY = MinCell.Y; CellY <= MaxCell.Y; ++CellY)
+		{
+			const TArray<int32>* Cell = Cells.Find(FIntPoint(CellX, CellY));
+
+			if (Cell == nullptr)
+			{
+				continue;
+			}
+
+			for (const int32 EntryIndex : *Cell)
+			{
+				const FEntry& Entry = Entries[EntryIndex];
+
+				if (AActor* Actor = Entry.Actor.Get())
+				{
+					Visitor(Entry, Actor);
+				}
+			}
+		}
+	}
+}
+
+void UPawnSpatialHashSubsystem::QueryRadius(const FVector& Center, float Radius, TArray<AActor*>& OutActors, const AActor* IgnoreActor) const
+{
+	const double RadiusSquared = FMath::Square(Radius);
+
+	ForEachEntryInBounds(Center, Radius, [&](const FEntry& Entry, AActor* Actor)
+	{
+		if (Actor != IgnoreActor && FVector::DistSquared(Entry.Location, Center) <= RadiusSquared)
+		{
+			OutActors.Add(Actor);
+		}
+	});
+}
+
+void UPawnSpatialHashSubsystem::QueryCone(const FVector& Origin, const FVector& Direction, float HalfAngle, float Range,
+	TArray<AActor*>& OutActors, const AActor* IgnoreActor) const
+{
+	const double RangeSquared = FMath::Square(Range);
+	const double CosHalfAngle = FMath::Cos(FMath::DegreesToRadians(HalfAngle));
+
+	ForEachEntryInBounds(Origin, Range, [&](const FEntry& Entry, AActor* Actor)
+	{
+		const FVector ToEntry = Entry.Location - Origin;
+		const double DistanceSquared = ToEntry.SizeSquared();
+
+		if (Actor == IgnoreActor || DistanceSquared > RangeSquared)
+		{
+			return;
+		}
+
+		if ((ToEntry | Direction) >= CosHalfAngle * FMath::Sqrt(DistanceSquared))
+		{
+			OutActors.Add(Actor);
+		}
+	});
+}
+
+AActor* UPawnSpatialHashSubsystem::FindNearest(const FVector& Center, float Radius, TSubclassOf<AActor> ActorClass,
+	const AActor* IgnoreActor) const
+{
+	AActor* Nearest = nullptr;
+	double NearestDistanceSquared = FMath::Square(Radius);
+
+	ForEachEntryInBounds(Center, Radius, [&](const FEntry& Entry, AActor* Actor)
+	{
+		if (Actor == IgnoreActor || (ActorClass && !Actor->IsA(ActorClass)))
+		{
+			return;
+		}
+
+		const double DistanceSquared = FVector::DistSquared(Entry.Location, Center);
+
+		if (DistanceSquared <= NearestDistanceSquared)
+		{
+			NearestDistanceSquared = DistanceSquared;
+			Nearest = Actor;
+		}
+	});
+
+	return Nearest;
+}
+
+void UPawnSpatialHashSubsystem::GetRegisteredActors(TArray<AActor*>& OutActors) const
+{
+	for (const FEntry& Entry : Entries)
+	{
+		if (AActor* Actor = Entry.Actor.Get())
+		{
+			OutActors.Add(Actor);
+		}
+	}
+}
+
+#if !UE_BUILD_SHIPPING
+namespace
+{
+	void RunSpatialHashBenchmark(const TArray<FString>& Args, UWorld* World)
+	{
+		const UPawnSpatialHashSubsystem* SpatialHash = World ? World->GetSubsystem<UPawnSpatialHashSubsystem>() : nullptr;
+
+		if (SpatialHash == nullptr || SpatialHash->GetNumEntries() == 0)
+		{
+			UE_LOG(LogTankGame, Warning, TEXT("Spatial hash benchmark: no damageable actors registered in this world"));
+			return;
+		}
+
+		const int32 NumQueries = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 10000;
+		const float Radius = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 1500.f;
+
+		TArray<AActor*> Actors;
+		SpatialHash->GetRegisteredActors(Actors);
+
+		// Query around registered actors, like splash damage landing among them would.
+		FRandomStream Random(0x5A1A);
+		TArray<FVector> Centers;
+		Centers.Reserve(NumQueries);
+
+		for (int32 QueryIndex = 0; QueryIndex < NumQueries; ++QueryIndex)
+		{
+			Centers.Add(Actors[Random.RandHelper(Actors.Num())]->GetActorLocation() + Random.GetUnitVector() * Random.FRandRange(0.f, Radius));
+		}
+
+		TArray<AActor*> Results;
+		int64 HashResults = 0;
+		double StartTime = FPlatformTime::Seconds();
+
+		for (const FVector& Center : Centers)
+		{
+			Results.Reset();
+			SpatialHash->QueryRadius(Center, Radius, Results);
+			HashResults += Results.Num();
+		}
+
+		const double HashTime = FPlatformTime::Seconds() - StartTime;
+
+		TArray<FOverlapResult> Overlaps;
+		const FCollisionObjectQueryParams ObjectParams(FCollisionObjectQueryParams::AllDynamicObjects);
+		const FCollisionShape Sphere = FCollisionShape::MakeSphere(Radius);
+		int64 OverlapResults = 0;
+		StartTime = FPlatformTime::Seconds();
+
+		for (const FVector& Center : Centers)
+		{
+			Overlaps.Reset();
+			World->OverlapMultiByObjectType(Overlaps, Center, FQuat::Identity, ObjectParams, Sphere);
+			OverlapResults += Overlaps.Num();
+		}
+
+		const double OverlapTime = FPlatformTime::Seconds() - StartTime;
+
+		UE_LOG(LogTankGame, Display, TEXT("Spatial hash benchmark: %d actors, %d queries, radius %.0f"), Actors.Num(), NumQueries, Radius);
+		UE_LOG(LogTankGame, Display, TEXT("  Spatial hash:   %.3f ms, %.1f queries/ms, %lld results"),
+			HashTime * 1000.0, NumQueries / FMath::Max(HashTime * 1000.0, UE_SMALL_NUMBER), HashResults);
+		UE_LOG(LogTankGame, Display, TEXT("  Physics sphere: %.3f ms, %.1f queries/ms, %lld results"),
+			OverlapTime * 1000.0, NumQueries / FMath::Max(OverlapTime * 1000.0, UE_SMALL_NUMBER), OverlapResults);
+	}
+
+	FAutoConsoleCommandWithWorldAndArgs SpatialHashBenchmarkCommand(
+		TEXT("TankGame.SpatialHash.Benchmark"),
+		TEXT("Runs N radius queries (default 10000, radius 1500) through the pawn spatial hash and through physics sphere overlaps, and logs queries per millisecond for both."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunSpatialHashBenchmark));
+}
+#endif
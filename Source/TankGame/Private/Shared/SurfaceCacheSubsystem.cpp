@@ -0,0 +1,472 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+
+#include "Shared/SurfaceCacheSubsystem.h"
+
+#include "EngineUtils.h"
+#include "LandscapeHeightfieldCollisionComponent.h"
+#include "LandscapeProxy.h"
+#include "TankGame.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "PhysicalMaterials/PhysicalMaterial.h"
+#include "Shared/TankGameSettings.h"
+
+DECLARE_CYCLE_STAT(TEXT("Surface Cache Build"), STAT_SurfaceCacheBuild, STATGROUP_TankGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Surface Cache Chunks"), STAT_SurfaceCacheChunks, STATGROUP_TankGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Surface Cache Samples In Flight"), STAT_SurfaceCacheSamplesInFlight, STATGROUP_TankGame);
+DECLARE_MEMORY_STAT(TEXT("Surface Cache Memory"), STAT_SurfaceCacheMemory, STATGROUP_TankGame);
+
+namespace
+{
+	TAutoConsoleVariable<int32> CVarSurfaceCacheTracesPerFrame(
+		TEXT("tg.SurfaceCache.TracesPerFrame"),
+		256,
+		TEXT("Maximum number of async traces issued per frame while building surface cache chunks."));
+
+	constexpr double kTraceMargin = 1000.0;
+}
+
+bool USurfaceCacheSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void USurfaceCacheSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	CellSize = GetDefault<UTankGameSettings>()->SurfaceCacheCellSize;
+
+	Materials.Add(nullptr);
+
+	TraceDelegate.BindUObject(this, &USurfaceCacheSubsystem::OnTraceCompleted);
+	LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &USurfaceCacheSubsystem::OnLevelAdded);
+	LevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &USurfaceCacheSubsystem::OnLevelRemoved);
+}
+
+void USurfaceCacheSubsystem::Deinitialize()
+{
+	FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+	FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedHandle);
+	TraceDelegate.Unbind();
+
+	DEC_MEMORY_STAT_BY(STAT_SurfaceCacheMemory, TrackedChunkMemory);
+	TrackedChunkMemory = 0;
+
+	Chunks.Empty();
+	BuildQueue.Empty();
+	PendingSamples.Empty();
+	Materials.Empty();
+	MaterialLookup.Empty();
+
+	Super::Deinitialize();
+}
+
+void USurfaceCacheSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	for (TActorIterator<ALandscapeProxy> It(&InWorld); It; ++It)
+	{
+		EnqueueProxy(*It);
+	}
+}
+
+TStatId USurfaceCacheSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USurfaceCacheSubsystem, STATGROUP_Tickables);
+}
+
+SIZE_T USurfaceCacheSubsystem::GetAllocatedSize() const
+{
+	SIZE_T Size = Chunks.GetAllocatedSize() + BuildQueue.GetAllocatedSize() + PendingSamples.GetAllocatedSize();
+
+	for (const TPair<FIntPoint, FSurfaceChunk>& Pair : Chunks)
+	{
+		Size += Pair.Value.GetAllocatedSize();
+	}
+
+	return Size;
+}
+
+FIntPoint USurfaceCacheSubsystem::GetChunkCoord(const FVector& Location) const
+{
+	const double ChunkSize = CellSize * ChunkCells;
+	return FIntPoint(FMath::FloorToInt32(Location.X / ChunkSize), FMath::FloorToInt32(Location.Y / ChunkSize));
+}
+
+FBox2D USurfaceCacheSubsystem::GetChunkBounds(const FIntPoint& ChunkCoord) const
+{
+	const double ChunkSize = CellSize * ChunkCells;
+	const FVector2D Min(ChunkCoord.X * ChunkSize, ChunkCoord.Y * ChunkSize);
+	return FBox2D(Min, Min + FVector2D(ChunkSize));
+}
+
+void USurfaceCacheSubsystem::OnLevelAdded(ULevel* Level, UWorld* World)
+{
+	if (World != GetWorld() || Level == nullptr)
+	{
+		return;
+	}
+
+	for (const AActor* Actor : Level->Actors)
+	{
+		if (const ALandscapeProxy* Proxy = Cast<ALandscapeProxy>(Actor))
+		{
+			EnqueueProxy(Proxy);
+		}
+	}
+}
+
+void USurfaceCacheSubsystem::OnLevelRemoved(ULevel* Level, UWorld* World)
+{
+	if (World != GetWorld() || Level == nullptr)
+	{
+		return;
+	}
+
+	TSet<FIntPoint> RemovedChunks;
+
+	for (const AActor* Actor : Level->Actors)
+	{
+		const ALandscapeProxy* Proxy = Cast<ALandscapeProxy>(Actor);
+
+		if (Proxy == nullptr)
+		{
+			continue;
+		}
+
+		const FBox Bounds = Proxy->GetComponentsBoundingBox();
+
+		if (!Bounds.IsValid)
+		{
+			continue;
+		}
+
+		const FIntPoint MinChunk = GetChunkCoord(Bounds.Min);
+		const FIntPoint MaxChunk = GetChunkCoord(Bounds.Max);
+
+		for (int32 Y = MinChunk.Y; Y <= MaxChunk.Y; ++Y)
+		{
+			for (int32 X = MinChunk.X; X <= MaxChunk.X; ++X)
+			{
+				const FIntPoint ChunkCoord(X, Y);
+
+				if (Chunks.Contains(ChunkCoord))
+				{
+					RemoveChunk(ChunkCoord);
+					RemovedChunks.Add(ChunkCoord);
+				}
+			}
+		}
+	}
+
+	if (RemovedChunks.IsEmpty())
+	{
+		return;
+	}
+
+	// Removed chunks on the border with landscape that is still loaded are rebuilt from it. Every other chunk is left alone.
+	for (TActorIterator<ALandscapeProxy> It(GetWorld()); It; ++It)
+	{
+		if (It->GetLevel() != Level)
+		{
+			EnqueueProxy(*It, &RemovedChunks);
+		}
+	}
+}
+
+void USurfaceCacheSubsystem::EnqueueProxy(const ALandscapeProxy* Proxy, const TSet<FIntPoint>* OnlyChunks)
+{
+	const FBox Bounds = Proxy->GetComponentsBoundingBox();
+
+	if (!Bounds.IsValid)
+	{
+		return;
+	}
+
+	const FObjectKey ProxyKey(Proxy);
+	const FIntPoint MinChunk = GetChunkCoord(Bounds.Min);
+	const FIntPoint MaxChunk = GetChunkCoord(Bounds.Max);
+
+	for (int32 Y = MinChunk.Y; Y <= MaxChunk.Y; ++Y)
+	{
+		for (int32 X = MinChunk.X; X <= MaxChunk.X; ++X)
+		{
+			const FIntPoint ChunkCoord(X, Y);
+
+			if (OnlyChunks && !OnlyChunks->Contains(ChunkCoord))
+			{
+				continue;
+			}
+
+			if (FSurfaceChunk* Existing = Chunks.Find(ChunkCoord))
+			{
+				// The chunk was already sampled with this proxy loaded.
+				if (Existing->Proxies.Contains(ProxyKey))
+				{
+					continue;
+				}
+
+				const SIZE_T OldSize = Existing->GetAllocatedSize();
+				Existing->Proxies.Add(ProxyKey);
+				TrackChunkMemory(Existing->GetAllocatedSize() - OldSize);
+
+				// Another proxy overlapping the chunk widens its trace range. Anything already sampled missed the new
+				// proxy's landscape, so the chunk starts over.
+				Existing->MinZ = FMath::Min(Existing->MinZ, Bounds.Min.Z - kTraceMargin);
+				Existing->MaxZ = FMath::Max(Existing->MaxZ, Bounds.Max.Z + kTraceMargin);
+
+				if (Existing->bBuilt || Existing->NextSample > 0)
+				{
+					RestartChunk(ChunkCoord, *Existing);
+				}
+
+				continue;
+			}
+
+			FSurfaceChunk& Chunk = Chunks.Add(ChunkCoord);
+			Chunk.Cells.SetNum(ChunkCells * ChunkCells);
+			Chunk.Samples.SetNumZeroed(ChunkCells * ChunkCells * SamplesPerCell);
+			Chunk.Proxies.Add(ProxyKey);
+			Chunk.MinZ = Bounds.Min.Z - kTraceMargin;
+			Chunk.MaxZ = Bounds.Max.Z + kTraceMargin;
+			Chunk.Generation = ++NextChunkGeneration;
+
+			TrackChunkMemory(Chunk.GetAllocatedSize());
+
+			BuildQueue.Add(ChunkCoord);
+		}
+	}
+
+	SET_DWORD_STAT(STAT_SurfaceCacheChunks, Chunks.Num());
+}
+
+void USurfaceCacheSubsystem::RestartChunk(const FIntPoint& ChunkCoord, FSurfaceChunk& Chunk)
+{
+	const SIZE_T OldSize = Chunk.GetAllocatedSize();
+
+	Chunk.Samples.SetNumZeroed(ChunkCells * ChunkCells * SamplesPerCell);
+	Chunk.NextSample = 0;
+	Chunk.PendingSamples = 0;
+	Chunk.bBuilt = false;
+
+	// Samples still in flight carry the old generation and are dropped when they complete.
+	Chunk.Generation = ++NextChunkGeneration;
+
+	TrackChunkMemory(Chunk.GetAllocatedSize() - OldSize);
+
+	BuildQueue.AddUnique(ChunkCoord);
+}
+
+void USurfaceCacheSubsystem::RemoveChunk(const FIntPoint& ChunkCoord)
+{
+	FSurfaceChunk Chunk;
+
+	if (!Chunks.RemoveAndCopyValue(ChunkCoord, Chunk))
+	{
+		return;
+	}
+
+	UntrackChunkMemory(Chunk.GetAllocatedSize());
+
+	// Samples still in flight for this chunk find no chunk, or a newer generation of it, when they complete and are dropped.
+	BuildQueue.Remove(ChunkCoord);
+
+	SET_DWORD_STAT(STAT_SurfaceCacheChunks, Chunks.Num());
+}
+
+void USurfaceCacheSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SurfaceCacheBuild);
+
+	Super::Tick(DeltaTime);
+
+	if (BuildQueue.Num() > 0)
+	{
+		IssueSamples(FMath::Max(CVarSurfaceCacheTracesPerFrame.GetValueOnGameThread(), 1));
+	}
+
+	SET_DWORD_STAT(STAT_SurfaceCacheSamplesInFlight, PendingSamples.Num());
+}
+
+void USurfaceCacheSubsystem::IssueSamples(int32 Budget)
+{
+	const FCollisionObjectQueryParams ObjectParams(ECC_WorldStatic);
+	FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(SurfaceCache), false);
+	TraceParams.bReturnPhysicalMaterial = true;
+
+	const int32 NumSamples = ChunkCells * ChunkCells * SamplesPerCell;
+	const double SampleSpacing = CellSize / SamplesPerAxis;
+
+	while (Budget > 0 && BuildQueue.Num() > 0)
+	{
+		const FIntPoint ChunkCoord = BuildQueue[0];
+		FSurfaceChunk& Chunk = Chunks.FindChecked(ChunkCoord);
+		const FVector2D ChunkMin = GetChunkBounds(ChunkCoord).Min;
+
+		for (; Budget > 0 && Chunk.NextSample < NumSamples; --Budget, ++Chunk.NextSample)
+		{
+			const int32 CellIndex = Chunk.NextSample / SamplesPerCell;
+			const int32 SubSample = Chunk.NextSample % SamplesPerCell;
+
+			const int32 SampleX = (CellIndex % ChunkCells) * SamplesPerAxis + SubSample % SamplesPerAxis;
+			const int32 SampleY = (CellIndex / ChunkCells) * SamplesPerAxis + SubSample / SamplesPerAxis;
+			const FVector2D Location = ChunkMin + FVector2D(SampleX + 0.5, SampleY + 0.5) * SampleSpacing;
+
+			const uint32 SampleId = ++NextSampleId;
+			PendingSamples.Add(SampleId, FPendingSample{ ChunkCoord, Chunk.NextSample, Chunk.Generation });
+			++Chunk.PendingSamples;
+
+			// Object traces return every hit along the line, so the landscape is found even under rocks and buildings.
+			GetWorld()->AsyncLineTraceByObjectType(EAsyncTraceType::Multi, FVector(Location, Chunk.MaxZ), FVector(Location, Chunk.MinZ),
+				ObjectParams, TraceParams, &TraceDelegate, SampleId);
+		}
+
+		if (Chunk.NextSample >= NumSamples)
+		{
+			BuildQueue.RemoveAt(0);
+		}
+	}
+}
+
+void USurfaceCacheSubsystem::OnTraceCompleted(const FTraceHandle& Handle, FTraceDatum& Datum)
+{
+	FPendingSample Sample;
+
+	if (!PendingSamples.RemoveAndCopyValue(Datum.UserData, Sample))
+	{
+		return;
+	}
+
+	FSurfaceChunk* Chunk = Chunks.Find(Sample.Chunk);
+
+	if (Chunk == nullptr || Chunk->Generation != Sample.Generation || Chunk->bBuilt)
+	{
+		return;
+	}
+
+	const FHitResult* LandscapeHit = nullptr;
+
+	for (const FHitResult& Hit : Datum.OutHits)
+	{
+		if (Hit.GetComponent() && Hit.GetComponent()->IsA<ULandscapeHeightfieldCollisionComponent>()
+			&& (LandscapeHit == nullptr || Hit.Distance < LandscapeHit->Distance))
+		{
+			LandscapeHit = &Hit;
+		}
+	}
+
+	Chunk->Samples[Sample.SampleIndex] = LandscapeHit ? FindOrAddMaterial(LandscapeHit->PhysMaterial.Get()) : 0;
+
+	if (--Chunk->PendingSamples == 0 && Chunk->NextSample >= Chunk->Samples.Num())
+	{
+		FinishChunk(*Chunk);
+	}
+}
+
+void USurfaceCacheSubsystem::FinishChunk(FSurfaceChunk& Chunk)
+{
+	for (int32 CellIndex = 0; CellIndex < Chunk.Cells.Num(); ++CellIndex)
+	{
+		const uint8* CellSamples = &Chunk.Samples[CellIndex * SamplesPerCell];
+
+		uint8 Counts[SamplesPerCell] = {};
+
+		for (int32 Sample = 0; Sample < SamplesPerCell; ++Sample)
+		{
+			for (int32 Other = 0; Other < SamplesPerCell; ++Other)
+			{
+				Counts[Sample] += CellSamples[Sample] == CellSamples[Other] ? 1 : 0;
+			}
+		}
+
+		int32 DominantSample = 0;
+
+		for (int32 Sample = 1; Sample < SamplesPerCell; ++Sample)
+		{
+			DominantSample = Counts[Sample] > Counts[DominantSample] ? Sample : DominantSample;
+		}
+
+		// A restarted chunk still holds the cells of its previous build.
+		FPackedCell& Cell = Chunk.Cells[CellIndex];
+		Cell.Dominant = CellSamples[DominantSample];
+		Cell.Secondary = 0;
+		Cell.SecondaryWeight = 0;
+
+		for (int32 Sample = 0; Sample < SamplesPerCell; ++Sample)
+		{
+			if (CellSamples[Sample] != Cell.Dominant && Counts[Sample] * 255 / SamplesPerCell > Cell.SecondaryWeight)
+			{
+				Cell.Secondary = CellSamples[Sample];
+				Cell.SecondaryWeight = static_cast<uint8>(Counts[Sample] * 255 / SamplesPerCell);
+			}
+		}
+	}
+
+	UntrackChunkMemory(Chunk.Samples.GetAllocatedSize());
+	Chunk.Samples.Empty();
+	Chunk.bBuilt = true;
+}
+
+void USurfaceCacheSubsystem::TrackChunkMemory(SIZE_T Bytes)
+{
+	TrackedChunkMemory += Bytes;
+	INC_MEMORY_STAT_BY(STAT_SurfaceCacheMemory, Bytes);
+}
+
+void USurfaceCacheSubsystem::UntrackChunkMemory(SIZE_T Bytes)
+{
+	TrackedChunkMemory -= Bytes;
+	DEC_MEMORY_STAT_BY(STAT_SurfaceCacheMemory, Bytes);
+}
+
+uint8 USurfaceCacheSubsystem::FindOrAddMaterial(UPhysicalMaterial* Material)
+{
+	if (Material == nullptr)
+	{
+		return 0;
+	}
+
+	if (const uint8* Index = MaterialLookup.Find(Material))
+	{
+		return *Index;
+	}
+
+	if (Materials.Num() > MAX_uint8)
+	{
+		UE_LOG(LogTankGame, Warning, TEXT("SurfaceCache: more than %d landscape physical materials, %s is not cached"), MAX_uint8, *Material->GetName());
+		return 0;
+	}
+
+	const uint8 Index = static_cast<uint8>(Materials.Add(Material));
+	MaterialLookup.Add(Material, Index);
+	return Index;
+}
+
+FCachedSurface USurfaceCacheSubsystem::SampleSurface(const FVector& Location) const
+{
+	FCachedSurface Surface;
+
+	const FIntPoint ChunkCoord = GetChunkCoord(Location);
+	const FSurfaceChunk* Chunk = Chunks.Find(ChunkCoord);
+
+	if (Chunk == nullptr || !Chunk->bBuilt)
+	{
+		return Surface;
+	}
+
+	const FVector2D Local = (FVector2D(Location) - GetChunkBounds(ChunkCoord).Min) / CellSize;
+	const int32 CellX = FMath::Clamp(FMath::FloorToInt32(Local.X), 0, ChunkCells - 1);
+	const int32 CellY = FMath::Clamp(FMath::FloorToInt32(Local.Y), 0, ChunkCells - 1);
+	const FPackedCell& Cell = Chunk->Cells[CellY * ChunkCells + CellX];
+
+	Surface.Dominant = Materials[Cell.Dominant];
+	Surface.SurfaceType = Surface.Dominant ? Surface.Dominant->SurfaceType : TEnumAsByte<EPhysicalSurface>(SurfaceType_Default);
+	Surface.Secondary = Materials[Cell.Secondary];
+	Surface.SecondaryWeight = Cell.SecondaryWeight / 255.f;
+	Surface.bValid = Cell.Dominant != 0;
+	return Surface;
+}
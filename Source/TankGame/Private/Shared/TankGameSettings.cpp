@@ -0,0 +1,14 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+
+#include "Shared/TankGameSettings.h"
+
+UTankGameSettings::UTankGameSettings()
+{
+	SectionName = TEXT("TankGame");
+}
+
+FName UTankGameSettings::GetCategoryName() const
+{
+	return TEXT("Game");
+}
@@ -0,0 +1,237 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+
+#include "Shared/WorldSnapshot.h"
+
+#include "TankGame.h"
+#include "Misc/Compression.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	/** Largest payload a checkpoint may claim, so a corrupt header cannot ask for a huge allocation. */
+	constexpr int32 kMaxUncompressedSize = 64 * 1024 * 1024;
+
+	/**
+	 * Lower bounds on the serialized size of each record, used to reject counts the remaining bytes cannot hold
+	 * before allocating for them. Real records are larger, as vectors are serialized as doubles.
+	 */
+	constexpr int64 kMinClassBytes = 4;
+	constexpr int64 kMinTankRecordBytes = 88;
+	constexpr int64 kMinCharacterRecordBytes = 60;
+
+	struct FSnapshotHeader
+	{
+		uint32 Magic = 0;
+		uint32 Version = 0;
+		int32 UncompressedSize = 0;
+		int32 CompressedSize = 0;
+	};
+
+	void SerializeHeader(FArchive& Ar, FSnapshotHeader& Header)
+	{
+		Ar << Header.Magic << Header.Version << Header.UncompressedSize << Header.CompressedSize;
+	}
+
+	void SerializeTank(FArchive& Ar, FTankSnapshot& Tank, uint32 Version)
+	{
+		Ar << Tank.Location << Tank.Rotation << Tank.LinearVelocity << Tank.AngularVelocity;
+		Ar << Tank.TurretAngle << Tank.GunAngle << Tank.Health << Tank.ClassIndex;
+		Ar << Tank.bLightsOn << Tank.bOccupied << Tank.bPlayerControlled;
+	}
+
+	void SerializeCharacter(FArchive& Ar, FCharacterSnapshot& Character, uint32 Version)
+	{
+		Ar << Character.Location << Character.Rotation << Character.Velocity << Character.Health << Character.ClassIndex;
+		Ar << Character.bAiming << Character.bCrouched << Character.bOccupied << Character.bPlayerControlled;
+
+		if (Version >= FWorldSnapshot::VehicleOccupancy)
+		{
+			Ar << Character.bInVehicle;
+		}
+	}
+
+	/** Serializes an array count. When loading, flags an error if the rest of the archive cannot hold that many records. */
+	bool SerializeCount(FArchive& Ar, int32& Count, int64 MinRecordBytes)
+	{
+		Ar << Count;
+
+		if (Ar.IsLoading() && (Ar.IsError() || Count < 0 || Count > (Ar.TotalSize() - Ar.Tell()) / MinRecordBytes))
+		{
+			Ar.SetError();
+			return false;
+		}
+
+		return true;
+	}
+}
+
+int32 FWorldSnapshot::AddClass(const UClass* Class)
+{
+	if (const int32* ExistingIndex = ClassIndices.Find(Class))
+	{
+		return *ExistingIndex;
+	}
+
+	const int32 ClassIndex = Classes.Emplace(Class);
+	ClassIndices.Add(Class, ClassIndex);
+	return ClassIndex;
+}
+
+void FWorldSnapshot::Reset()
+{
+	Classes.Reset();
+	Tanks.Reset();
+	Characters.Reset();
+	ClassIndices.Reset();
+}
+
+void FWorldSnapshot::SerializePayload(FArchive& Ar, uint32 Version)
+{
+	// Same layout as TArray serialization, but with every count validated before anything is allocated.
+	int32 NumClasses = Classes.Num();
+
+	if (!SerializeCount(Ar, NumClasses, kMinClassBytes))
+	{
+		return;
+	}
+
+	if (Ar.IsLoading())
+	{
+		Classes.SetNum(NumClasses);
+	}
+
+	for (FSoftClassPath& Class : Classes)
+	{
+		Ar << Class;
+	}
+
+	int32 NumTanks = Tanks.Num();
+
+	if (!SerializeCount(Ar, NumTanks, kMinTankRecordBytes))
+	{
+		return;
+	}
+
+	if (Ar.IsLoading())
+	{
+		Tanks.SetNum(NumTanks);
+	}
+
+	for (FTankSnapshot& Tank : Tanks)
+	{
+		SerializeTank(Ar, Tank, Version);
+	}
+
+	int32 NumCharacters = Characters.Num();
+
+	if (!SerializeCount(Ar, NumCharacters, kMinCharacterRecordBytes))
+	{
+		return;
+	}
+
+	if (Ar.IsLoading())
+	{
+		Characters.SetNum(NumCharacters);
+	}
+
+	for (FCharacterSnapshot& Character : Characters)
+	{
+		SerializeCharacter(Ar, Character, Version);
+	}
+}
+
+bool FWorldSnapshot::Encode(TArray<uint8>& OutBytes) const
+{
+	TArray<uint8> Payload;
+	Payload.Reserve(Tanks.Num() * sizeof(FTankSnapshot) + Characters.Num() * sizeof(FCharacterSnapshot) + 1024);
+
+	// Serialization is shared between saving and loading, so it takes the snapshot non-const; saving never modifies it.
+	FMemoryWriter PayloadWriter(Payload);
+	const_cast<FWorldSnapshot*>(this)->SerializePayload(PayloadWriter, Latest);
+
+	FSnapshotHeader Header;
+	Header.Magic = Magic;
+	Header.Version = Latest;
+	Header.UncompressedSize = Payload.Num();
+
+	int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Oodle, Payload.Num());
+
+	OutBytes.Reset();
+	FMemoryWriter HeaderWriter(OutBytes);
+	SerializeHeader(HeaderWriter, Header);
+
+	const int32 HeaderSize = OutBytes.Num();
+	OutBytes.AddUninitialized(CompressedSize);
+
+	if (!FCompression::CompressMemory(NAME_Oodle, OutBytes.GetData() + HeaderSize, CompressedSize, Payload.GetData(), Payload.Num()))
+	{
+		return false;
+	}
+
+	OutBytes.SetNum(HeaderSize + CompressedSize, EAllowShrinking::No);
+
+	// Patch in the real compressed size now that it is known.
+	Header.CompressedSize = CompressedSize;
+	HeaderWriter.Seek(0);
+	SerializeHeader(HeaderWriter, Header);
+
+	return true;
+}
+
+bool FWorldSnapshot::Decode(const TArray<uint8>& Bytes)
+{
+	Reset();
+
+	FMemoryReader HeaderReader(Bytes);
+	FSnapshotHeader Header;
+	SerializeHeader(HeaderReader, Header);
+
+	if (HeaderReader.IsError() || Header.Magic != Magic)
+	{
+		UE_LOG(LogTankGame, Warning, TEXT("WorldSnapshot: not a checkpoint file"));
+		return false;
+	}
+
+	if (Header.Version < Initial || Header.Version > Latest)
+	{
+		UE_LOG(LogTankGame, Warning, TEXT("WorldSnapshot: unsupported checkpoint version %u (latest is %u)"), Header.Version, static_cast<uint32>(Latest));
+		return false;
+	}
+
+	const int64 HeaderSize = HeaderReader.Tell();
+
+	if (Header.CompressedSize < 0 || Header.UncompressedSize < 0 || HeaderSize + Header.CompressedSize > Bytes.Num())
+	{
+		UE_LOG(LogTankGame, Warning, TEXT("WorldSnapshot: checkpoint is truncated"));
+		return false;
+	}
+
+	if (Header.UncompressedSize > kMaxUncompressedSize)
+	{
+		UE_LOG(LogTankGame, Warning, TEXT("WorldSnapshot: checkpoint claims %d bytes of payload, more than the %d allowed"), Header.UncompressedSize, kMaxUncompressedSize);
+		return false;
+	}
+
+	TArray<uint8> Payload;
+	Payload.SetNumUninitialized(Header.UncompressedSize);
+
+	if (!FCompression::UncompressMemory(NAME_Oodle, Payload.GetData(), Payload.Num(), Bytes.GetData() + HeaderSize, Header.CompressedSize))
+	{
+		UE_LOG(LogTankGame, Warning, TEXT("WorldSnapshot: failed to decompress checkpoint"));
+		return false;
+	}
+
+	FMemoryReader PayloadReader(Payload);
+	SerializePayload(PayloadReader, Header.Version);
+
+	if (PayloadReader.IsError())
+	{
+		UE_LOG(LogTankGame, Warning, TEXT("WorldSnapshot: checkpoint payload is corrupt"));
+		Reset();
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,197 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+
+#include "Tank/ArmorBVH.h"
+
+#include "Algo/Sort.h"
+
+namespace
+{
+	FBox3f GetPrimitiveBounds(const FArmorPlatePrimitive& Primitive)
+	{
+		const FVector3f Extent(
+			FMath::Abs(Primitive.AxisX.X) * Primitive.HalfExtent.X + FMath::Abs(Primitive.AxisY.X) * Primitive.HalfExtent.Y + FMath::Abs(Primitive.AxisZ.X) * Primitive.HalfExtent.Z,
+			FMath::Abs(Primitive.AxisX.Y) * Primitive.HalfExtent.X + FMath::Abs(Primitive.AxisY.Y) * Primitive.HalfExtent.Y + FMath::Abs(Primitive.AxisZ.Y) * Primitive.HalfExtent.Z,
+			FMath::Abs(Primitive.AxisX.Z) * Primitive.HalfExtent.X + FMath::Abs(Primitive.AxisY.Z) * Primitive.HalfExtent.Y + FMath::Abs(Primitive.AxisZ.Z) * Primitive.HalfExtent.Z);
+
+		return FBox3f(Primitive.Center - Extent, Primitive.Center + Extent);
+	}
+
+	/** Slab test. Returns the entry distance, or a negative value on a miss. */
+	float IntersectBox(const FVector3f& BoundsMin, const FVector3f& BoundsMax, const FVector3f& Origin, const FVector3f& InvDirection,
+		float MaxDistance)
+	{
+		const FVector3f T0 = (BoundsMin - Origin) * InvDirection;
+		const FVector3f T1 = (BoundsMax - Origin) * InvDirection;
+
+		const float Enter = FMath::Max3(FMath::Min(T0.X, T1.X), FMath::Min(T0.Y, T1.Y), FMath::Min(T0.Z, T1.Z));
+		const float Exit = FMath::Min3(FMath::Max(T0.X, T1.X), FMath::Max(T0.Y, T1.Y), FMath::Max(T0.Z, T1.Z));
+
+		if (Exit < FMath::Max(Enter, 0.f) || Enter > MaxDistance)
+		{
+			return -1.f;
+		}
+
+		return FMath::Max(Enter, 0.f);
+	}
+
+	float IntersectPlate(const FArmorPlatePrimitive& Primitive, const FVector3f& Origin, const FVector3f& Direction, float MaxDistance)
+	{
+		const FVector3f Offset = Origin - Primitive.Center;
+		const FVector3f LocalOrigin(Offset | Primitive.AxisX, Offset | Primitive.AxisY, Offset | Primitive.AxisZ);
+		const FVector3f LocalDirection(Direction | Primitive.AxisX, Direction | Primitive.AxisY, Direction | Primitive.AxisZ);
+
+		const FVector3f InvDirection(
+			LocalDirection.X != 0.f ? 1.f / LocalDirection.X : BIG_NUMBER,
+			LocalDirection.Y != 0.f ? 1.f / LocalDirection.Y : BIG_NUMBER,
+			LocalDirection.Z != 0.f ? 1.f / LocalDirection.Z : BIG_NUMBER);
+
+		return IntersectBox(-Primitive.HalfExtent, Primitive.HalfExtent, LocalOrigin, InvDirection, MaxDistance);
+	}
+}
+
+void FArmorBVH::Build(TArray<FArmorPlatePrimitive>&& InPrimitives)
+{
+	Reset();
+
+	Primitives = MoveTemp(InPrimitives);
+
+	if (Primitives.Num() > 0)
+	{
+		Nodes.Reserve(Primitives.Num() * 2);
+		BuildRecursive(0, Primitives.Num(), 0);
+		Nodes.Shrink();
+	}
+}
+
+void FArmorBVH::Reset()
+{
+	Nodes.Reset();
+	Primitives.Reset();
+}
+
+int32 FArmorBVH::BuildRecursive(int32 Begin, int32 End, int32 Depth)
+{
+	const int32 NodeIndex = Nodes.AddDefaulted();
+
+	FBox3f Bounds(ForceInit);
+	FBox3f CentroidBounds(ForceInit);
+
+	for (int32 PrimitiveIndex = Begin; PrimitiveIndex < End; ++PrimitiveIndex)
+	{
+		Bounds += GetPrimitiveBounds(Primitives[PrimitiveIndex]);
+		CentroidBounds += Primitives[PrimitiveIndex].Center;
+	}
+
+	Nodes[NodeIndex].BoundsMin = Bounds.Min;
+	Nodes[NodeIndex].BoundsMax = Bounds.Max;
+
+	const int32 Count = End - Begin;
+
+	if (Count <= MaxLeafPrimitives || Depth >= MaxDepth)
+	{
+		Nodes[NodeIndex].Offset = Begin;
+		Nodes[NodeIndex].PrimitiveCount = Count;
+		return NodeIndex;
+	}
+
+	// Median split along the longest axis of the centroids keeps the tree balanced for any plate layout.
+	const FVector3f CentroidExtent = CentroidBounds.GetExtent();
+	const int32 Axis = CentroidExtent.X >= CentroidExtent.Y && CentroidExtent.X >= CentroidExtent.Z ? 0 : (CentroidExtent.Y >= CentroidExtent.Z ? 1 : 2);
+
+	Algo::Sort(MakeArrayView(Primitives.GetData() + Begin, Count), [Axis](const FArmorPlatePrimitive& A, const FArmorPlatePrimitive& B)
+	{
+		return A.Center[Axis] < B.Center[Axis];
+	});
+
+	const int32 Middle = Begin + Count / 2;
+
+	BuildRecursive(Begin, Middle, Depth + 1);
+	const int32 RightIndex = BuildRecursive(Middle, End, Depth + 1);
+
+	Nodes[NodeIndex].Offset = RightIndex;
+	Nodes[NodeIndex].PrimitiveCount = 0;
+
+	return NodeIndex;
+}
+
+bool FArmorBVH::Raycast(const FVector3f& Origin, const FVector3f& Direction, float MaxDistance, FArmorRayHit& OutHit) const
+{
+	if (Nodes.IsEmpty())
+	{
+		return false;
+	}
+
+	const FVector3f InvDirection(
+		Direction.X != 0.f ? 1.f / Direction.X : BIG_NUMBER,
+		Direction.Y != 0.f ? 1.f / Direction.Y : BIG_NUMBER,
+		Direction.Z != 0.f ? 1.f / Direction.Z : BIG_NUMBER);
+
+	float ClosestDistance = MaxDistance;
+	int32 ClosestPrimitive = INDEX_NONE;
+
+	int32 Stack[MaxDepth * 2];
+	int32 StackSize = 0;
+	Stack[StackSize++] = 0;
+
+	while (StackSize > 0)
+	{
+		const FNode& Node = Nodes[Stack[--StackSize]];
+
+		if (IntersectBox(Node.BoundsMin, Node.BoundsMax, Origin, InvDirection, ClosestDistance) < 0.f)
+		{
+			continue;
+		}
+
+		if (Node.PrimitiveCount > 0)
+		{
+			for (int32 PrimitiveIndex = Node.Offset; PrimitiveIndex < Node.Offset + Node.PrimitiveCount; ++PrimitiveIndex)
+			{
+				const float Distance = IntersectPlate(Primitives[PrimitiveIndex], Origin, Direction, ClosestDistance);
+
+				if (Distance >= 0.f && Distance < ClosestDistance)
+				{
+					ClosestDistance = Distance;
+					ClosestPrimitive = PrimitiveIndex;
+				}
+			}
+
+			continue;
+		}
+
+		const int32 LeftIndex = static_cast<int32>(&Node - Nodes.GetData()) + 1;
+		const int32 RightIndex = Node.Offset;
+
+		// Visit the nearer child first so the farther one is usually culled by ClosestDistance.
+		const FNode& Left = Nodes[LeftIndex];
+		const FNode& Right = Nodes[RightIndex];
+		const float LeftDistance = ((Left.BoundsMin + Left.BoundsMax) * 0.5f - Origin) | Direction;
+		const float RightDistance = ((Right.BoundsMin + Right.BoundsMax) * 0.5f - Origin) | Direction;
+
+		if (LeftDistance < RightDistance)
+		{
+			Stack[StackSize++] = RightIndex;
+			Stack[StackSize++] = LeftIndex;
+		}
+		else
+		{
+			Stack[StackSize++] = LeftIndex;
+			Stack[StackSize++] = RightIndex;
+		}
+	}
+
+	if (ClosestPrimitive == INDEX_NONE)
+	{
+		return false;
+	}
+
+	OutHit.PlateIndex = Primitives[ClosestPrimitive].PlateIndex;
+	OutHit.Distance = ClosestDistance;
+
+	return true;
+}
+
+FBox3f FArmorBVH::GetBounds() const
+{
+	return Nodes.Num() > 0 ? FBox3f(Nodes[0].BoundsMin, Nodes[0].BoundsMax) : FBox3f(ForceInit);
+}
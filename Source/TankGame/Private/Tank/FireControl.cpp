@@ -0,0 +1,336 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+
+#include "Tank/FireControl.h"
+
+#include "TankGame.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/VectorRegister.h"
+
+DECLARE_CYCLE_STAT(TEXT("Fire Control Batch"), STAT_FireControlBatch, STATGROUP_TankGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Fire Control Pairs"), STAT_FireControlPairs, STATGROUP_TankGame);
+
+namespace
+{
+	constexpr float kMinHorizontalDistance = 1.f;
+
+	struct FArcLanes
+	{
+		VectorRegister4Float Yaw;
+		VectorRegister4Float Pitch;
+		VectorRegister4Float Time;
+	};
+
+	/** One arc for four targets. RelX/Y/Z are target positions relative to the shooter. */
+	template <bool bHighArc>
+	FORCEINLINE FArcLanes SolveArcLanes(const VectorRegister4Float& RelX, const VectorRegister4Float& RelY, const VectorRegister4Float& RelZ,
+		const VectorRegister4Float& VelX, const VectorRegister4Float& VelY, const VectorRegister4Float& VelZ,
+		const VectorRegister4Float& Speed, const VectorRegister4Float& SpeedSquared, const VectorRegister4Float& Gravity, int32 Iterations)
+	{
+		const VectorRegister4Float One = GlobalVectorConstants::FloatOne;
+		const VectorRegister4Float Zero = GlobalVectorConstants::FloatZero;
+		const VectorRegister4Float Two = VectorSetFloat1(2.f);
+		const VectorRegister4Float MinDistance = VectorSetFloat1(kMinHorizontalDistance);
+		const VectorRegister4Float SpeedFourth = VectorMultiply(SpeedSquared, SpeedSquared);
+
+		// Start from the straight-line flight time to where the target is now.
+		const VectorRegister4Float InitialDistanceSquared = VectorMultiplyAdd(RelX, RelX, VectorMultiplyAdd(RelY, RelY, VectorMultiply(RelZ, RelZ)));
+		VectorRegister4Float Time = VectorDivide(VectorSqrt(InitialDistanceSquared), Speed);
+
+		VectorRegister4Float PredictedX = RelX;
+		VectorRegister4Float PredictedY = RelY;
+		VectorRegister4Float TanPitch = Zero;
+		VectorRegister4Float Discriminant = Zero;
+
+		for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+		{
+			PredictedX = VectorMultiplyAdd(VelX, Time, RelX);
+			PredictedY = VectorMultiplyAdd(VelY, Time, RelY);
+			const VectorRegister4Float PredictedZ = VectorMultiplyAdd(VelZ, Time, RelZ);
+
+			const VectorRegister4Float DistanceSquared = VectorMultiplyAdd(PredictedX, PredictedX, VectorMultiply(PredictedY, PredictedY));
+			const VectorRegister4Float Distance = VectorMax(VectorSqrt(DistanceSquared), MinDistance);
+
+			// tan(pitch) = (v^2 -/+ sqrt(v^4 - g(g d^2 + 2 h v^2))) / (g d)
+			const VectorRegister4Float Inner = VectorMultiplyAdd(Gravity, DistanceSquared, VectorMultiply(Two, VectorMultiply(PredictedZ, SpeedSquared)));
+			Discriminant = VectorSubtract(SpeedFourth, VectorMultiply(Gravity, Inner));
+
+			const VectorRegister4Float Root = VectorSqrt(VectorMax(Discriminant, Zero));
+			const VectorRegister4Float Numerator = bHighArc ? VectorAdd(SpeedSquared, Root) : VectorSubtract(SpeedSquared, Root);
+			TanPitch = VectorDivide(Numerator, VectorMultiply(Gravity, Distance));
+
+			// t = d / (v cos(pitch)), with cos(pitch) = 1 / sqrt(1 + tan^2)
+			const VectorRegister4Float SecPitch = VectorSqrt(VectorMultiplyAdd(TanPitch, TanPitch, One));
+			Time = VectorDivide(VectorMultiply(Distance, SecPitch), Speed);
+		}
+
+		const VectorRegister4Float RadiansToDegrees = VectorSetFloat1(180.f / UE_PI);
+		const VectorRegister4Float InRange = VectorCompareGE(Discriminant, Zero);
+
+		FArcLanes Lanes;
+		Lanes.Yaw = VectorMultiply(VectorATan2(PredictedY, PredictedX), RadiansToDegrees);
+		Lanes.Pitch = VectorMultiply(VectorATan2(TanPitch, One), RadiansToDegrees);
+		Lanes.Time = VectorSelect(InRange, Time, GlobalVectorConstants::FloatMinusOne);
+		return Lanes;
+	}
+
+	template <bool bHighArc>
+	void SolveArcScalar(const FVector3f& Rel, const FVector3f& Velocity, const FFireControlParams& Params, float& OutYaw, float& OutPitch,
+		float& OutTime)
+	{
+		const float SpeedSquared = FMath::Square(Params.MuzzleSpeed);
+		const float Gravity = Params.Gravity;
+
+		float Time = Rel.Size() / Params.MuzzleSpeed;
+		FVector3f Predicted = Rel;
+		float TanPitch = 0.f;
+		float Discriminant = 0.f;
+
+		for (int32 Iteration = 0; Iteration < Params.Iterations; ++Iteration)
+		{
+			Predicted = Rel + Velocity * Time;
+
+			const float DistanceSquared = FMath::Square(Predicted.X) + FMath::Square(Predicted.Y);
+			const float Distance = FMath::Max(FMath::Sqrt(DistanceSquared), kMinHorizontalDistance);
+
+			Discriminant = SpeedSquared * SpeedSquared - Gravity * (Gravity * DistanceSquared + 2.f * Predicted.Z * SpeedSquared);
+
+			const float Root = FMath::Sqrt(FMath::Max(Discriminant, 0.f));
+			TanPitch = (bHighArc ? SpeedSquared + Root : SpeedSquared - Root) / (Gravity * Distance);
+			Time = Distance * FMath::Sqrt(1.f + TanPitch * TanPitch) / Params.MuzzleSpeed;
+		}
+
+		OutYaw = FMath::RadiansToDegrees(FMath::Atan2(Predicted.Y, Predicted.X));
+		OutPitch = FMath::RadiansToDegrees(FMath::Atan(TanPitch));
+		OutTime = Discriminant >= 0.f ? Time : -1.f;
+	}
+}
+
+void FFireControlTargets::Reset(int32 ExpectedNum)
+{
+	const int32 PaddedNum = Align(ExpectedNum, Width);
+
+	for (TArray<float, TAlignedHeapAllocator<16>>* Lane : { &PosX, &PosY, &PosZ, &VelX, &VelY, &VelZ })
+	{
+		Lane->Reset(PaddedNum);
+	}
+
+	NumTargets = 0;
+}
+
+int32 FFireControlTargets::Add(const FVector& Location, const FVector& Velocity)
+{
+	if (NumTargets == PosX.Num())
+	{
+		for (TArray<float, TAlignedHeapAllocator<16>>* Lane : { &PosX, &PosY, &PosZ, &VelX, &VelY, &VelZ })
+		{
+			Lane->AddZeroed(Width);
+		}
+	}
+
+	PosX[NumTargets] = Location.X;
+	PosY[NumTargets] = Location.Y;
+	PosZ[NumTargets] = Location.Z;
+	VelX[NumTargets] = Velocity.X;
+	VelY[NumTargets] = Velocity.Y;
+	VelZ[NumTargets] = Velocity.Z;
+
+	return NumTargets++;
+}
+
+FFireControlSolution FFireControlSolutions::Get(int32 ShooterIndex, int32 TargetIndex) const
+{
+	const int32 Index = ShooterIndex * RowStride + TargetIndex;
+
+	FFireControlSolution Solution;
+	Solution.LowYaw = LowYaw[Index];
+	Solution.LowPitch = LowPitch[Index];
+	Solution.LowTime = LowTime[Index];
+	Solution.HighYaw = HighYaw[Index];
+	Solution.HighPitch = HighPitch[Index];
+	Solution.HighTime = HighTime[Index];
+	return Solution;
+}
+
+void FFireControl::SolveBatch(TConstArrayView<FVector> ShooterLocations, const FFireControlTargets& Targets, const FFireControlParams& Params,
+	FFireControlSolutions& OutSolutions)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FireControlBatch);
+
+	const int32 RowStride = Targets.GetPaddedNum();
+	const int32 NumSolutions = ShooterLocations.Num() * RowStride;
+
+	OutSolutions.NumShooters = ShooterLocations.Num();
+	OutSolutions.RowStride = RowStride;
+
+	for (TArray<float, TAlignedHeapAllocator<16>>* Lane : { &OutSolutions.LowYaw, &OutSolutions.LowPitch, &OutSolutions.LowTime,
+		&OutSolutions.HighYaw, &OutSolutions.HighPitch, &OutSolutions.HighTime })
+	{
+		Lane->SetNumUninitialized(NumSolutions, EAllowShrinking::No);
+	}
+
+	INC_DWORD_STAT_BY(STAT_FireControlPairs, ShooterLocations.Num() * Targets.Num());
+
+	const VectorRegister4Float Speed = VectorSetFloat1(Params.MuzzleSpeed);
+	const VectorRegister4Float SpeedSquared = VectorMultiply(Speed, Speed);
+	const VectorRegister4Float Gravity = VectorSetFloat1(Params.Gravity);
+
+	for (int32 ShooterIndex = 0; ShooterIndex < ShooterLocations.Num(); ++ShooterIndex)
+	{
+		const FVector& Shooter = ShooterLocations[ShooterIndex];
+		const VectorRegister4Float ShooterX = VectorSetFloat1(static_cast<float>(Shooter.X));
+		const VectorRegister4Float ShooterY = VectorSetFloat1(static_cast<float>(Shooter.Y));
+		const VectorRegister4Float ShooterZ = VectorSetFloat1(static_cast<float>(Shooter.Z));
+
+		const int32 RowStart = ShooterIndex * RowStride;
+
+		for (int32 TargetIndex = 0; TargetIndex < RowStride; TargetIndex += FFireControlTargets::Width)
+		{
+			const VectorRegister4Float RelX = VectorSubtract(VectorLoadAligned(&Targets.PosX[TargetIndex]), ShooterX);
+			const VectorRegister4Float RelY = VectorSubtract(VectorLoadAligned(&Targets.PosY[TargetIndex]), ShooterY);
+			const VectorRegister4Float RelZ = VectorSubtract(VectorLoadAligned(&Targets.PosZ[TargetIndex]), ShooterZ);
+			const VectorRegister4Float VelX = VectorLoadAligned(&Targets.VelX[TargetIndex]);
+			const VectorRegister4Float VelY = VectorLoadAligned(&Targets.VelY[TargetIndex]);
+			const VectorRegister4Float VelZ = VectorLoadAligned(&Targets.VelZ[TargetIndex]);
+
+			const FArcLanes Low = SolveArcLanes<false>(RelX, RelY, RelZ, VelX, VelY, VelZ, Speed, SpeedSquared, Gravity, Params.Iterations);
+			const FArcLanes High = SolveArcLanes<true>(RelX, RelY, RelZ, VelX, VelY, VelZ, Speed, SpeedSquared, Gravity, Params.Iterations);
+
+			// Rows are a multiple of the SIMD width long, so every block stays aligned.
+			const int32 OutIndex = RowStart + TargetIndex;
+			VectorStoreAligned(Low.Yaw, &OutSolutions.LowYaw[OutIndex]);
+			VectorStoreAligned(Low.Pitch, &OutSolutions.LowPitch[OutIndex]);
+			VectorStoreAligned(Low.Time, &OutSolutions.LowTime[OutIndex]);
+			VectorStoreAligned(High.Yaw, &OutSolutions.HighYaw[OutIndex]);
+			VectorStoreAligned(High.Pitch, &OutSolutions.HighPitch[OutIndex]);
+			VectorStoreAligned(High.Time, &OutSolutions.HighTime[OutIndex]);
+		}
+	}
+}
+
+FFireControlSolution FFireControl::Solve(const FVector& ShooterLocation, const FVector& TargetLocation, const FVector& TargetVelocity,
+	const FFireControlParams& Params)
+{
+	const FVector3f Rel(TargetLocation - ShooterLocation);
+	const FVector3f Velocity(TargetVelocity);
+
+	FFireControlSolution Solution;
+	SolveArcScalar<false>(Rel, Velocity, Params, Solution.LowYaw, Solution.LowPitch, Solution.LowTime);
+	SolveArcScalar<true>(Rel, Velocity, Params, Solution.HighYaw, Solution.HighPitch, Solution.HighTime);
+	return Solution;
+}
+
+#if !UE_BUILD_SHIPPING
+namespace
+{
+	void RunFireControlBenchmark(const TArray<FString>& Args)
+	{
+		const int32 NumShooters = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 100;
+		const int32 NumTargets = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 100;
+		const int32 NumRuns = Args.Num() > 2 ? FMath::Max(FCString::Atoi(*Args[2]), 1) : 100;
+
+		// Tanks scattered over a 2 km square, targets driving at up to 15 m/s.
+		FRandomStream Random(0xF1C0);
+		const FFireControlParams Params;
+
+		TArray<FVector> Shooters;
+		Shooters.Reserve(NumShooters);
+
+		for (int32 ShooterIndex = 0; ShooterIndex < NumShooters; ++ShooterIndex)
+		{
+			Shooters.Emplace(Random.FRandRange(-100000.f, 100000.f), Random.FRandRange(-100000.f, 100000.f), Random.FRandRange(0.f, 2000.f));
+		}
+
+		TArray<FVector> TargetLocations;
+		TArray<FVector> TargetVelocities;
+		FFireControlTargets Targets;
+		Targets.Reset(NumTargets);
+
+		for (int32 TargetIndex = 0; TargetIndex < NumTargets; ++TargetIndex)
+		{
+			const FVector Location(Random.FRandRange(-100000.f, 100000.f), Random.FRandRange(-100000.f, 100000.f), Random.FRandRange(0.f, 2000.f));
+			const FVector Velocity = FVector(Random.GetUnitVector().GetSafeNormal2D()) * Random.FRandRange(0.f, 1500.f);
+
+			TargetLocations.Add(Location);
+			TargetVelocities.Add(Velocity);
+			Targets.Add(Location, Velocity);
+		}
+
+		FFireControlSolutions Solutions;
+		FFireControl::SolveBatch(Shooters, Targets, Params, Solutions);
+
+		double StartTime = FPlatformTime::Seconds();
+
+		for (int32 Run = 0; Run < NumRuns; ++Run)
+		{
+			FFireControl::SolveBatch(Shooters, Targets, Params, Solutions);
+		}
+
+		const double BatchSeconds = FPlatformTime::Seconds() - StartTime;
+
+		// The scalar path doubles as the reference the batch is checked against, on both arcs.
+		float MaxAngleError = 0.f;
+		float MaxTimeError = 0.f;
+		int32 NumMismatched = 0;
+		int32 NumInRange = 0;
+
+		const auto CompareArc = [&MaxAngleError, &MaxTimeError](float ScalarYaw, float ScalarPitch, float ScalarTime, float BatchedYaw,
+			float BatchedPitch, float BatchedTime)
+		{
+			MaxAngleError = FMath::Max3(MaxAngleError, FMath::Abs(FMath::FindDeltaAngleDegrees(ScalarYaw, BatchedYaw)),
+				FMath::Abs(ScalarPitch - BatchedPitch));
+			MaxTimeError = FMath::Max(MaxTimeError, FMath::Abs(ScalarTime - BatchedTime));
+		};
+		StartTime = FPlatformTime::Seconds();
+
+		for (int32 Run = 0; Run < NumRuns; ++Run)
+		{
+			for (int32 ShooterIndex = 0; ShooterIndex < NumShooters; ++ShooterIndex)
+			{
+				for (int32 TargetIndex = 0; TargetIndex < NumTargets; ++TargetIndex)
+				{
+					const FFireControlSolution Scalar = FFireControl::Solve(Shooters[ShooterIndex], TargetLocations[TargetIndex],
+						TargetVelocities[TargetIndex], Params);
+
+					if (Run > 0)
+					{
+						continue;
+					}
+
+					const FFireControlSolution Batched = Solutions.Get(ShooterIndex, TargetIndex);
+
+					if (Scalar.HasSolution() != Batched.HasSolution() || Scalar.HasHighSolution() != Batched.HasHighSolution())
+					{
+						++NumMismatched;
+						continue;
+					}
+
+					if (Scalar.HasSolution())
+					{
+						++NumInRange;
+						CompareArc(Scalar.LowYaw, Scalar.LowPitch, Scalar.LowTime, Batched.LowYaw, Batched.LowPitch, Batched.LowTime);
+					}
+
+					if (Scalar.HasHighSolution())
+					{
+						CompareArc(Scalar.HighYaw, Scalar.HighPitch, Scalar.HighTime, Batched.HighYaw, Batched.HighPitch, Batched.HighTime);
+					}
+				}
+			}
+		}
+
+		const double ScalarSeconds = FPlatformTime::Seconds() - StartTime;
+		const double NumPairs = static_cast<double>(NumShooters) * NumTargets * NumRuns;
+
+		UE_LOG(LogTankGame, Display, TEXT("Fire control benchmark: %dx%d pairs, %d runs. Batch %.1fM solutions/s, scalar %.1fM solutions/s (%.1fx)"),
+			NumShooters, NumTargets, NumRuns, NumPairs / BatchSeconds / 1.0e6, NumPairs / ScalarSeconds / 1.0e6, ScalarSeconds / BatchSeconds);
+		UE_LOG(LogTankGame, Display, TEXT("Fire control benchmark: %d pairs in range, %d range mismatches, max yaw/pitch difference %.4f deg, max flight time difference %.5f s (both arcs)"),
+			NumInRange, NumMismatched, MaxAngleError, MaxTimeError);
+	}
+
+	FAutoConsoleCommand FireControlBenchmarkCommand(
+		TEXT("TankGame.FireControl.Benchmark"),
+		TEXT("Solves random shooter and target pairs (default 100 shooters x 100 targets, 100 runs) with the batched and scalar fire-control solvers, logs solutions per second and checks they agree."),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunFireControlBenchmark));
+}
+#endif
@@ -3,11 +3,65 @@
 
 #include "Tank/Tank.h"
 
+#include "TankGame.h"
+#include "ChaosVehicleMovementComponent.h"
+#include "Combat/DamageSubsystem.h"
+#include "Combat/HealthComponent.h"
+#include "Effects/ImpactEffectSubsystem.h"
+#include "Input/InputLatencyTracker.h"
+#include "Shared/PawnSpatialHashSubsystem.h"
+#include "Particles/ParticleSystemComponent.h"
+#include "Tank/TankAudioComponent.h"
+#include "TimerManager.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Tank Flip Checks"), STAT_TankFlipChecks, STATGROUP_TankGame);
+
+namespace
+{
+	/** Upward velocity change given with a righting impulse, so the hull clears the ground while it rolls. */
+	constexpr float kRightingLiftSpeed = 300.f;
+}
+
 // Sets default values
 ATank::ATank()
 {
 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
+
+	HealthComponent = CreateDefaultSubobject<UHealthComponent>(TEXT("HealthComponent"));
+	HealthComponent->bShatterOnDeath = true;
+
+	AudioComponent = CreateDefaultSubobject<UTankAudioComponent>(TEXT("AudioComponent"));
+	AudioComponent->SetupAttachment(GetMesh());
+
+	// Flip checks only run while the body is awake.
+	GetMesh()->BodyInstance.bGenerateWakeEvents = true;
+}
+
+void ATank::BeginPlay()
+{
+	Super::BeginPlay();
+
+	GetMesh()->OnComponentWake.AddDynamic(this, &ATank::OnBodyWake);
+	GetMesh()->OnComponentSleep.AddDynamic(this, &ATank::OnBodySleep);
+
+	// Tick after the movement component so Tick sees the inputs it consumed this frame.
+	if (UChaosVehicleMovementComponent* VehicleMovement = GetVehicleMovementComponent())
+	{
+		AddTickPrerequisiteComponent(VehicleMovement);
+	}
+
+	if (GetMesh()->IsSimulatingPhysics() && GetMesh()->RigidBodyIsAwake())
+	{
+		OnBodyWake(GetMesh(), NAME_None);
+	}
+}
+
+void ATank::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	GetWorldTimerManager().ClearTimer(FlipCheckTimer);
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void ATank::GetTurretAngle(double InterpSpeed, double& Yaw)
@@ -24,6 +78,7 @@ void ATank::GunSightScreen()
 
 void ATank::VehicleFlip(bool& ReturnValue)
 {
+	ReturnValue = bIsFlipped;
 }
 
 void ATank::EnterTank()
@@ -34,10 +89,273 @@ void ATank::ExitTank()
 {
 }
 
+void ATank::EnterVehicle()
+{
+	EnterTank();
+}
+
+void ATank::ExitVehicle()
+{
+	ExitTank();
+}
+
+void ATank::SetThrottleInput(float Throttle)
+{
+	if (UChaosVehicleMovementComponent* VehicleMovement = GetVehicleMovementComponent())
+	{
+		// Chaos reverses on brake input once the tank has stopped.
+		VehicleMovement->SetThrottleInput(FMath::Max(Throttle, 0.f));
+		VehicleMovement->SetBrakeInput(FMath::Max(-Throttle, 0.f));
+	}
+}
+
+void ATank::SetSteeringInput(float Steering)
+{
+	if (UChaosVehicleMovementComponent* VehicleMovement = GetVehicleMovementComponent())
+	{
+		VehicleMovement->SetSteeringInput(Steering);
+	}
+}
+
+void ATank::SetHandbrakeInput(bool bHandbrake)
+{
+	if (UChaosVehicleMovementComponent* VehicleMovement = GetVehicleMovementComponent())
+	{
+		VehicleMovement->SetHandbrakeInput(bHandbrake);
+	}
+}
+
+void ATank::FirePrimary()
+{
+	FireGun();
+}
+
+FTransform ATank::GetExitTransform() const
+{
+	const FVector ExitLocation = ExitSpawnPoint ? ExitSpawnPoint->GetComponentLocation() : GetActorLocation() + GetActorRightVector() * 400.f;
+
+	return FTransform(FRotator(0.f, GetActorRotation().Yaw, 0.f), ExitLocation);
+}
+
+void ATank::FireGun()
+{
+	if (GunFire == nullptr)
+	{
+		return;
+	}
+
+	const FVector MuzzleLocation = GunFire->GetComponentLocation();
+	const FRotator MuzzleRotation = GunFire->GetComponentRotation();
+
+	UImpactEffectSubsystem* ImpactEffects = GetWorld()->GetSubsystem<UImpactEffectSubsystem>();
+
+	if (ImpactEffects)
+	{
+		ImpactEffects->SpawnEffect(EImpactEffectType::MuzzleFlash, SurfaceType_Default, MuzzleLocation, MuzzleRotation);
+	}
+
+	AudioComponent->PlayGunfire();
+
+	if (IsPlayerControlled())
+	{
+		FInputLatencyTracker::Get().End(EInputLatencyAction::TankFire);
+	}
+
+	FCollisionQueryParams TraceParams(FName(TEXT("ShellTrace")), false, this);
+	TraceParams.bReturnPhysicalMaterial = true;
+
+	FHitResult Hit;
+
+	if (GetWorld()->LineTraceSingleByChannel(Hit, MuzzleLocation, MuzzleLocation + MuzzleRotation.Vector() * ShellRange,
+		ECC_Visibility, TraceParams))
+	{
+		if (ImpactEffects)
+		{
+			ImpactEffects->SpawnEffectAtHit(EImpactEffectType::ShellImpact, Hit);
+		}
+
+		float Damage = ShellDamage;
+
+		if (const ATank* HitTank = Cast<ATank>(Hit.GetActor()))
+		{
+			Damage *= HitTank->ResolveShellHit(MuzzleLocation, MuzzleRotation.Vector(), ShellPenetration, ShellCaliber).DamageMultiplier;
+		}
+
+		if (UDamageSubsystem* DamageSubsystem = GetWorld()->GetSubsystem<UDamageSubsystem>())
+		{
+			DamageSubsystem->QueueDamage(Hit.GetActor(),	// Damaged Actor
+				Damage,										// Damage
+				EDamageKind::Shell,							// Damage kind
+				GetController(),							// Instigator (Controller)
+				this);										// Damage Causer (Actor)
+
+			ApplySplashDamage(Hit.ImpactPoint, Hit.GetActor(), DamageSubsystem);
+		}
+	}
+}
+
+void ATank::ApplySplashDamage(const FVector& ImpactPoint, const AActor* DirectHitActor, UDamageSubsystem* DamageSubsystem)
+{
+	const UPawnSpatialHashSubsystem* SpatialHash = GetWorld()->GetSubsystem<UPawnSpatialHashSubsystem>();
+
+	if (SpatialHash == nullptr || SplashRadius <= 0.f || SplashDamage <= 0.f)
+	{
+		return;
+	}
+
+	TArray<AActor*> SplashActors;
+	SpatialHash->QueryRadius(ImpactPoint, SplashRadius, SplashActors, DirectHitActor);
+
+	for (AActor* SplashActor : SplashActors)
+	{
+		// Never splash the firing tank, even when the shell lands at its own tracks.
+		if (SplashActor == this)
+		{
+			continue;
+		}
+
+		const float Falloff = 1.f - FVector::Dist(SplashActor->GetActorLocation(), ImpactPoint) / SplashRadius;
+
+		DamageSubsystem->QueueDamage(SplashActor,	// Damaged Actor
+			SplashDamage * Falloff,					// Damage
+			EDamageKind::Splash,					// Damage kind
+			GetController(),						// Instigator (Controller)
+			this);									// Damage Causer (Actor)
+	}
+}
+
+FArmorHitResult ATank::ResolveShellHit(const FVector& Origin, const FVector& Direction, float Penetration, float Caliber) const
+{
+	if (ArmorLayout == nullptr)
+	{
+		return FArmorHitResult();
+	}
+
+	const FTransform& TankTransform = GetActorTransform();
+
+	return ArmorLayout->ResolveShellHit(TankTransform.InverseTransformPositionNoScale(Origin),
+		TankTransform.InverseTransformVectorNoScale(Direction).GetSafeNormal(), Penetration, Caliber);
+}
+
+void ATank::OnBodyWake(UPrimitiveComponent* WakingComponent, FName BoneName)
+{
+	bBodyAwake = true;
+
+	if (bIsFlipped || GetActorUpVector().Z < FlipUpDot)
+	{
+		StartFlipChecks();
+	}
+}
+
+void ATank::OnBodySleep(UPrimitiveComponent* SleepingComponent, FName BoneName)
+{
+	bBodyAwake = false;
+
+	// One last check settles the state the body came to rest in, and stops the timer unless there is righting left to do.
+	CheckFlip();
+}
+
+void ATank::StartFlipChecks()
+{
+	if (!GetWorldTimerManager().IsTimerActive(FlipCheckTimer))
+	{
+		// Random first delay so tanks tipped together do not all check on the same frame.
+		GetWorldTimerManager().SetTimer(FlipCheckTimer, this, &ATank::CheckFlip, FlipCheckInterval, true,
+			FMath::FRandRange(0.f, FlipCheckInterval));
+	}
+}
+
+void ATank::CheckFlip()
+{
+	INC_DWORD_STAT(STAT_TankFlipChecks);
+
+	const USkeletalMeshComponent* Body = GetMesh();
+	const bool bAwake = Body->RigidBodyIsAwake();
+	const float UpZ = GetActorUpVector().Z;
+
+	if (!bIsFlipped)
+	{
+		if (UpZ < FlipUpDot && Body->GetPhysicsAngularVelocityInDegrees().Size() <= FlipMaxAngularSpeed)
+		{
+			TimeTilted += FlipCheckInterval;
+
+			// A body that went to sleep tilted is not going to roll back on its own.
+			if (TimeTilted >= FlipConfirmTime || !bAwake)
+			{
+				SetFlipped(true);
+			}
+		}
+		else
+		{
+			TimeTilted = 0.f;
+		}
+	}
+	else if (UpZ > RecoverUpDot)
+	{
+		TimeTilted = 0.f;
+		SetFlipped(false);
+	}
+
+	if (bIsFlipped && bAutoRight)
+	{
+		ApplyRightingImpulse();
+	}
+	else if (!bAwake || (!bIsFlipped && UpZ >= FlipUpDot))
+	{
+		// Upright again, or at rest: Tick restarts the checks if the tank tips past FlipUpDot.
+		GetWorldTimerManager().ClearTimer(FlipCheckTimer);
+	}
+}
+
+void ATank::SetFlipped(bool bFlipped)
+{
+	if (bIsFlipped != bFlipped)
+	{
+		bIsFlipped = bFlipped;
+		OnFlipStateChanged.Broadcast(this, bIsFlipped);
+	}
+}
+
+void ATank::ApplyRightingImpulse()
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	if (Now - LastRightingTime < RightingCooldown)
+	{
+		return;
+	}
+
+	LastRightingTime = Now;
+
+	// Roll about the axis that brings the hull's up vector back toward world up; a tank on its roof rolls sideways.
+	FVector Axis = FVector::CrossProduct(GetActorUpVector(), FVector::UpVector);
+
+	if (!Axis.Normalize())
+	{
+		Axis = GetActorForwardVector();
+	}
+
+	// Impulses rather than a teleport, so the solver resolves contacts as the tank rolls over.
+	USkeletalMeshComponent* Body = GetMesh();
+	Body->AddImpulse(FVector::UpVector * kRightingLiftSpeed, NAME_None, true);
+	Body->AddAngularImpulseInDegrees(Axis * RightingAngularSpeed, NAME_None, true);
+}
+
 // Called every frame
 void ATank::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
+	// Upright tanks only pay for this comparison; the flip timer starts once the hull tips past FlipUpDot.
+	if (bBodyAwake && GetActorUpVector().Z < FlipUpDot)
+	{
+		StartFlipChecks();
+	}
+
+	if (IsPlayerControlled())
+	{
+		FInputLatencyTracker::Get().End(EInputLatencyAction::TankThrottle);
+	}
+
 	// StopTurn = SkeletalMesh->GetPhysicsAngularVelocityInDegrees().Length();
 }
\ No newline at end of file
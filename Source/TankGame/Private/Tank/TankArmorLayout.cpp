@@ -0,0 +1,216 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+
+#include "Tank/TankArmorLayout.h"
+
+#include "TankGame.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/UObjectIterator.h"
+
+namespace
+{
+	constexpr float kMaxArmorRayDistance = 100000.f;
+
+	/** Distance at which a ray enters Box, or a negative value if it misses within MaxDistance. */
+	double IntersectModule(const FBox& Box, const FVector& Origin, const FVector& Direction, double MaxDistance)
+	{
+		double Enter = 0.0;
+		double Exit = MaxDistance;
+
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			if (FMath::IsNearlyZero(Direction[Axis]))
+			{
+				if (Origin[Axis] < Box.Min[Axis] || Origin[Axis] > Box.Max[Axis])
+				{
+					return -1.0;
+				}
+
+				continue;
+			}
+
+			const double InvDirection = 1.0 / Direction[Axis];
+			double T0 = (Box.Min[Axis] - Origin[Axis]) * InvDirection;
+			double T1 = (Box.Max[Axis] - Origin[Axis]) * InvDirection;
+
+			if (T0 > T1)
+			{
+				Swap(T0, T1);
+			}
+
+			Enter = FMath::Max(Enter, T0);
+			Exit = FMath::Min(Exit, T1);
+
+			if (Enter > Exit)
+			{
+				return -1.0;
+			}
+		}
+
+		return Enter;
+	}
+}
+
+void UTankArmorLayout::PostLoad()
+{
+	Super::PostLoad();
+
+	RebuildBVH();
+}
+
+#if WITH_EDITOR
+void UTankArmorLayout::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	RebuildBVH();
+}
+#endif
+
+void UTankArmorLayout::RebuildBVH()
+{
+	TArray<FArmorPlatePrimitive> Primitives;
+	Primitives.Reserve(Plates.Num());
+
+	for (int32 PlateIndex = 0; PlateIndex < Plates.Num(); ++PlateIndex)
+	{
+		const FArmorPlate& Plate = Plates[PlateIndex];
+		const FQuat PlateRotation = Plate.Rotation.Quaternion();
+
+		FArmorPlatePrimitive& Primitive = Primitives.AddDefaulted_GetRef();
+		Primitive.Center = FVector3f(Plate.Center);
+		Primitive.AxisX = FVector3f(PlateRotation.GetAxisX());
+		Primitive.AxisY = FVector3f(PlateRotation.GetAxisY());
+		Primitive.AxisZ = FVector3f(PlateRotation.GetAxisZ());
+		// Thickness is authored in mm, plate geometry in cm.
+		Primitive.HalfExtent = FVector3f(Plate.Size.X * 0.5f, Plate.Size.Y * 0.5f, FMath::Max(Plate.Thickness * 0.05f, 0.1f));
+		Primitive.PlateIndex = PlateIndex;
+	}
+
+	BVH.Build(MoveTemp(Primitives));
+}
+
+FArmorHitResult UTankArmorLayout::ResolveShellHit(const FVector& Origin, const FVector& Direction, float Penetration, float Caliber) const
+{
+	FArmorHitResult Result;
+	FArmorRayHit RayHit;
+
+	if (!BVH.Raycast(FVector3f(Origin), FVector3f(Direction), kMaxArmorRayDistance, RayHit))
+	{
+		return Result;
+	}
+
+	const FArmorPlate& Plate = Plates[RayHit.PlateIndex];
+	const FVector PlateNormal = Plate.Rotation.RotateVector(FVector::UpVector);
+	const double CosAngle = FMath::Clamp(FMath::Abs(Direction | PlateNormal), UE_KINDA_SMALL_NUMBER, 1.0);
+
+	Result.PlateIndex = RayHit.PlateIndex;
+	Result.ImpactAngle = FMath::RadiansToDegrees(FMath::Acos(CosAngle));
+	Result.EffectiveThickness = Plate.Thickness / CosAngle;
+
+	const bool bOvermatch = Caliber >= Plate.Thickness * OvermatchRatio;
+
+	if (!bOvermatch && Result.ImpactAngle > RicochetAngle)
+	{
+		Result.Outcome = EArmorHitOutcome::Ricochet;
+		Result.DamageMultiplier = 0.f;
+		return Result;
+	}
+
+	if (Penetration < Result.EffectiveThickness)
+	{
+		Result.Outcome = EArmorHitOutcome::NonPenetration;
+		Result.DamageMultiplier = NonPenetrationDamageMultiplier;
+		return Result;
+	}
+
+	Result.Outcome = EArmorHitOutcome::Penetration;
+
+	// Modules are few per archetype, so a linear pass over the post-penetration segment is cheaper than a second tree.
+	const FVector PenetrationPoint = Origin + Direction * RayHit.Distance;
+	double ClosestModuleDistance = PostPenetrationDistance;
+
+	for (const FArmorModuleVolume& Module : Modules)
+	{
+		const double Distance = IntersectModule(FBox(Module.Center - Module.Extent, Module.Center + Module.Extent),
+			PenetrationPoint, Direction, ClosestModuleDistance);
+
+		if (Distance >= 0.0 && Distance <= ClosestModuleDistance)
+		{
+			ClosestModuleDistance = Distance;
+			Result.Module = Module.Module;
+			Result.DamageMultiplier = Module.DamageMultiplier;
+		}
+	}
+
+	return Result;
+}
+
+#if !UE_BUILD_SHIPPING
+namespace
+{
+	void RunArmorBenchmark(const TArray<FString>& Args)
+	{
+		const int32 NumShells = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 100000;
+		int32 NumLayouts = 0;
+
+		for (TObjectIterator<UTankArmorLayout> It; It; ++It)
+		{
+			const UTankArmorLayout* Layout = *It;
+
+			if (!Layout->GetBVH().IsBuilt())
+			{
+				continue;
+			}
+
+			++NumLayouts;
+
+			// Aim random shells from outside the armor at random points inside it.
+			const FBox3f Bounds = Layout->GetBVH().GetBounds();
+			const float StandOff = Bounds.GetExtent().Size() * 2.f;
+			FRandomStream Random(0x7A4C);
+
+			TArray<FVector> Origins;
+			TArray<FVector> Directions;
+			Origins.Reserve(NumShells);
+			Directions.Reserve(NumShells);
+
+			for (int32 ShellIndex = 0; ShellIndex < NumShells; ++ShellIndex)
+			{
+				const FVector Target(FMath::Lerp(Bounds.Min.X, Bounds.Max.X, Random.FRand()),
+					FMath::Lerp(Bounds.Min.Y, Bounds.Max.Y, Random.FRand()),
+					FMath::Lerp(Bounds.Min.Z, Bounds.Max.Z, Random.FRand()));
+				const FVector Direction = Random.GetUnitVector();
+
+				Origins.Add(Target - Direction * StandOff);
+				Directions.Add(Direction);
+			}
+
+			int32 OutcomeCounts[4] = {};
+			const double StartTime = FPlatformTime::Seconds();
+
+			for (int32 ShellIndex = 0; ShellIndex < NumShells; ++ShellIndex)
+			{
+				const FArmorHitResult Result = Layout->ResolveShellHit(Origins[ShellIndex], Directions[ShellIndex], 150.f, 90.f);
+				++OutcomeCounts[static_cast<int32>(Result.Outcome)];
+			}
+
+			const double Elapsed = FPlatformTime::Seconds() - StartTime;
+
+			UE_LOG(LogTankGame, Display, TEXT("Armor benchmark %s: %d plates, %d shells in %.3f ms (%.0f hits/s, %llu bytes). Unarmored %d, ricochet %d, non-pen %d, pen %d"),
+				*Layout->GetName(), Layout->Plates.Num(), NumShells, Elapsed * 1000.0, NumShells / FMath::Max(Elapsed, UE_SMALL_NUMBER),
+				static_cast<uint64>(Layout->GetBVH().GetAllocatedSize()), OutcomeCounts[0], OutcomeCounts[1], OutcomeCounts[2], OutcomeCounts[3]);
+		}
+
+		if (NumLayouts == 0)
+		{
+			UE_LOG(LogTankGame, Warning, TEXT("Armor benchmark: no tank armor layout with plates is loaded"));
+		}
+	}
+
+	FAutoConsoleCommand ArmorBenchmarkCommand(
+		TEXT("TankGame.Armor.Benchmark"),
+		TEXT("Resolves N random shell hits (default 100000) against every loaded tank armor layout and logs hits per second."),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunArmorBenchmark));
+}
+#endif
@@ -0,0 +1,211 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+
+#include "Tank/TankAudioComponent.h"
+
+#include "ChaosWheeledVehicleMovementComponent.h"
+#include "Components/AudioComponent.h"
+#include "Kismet/GameplayStatics.h"
+#include "Tank/Tank.h"
+#include "Tank/TankAudioSubsystem.h"
+#include "Tank/TankWheel.h"
+
+namespace
+{
+	constexpr float kLoopFadeSeconds = 0.25f;
+	constexpr float kMinTraverseRate = 1.f;
+	constexpr float kRecentGunfireSeconds = 2.f;
+}
+
+UTankAudioComponent::UTankAudioComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+void UTankAudioComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	EngineLoop = CreateLoop(EngineSound, TEXT("EngineLoop"));
+	TrackLoop = CreateLoop(TrackSound, TEXT("TrackLoop"));
+	TraverseLoop = CreateLoop(TraverseSound, TEXT("TraverseLoop"));
+
+	if (const ATank* Tank = Cast<ATank>(GetOwner()))
+	{
+		PreviousTurretAngle = Tank->TurretAngle;
+	}
+
+	if (UTankAudioSubsystem* TankAudio = GetWorld()->GetSubsystem<UTankAudioSubsystem>())
+	{
+		TankAudio->RegisterTank(this);
+	}
+}
+
+void UTankAudioComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UTankAudioSubsystem* TankAudio = GetWorld()->GetSubsystem<UTankAudioSubsystem>())
+	{
+		TankAudio->UnregisterTank(this);
+	}
+
+	SetVoiced(false);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+UAudioComponent* UTankAudioComponent::CreateLoop(USoundBase* Sound, const TCHAR* Name)
+{
+	if (Sound == nullptr)
+	{
+		return nullptr;
+	}
+
+	UAudioComponent* Loop = NewObject<UAudioComponent>(GetOwner(), Name);
+	Loop->bAutoActivate = false;
+	Loop->bAutoDestroy = false;
+	Loop->SetSound(Sound);
+
+	if (LoopConcurrency)
+	{
+		Loop->ConcurrencySet.Add(LoopConcurrency);
+	}
+
+	Loop->SetupAttachment(this);
+	Loop->RegisterComponent();
+
+	return Loop;
+}
+
+void UTankAudioComponent::SetVoiced(bool bInVoiced)
+{
+	if (bVoiced == bInVoiced)
+	{
+		return;
+	}
+
+	bVoiced = bInVoiced;
+
+	for (UAudioComponent* Loop : { EngineLoop.Get(), TrackLoop.Get(), TraverseLoop.Get() })
+	{
+		if (Loop == nullptr)
+		{
+			continue;
+		}
+
+		if (!bVoiced)
+		{
+			Loop->FadeOut(kLoopFadeSeconds, 0.f);
+		}
+		else if (Loop != TraverseLoop || TraverseRate >= kMinTraverseRate)
+		{
+			Loop->FadeIn(kLoopFadeSeconds);
+		}
+	}
+
+	if (bVoiced)
+	{
+		// Push the parameters tracked while virtualized so the loops resume at the right pitch.
+		UpdateParameters(0.f);
+	}
+}
+
+void UTankAudioComponent::UpdateParameters(float DeltaTime)
+{
+	const ATank* Tank = Cast<ATank>(GetOwner());
+
+	if (Tank == nullptr)
+	{
+		return;
+	}
+
+	if (const UChaosWheeledVehicleMovementComponent* Movement = Cast<UChaosWheeledVehicleMovementComponent>(Tank->GetVehicleMovementComponent()))
+	{
+		EngineRPM = Movement->GetEngineRotationSpeed();
+		TrackSpeed = FMath::Abs(Movement->GetForwardSpeed());
+
+		if (const UTankWheel* Wheel = Movement->Wheels.Num() > 0 ? Cast<UTankWheel>(Movement->Wheels[0]) : nullptr)
+		{
+			const FCachedSurface Surface = Wheel->GetCachedSurface();
+
+			if (Surface.bValid)
+			{
+				TrackSurface = Surface.SurfaceType;
+			}
+		}
+	}
+
+	if (DeltaTime > 0.f)
+	{
+		TraverseRate = FMath::Abs(FMath::FindDeltaAngleDegrees(PreviousTurretAngle, Tank->TurretAngle)) / DeltaTime;
+		PreviousTurretAngle = Tank->TurretAngle;
+	}
+
+	if (!bVoiced)
+	{
+		return;
+	}
+
+	if (EngineLoop)
+	{
+		EngineLoop->SetFloatParameter(RPMParameter, EngineRPM);
+	}
+
+	if (TrackLoop)
+	{
+		TrackLoop->SetFloatParameter(TrackSpeedParameter, TrackSpeed);
+		TrackLoop->SetIntParameter(TrackSurfaceParameter, TrackSurface);
+	}
+
+	if (TraverseLoop)
+	{
+		// The traverse loop only holds a voice while the turret is actually turning.
+		const bool bTraversing = TraverseRate >= kMinTraverseRate;
+
+		if (bTraversing && !TraverseLoop->IsPlaying())
+		{
+			TraverseLoop->FadeIn(kLoopFadeSeconds);
+		}
+		else if (!bTraversing && TraverseLoop->IsPlaying())
+		{
+			TraverseLoop->FadeOut(kLoopFadeSeconds, 0.f);
+		}
+
+		TraverseLoop->SetFloatParameter(TraverseRateParameter, TraverseRate);
+	}
+}
+
+float UTankAudioComponent::GetPriority() const
+{
+	float Priority = BasePriority;
+
+	if (const APawn* Tank = Cast<APawn>(GetOwner()); Tank && Tank->GetController())
+	{
+		Priority *= 4.f;
+	}
+
+	if (GetWorld()->GetTimeSeconds() - LastGunfireTime <= kRecentGunfireSeconds)
+	{
+		Priority *= 2.f;
+	}
+
+	return Priority;
+}
+
+void UTankAudioComponent::PlayGunfire()
+{
+	LastGunfireTime = GetWorld()->GetTimeSeconds();
+
+	if (GunfireSound == nullptr)
+	{
+		return;
+	}
+
+	if (const UTankAudioSubsystem* TankAudio = GetWorld()->GetSubsystem<UTankAudioSubsystem>();
+		TankAudio && TankAudio->GetListenerDistance(GetComponentLocation()) > MaxAudibleDistance)
+	{
+		return;
+	}
+
+	UGameplayStatics::SpawnSoundAttached(GunfireSound, this, NAME_None, FVector::ZeroVector, EAttachLocation::KeepRelativeOffset, true,
+		1.f, 1.f, 0.f, nullptr, GunfireConcurrency);
+}
@@ -0,0 +1,200 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+
+#include "Tank/TankAudioSubsystem.h"
+
+#include "TankGame.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "Tank/TankAudioComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("Tank Audio"), STAT_TankAudio, STATGROUP_TankGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Tank Audio Voiced"), STAT_TankAudioVoiced, STATGROUP_TankGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Tank Audio Virtualized"), STAT_TankAudioVirtualized, STATGROUP_TankGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Tank Audio Parameter Updates"), STAT_TankAudioParameterUpdates, STATGROUP_TankGame);
+
+namespace
+{
+	TAutoConsoleVariable<int32> CVarTankAudioMaxVoicedTanks(
+		TEXT("tg.TankAudio.MaxVoicedTanks"),
+		8,
+		TEXT("Maximum number of tanks playing engine, track and traverse loops at once."));
+
+	TAutoConsoleVariable<float> CVarTankAudioNearDistance(
+		TEXT("tg.TankAudio.NearDistance"),
+		3000.f,
+		TEXT("Voiced tanks within this distance of a listener update their audio parameters every frame."));
+
+	TAutoConsoleVariable<int32> CVarTankAudioFarUpdateInterval(
+		TEXT("tg.TankAudio.FarUpdateInterval"),
+		4,
+		TEXT("Frames between audio parameter updates for tanks beyond NearDistance or virtualized."));
+
+	constexpr double kMinScoreDistance = 100.0;
+}
+
+bool UTankAudioSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UTankAudioSubsystem::Deinitialize()
+{
+	Entries.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId UTankAudioSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UTankAudioSubsystem, STATGROUP_Tickables);
+}
+
+void UTankAudioSubsystem::RegisterTank(UTankAudioComponent* TankAudio)
+{
+	FTankAudioEntry& Entry = Entries.AddDefaulted_GetRef();
+	Entry.Component = TankAudio;
+}
+
+void UTankAudioSubsystem::UnregisterTank(UTankAudioComponent* TankAudio)
+{
+	Entries.RemoveAllSwap([TankAudio](const FTankAudioEntry& Entry) { return Entry.Component == TankAudio; }, EAllowShrinking::No);
+}
+
+void UTankAudioSubsystem::GatherListeners()
+{
+	Listeners.Reset();
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+
+		if (PlayerController && PlayerController->IsLocalController())
+		{
+			FVector Location;
+			FVector FrontDirection;
+			FVector RightDirection;
+			PlayerController->GetAudioListenerPosition(Location, FrontDirection, RightDirection);
+
+			Listeners.Add(Location);
+		}
+	}
+}
+
+double UTankAudioSubsystem::GetListenerDistance(const FVector& Location) const
+{
+	double ClosestDistanceSquared = UE_BIG_NUMBER;
+
+	for (const FVector& Listener : Listeners)
+	{
+		ClosestDistanceSquared = FMath::Min(ClosestDistanceSquared, FVector::DistSquared(Listener, Location));
+	}
+
+	return Listeners.Num() > 0 ? FMath::Sqrt(ClosestDistanceSquared) : UE_BIG_NUMBER;
+}
+
+void UTankAudioSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_TankAudio);
+
+	Super::Tick(DeltaTime);
+
+	++FrameCounter;
+
+	GatherListeners();
+
+	Entries.RemoveAllSwap([](const FTankAudioEntry& Entry) { return !Entry.Component.IsValid(); }, EAllowShrinking::No);
+
+	RankedEntries.Reset();
+
+	for (int32 EntryIndex = 0; EntryIndex < Entries.Num(); ++EntryIndex)
+	{
+		FTankAudioEntry& Entry = Entries[EntryIndex];
+		const UTankAudioComponent* Component = Entry.Component.Get();
+
+		Entry.Distance = GetListenerDistance(Component->GetComponentLocation());
+		Entry.Score = Component->GetPriority() / FMath::Max(Entry.Distance, kMinScoreDistance);
+
+		if (Entry.Distance <= Component->MaxAudibleDistance)
+		{
+			RankedEntries.Add(EntryIndex);
+		}
+	}
+
+	const int32 MaxVoiced = FMath::Max(CVarTankAudioMaxVoicedTanks.GetValueOnGameThread(), 0);
+
+	if (RankedEntries.Num() > MaxVoiced)
+	{
+		RankedEntries.Sort([this](int32 A, int32 B) { return Entries[A].Score > Entries[B].Score; });
+		RankedEntries.SetNum(MaxVoiced, EAllowShrinking::No);
+	}
+
+	for (FTankAudioEntry& Entry : Entries)
+	{
+		Entry.bShouldVoice = false;
+	}
+
+	for (const int32 EntryIndex : RankedEntries)
+	{
+		Entries[EntryIndex].bShouldVoice = true;
+	}
+
+	// Virtualize first so voices are released before new ones are requested.
+	for (FTankAudioEntry& Entry : Entries)
+	{
+		if (!Entry.bShouldVoice)
+		{
+			Entry.Component->SetVoiced(false);
+		}
+	}
+
+	for (const int32 EntryIndex : RankedEntries)
+	{
+		Entries[EntryIndex].Component->SetVoiced(true);
+	}
+
+	const double NearDistance = CVarTankAudioNearDistance.GetValueOnGameThread();
+	const uint32 FarUpdateInterval = FMath::Max(CVarTankAudioFarUpdateInterval.GetValueOnGameThread(), 1);
+
+	int32 NumUpdates = 0;
+
+	for (int32 EntryIndex = 0; EntryIndex < Entries.Num(); ++EntryIndex)
+	{
+		FTankAudioEntry& Entry = Entries[EntryIndex];
+		UTankAudioComponent* Component = Entry.Component.Get();
+
+		Entry.TimeSinceUpdate += DeltaTime;
+
+		const bool bNear = Component->IsVoiced() && Entry.Distance <= NearDistance;
+
+		if (bNear || (FrameCounter + EntryIndex) % FarUpdateInterval == 0)
+		{
+			Component->UpdateParameters(Entry.TimeSinceUpdate);
+			Entry.TimeSinceUpdate = 0.f;
+			++NumUpdates;
+		}
+	}
+
+	SET_DWORD_STAT(STAT_TankAudioVoiced, RankedEntries.Num());
+	SET_DWORD_STAT(STAT_TankAudioVirtualized, Entries.Num() - RankedEntries.Num());
+	SET_DWORD_STAT(STAT_TankAudioParameterUpdates, NumUpdates);
+}
+
+#if !UE_BUILD_SHIPPING
+namespace
+{
+	FAutoConsoleCommandWithWorldAndArgs TankAudioProfileCommand(
+		TEXT("TankGame.TankAudio.Profile"),
+		TEXT("Toggles the TankGame and AudioMixer stat groups, showing tank voice budgeting next to the audio render thread cost. Run alongside the benchmark scenarios."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (GEngine)
+			{
+				GEngine->Exec(World, TEXT("stat TankGame"));
+				GEngine->Exec(World, TEXT("stat AudioMixer"));
+			}
+		}));
+}
+#endif
@@ -3,6 +3,8 @@
 
 #include "Tank/TankWheel.h"
 
+#include "ChaosWheeledVehicleMovementComponent.h"
+
 UTankWheel::UTankWheel()
 {
 	WheelWidth = 40.f;
@@ -16,4 +18,22 @@ UTankWheel::UTankWheel()
 	SuspensionMaxDrop = 5.f;
 	SpringRate = 5000.f;
 	SuspensionSmoothing = 1.f;
-}
\ No newline at end of file
+}
+
+FCachedSurface UTankWheel::GetCachedSurface() const
+{
+	if (VehicleComponent == nullptr)
+	{
+		return FCachedSurface();
+	}
+
+	const FWheelStatus& WheelState = VehicleComponent->GetWheelState(WheelIndex);
+	const USurfaceCacheSubsystem* SurfaceCache = VehicleComponent->GetWorld()->GetSubsystem<USurfaceCacheSubsystem>();
+
+	if (!WheelState.bInContact || SurfaceCache == nullptr)
+	{
+		return FCachedSurface();
+	}
+
+	return SurfaceCache->SampleSurface(WheelState.ContactPoint);
+}
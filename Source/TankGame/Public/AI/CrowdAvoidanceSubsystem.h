@@ -0,0 +1,81 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AI/CrowdSolver.h"
+#include "Shared/GameplayJobSubsystem.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CrowdAvoidanceSubsystem.generated.h"
+
+class AMainCharacter;
+class UMainCharacterMovementComponent;
+
+/**
+ * Crowd avoidance for NPCs built on AMainCharacter, run as a gameplay job.
+ *
+ * NPCs moving under path following are gathered with their preferred velocity, sorted into a neighbour grid and
+ * solved with FCrowdSolver on worker threads; the result steers their next path following request. Player
+ * characters take part as obstacles only. NPCs closing in on a player pawn are given one of tg.Crowd.SurroundSlots
+ * evenly spaced slots around it, just outside the target's collision, so attackers spread out around their target
+ * rather than queueing up behind each other. Attackers beyond the slot count wait on an outer ring. A slot is held,
+ * moving or not, until its owner dies, leaves the engage distance or heads for another target. An attacker on the
+ * last leg of its path heads straight for its slot; until then the subsystem never issues moves of its own, so the
+ * behaviour driving the NPC should path to GetSurroundSlot's location to route around obstacles.
+ */
+UCLASS()
+class TANKGAME_API UCrowdAvoidanceSubsystem : public UWorldSubsystem, public IGameplayJob
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	virtual int32 GatherJob(float DeltaTime) override;
+	virtual void ComputeJob(int32 Index) override;
+	virtual void ApplyJob() override;
+
+	void RegisterCharacter(AMainCharacter* Character);
+	void UnregisterCharacter(AMainCharacter* Character);
+
+	/** Location of Attacker's slot around its target, for its behaviour to move to. Returns false if it holds no surround slot. */
+	UFUNCTION(BlueprintPure, Category = Crowd)
+	bool GetSurroundSlot(const AMainCharacter* Attacker, FVector& OutLocation) const;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	struct FSurroundRing
+	{
+		TWeakObjectPtr<AActor> Target;
+		/** One entry per slot, null while the slot is free. Slot N sits at angle N * 360 / slot count around Target. */
+		TArray<TWeakObjectPtr<AMainCharacter>, TInlineAllocator<8>> SlotOwners;
+	};
+
+	struct FAttacker
+	{
+		int32 AgentIndex = INDEX_NONE;
+		int32 RingIndex = INDEX_NONE;
+		/** True if nothing but the goal is left on the attacker's path, so steering straight at a point near it is safe. */
+		bool bOnFinalLeg = true;
+	};
+
+	/** Points attackers at their slot, assigning free slots to newcomers closest to their current bearing. */
+	void AssignSurroundSlots(const TArray<FAttacker>& Attackers);
+
+	static FVector GetSlotLocation(const AActor* Target, int32 Slot, int32 NumSlots, float Radius);
+
+	/** Distance from Target's center at which an attacker of AttackerRadius stands just clear of its collision. */
+	static float GetSlotRadius(const AActor* Target, float AttackerRadius);
+
+	TArray<TWeakObjectPtr<AMainCharacter>> Characters;
+
+	/** Movement components of the agents gathered this frame, indexed like Solver.Agents. */
+	TArray<UMainCharacterMovementComponent*> GatheredMovements;
+
+	TArray<FSurroundRing> Rings;
+
+	FCrowdSolver Solver;
+};
@@ -0,0 +1,71 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FCrowdAgent
+{
+	FVector2D Position = FVector2D::ZeroVector;
+	FVector2D Velocity = FVector2D::ZeroVector;
+	FVector2D PreferredVelocity = FVector2D::ZeroVector;
+	float Radius = 40.f;
+	float MaxSpeed = 400.f;
+	/** Agents that are not solved still act as obstacles, but are not expected to move out of the way. */
+	bool bSolve = true;
+};
+
+struct FCrowdSolverParams
+{
+	/** Only agents closer than this are considered. Also the neighbour grid's cell size. */
+	float NeighbourRadius = 400.f;
+	/** Closest neighbours considered per agent. */
+	int32 MaxNeighbours = 8;
+	/** Collisions further ahead than this are not penalised. */
+	float TimeHorizon = 2.5f;
+	float DesiredVelocityWeight = 2.f;
+	float CurrentVelocityWeight = 0.75f;
+	float ImpactWeight = 2.5f;
+};
+
+/**
+ * Reciprocal velocity obstacle avoidance in the style of Detour crowd's velocity sampling.
+ *
+ * Each solved agent scores a fixed set of candidate velocities around its preferred one by how far they deviate
+ * from the preferred and current velocity and how soon they would collide with its neighbours, assuming other
+ * solved agents take half the responsibility for avoiding it. Free of UObjects; after BuildGrid, SolveAgent can
+ * run for different agents on any number of threads at once.
+ */
+class TANKGAME_API FCrowdSolver
+{
+public:
+	FCrowdSolverParams Params;
+	TArray<FCrowdAgent> Agents;
+
+	/** Written by SolveAgent, indexed like Agents. Unsolved agents keep their current velocity. */
+	TArray<FVector2D> SolvedVelocities;
+
+	/** Sorts Agents into the neighbour grid. Call after filling Agents and before solving. */
+	void BuildGrid();
+
+	void SolveAgent(int32 AgentIndex);
+
+private:
+	using FNeighbourList = TArray<int32, TInlineAllocator<16>>;
+
+	void FindNeighbours(int32 AgentIndex, FNeighbourList& OutNeighbours) const;
+
+	/** Earliest time at which a velocity of Candidate makes the agent touch one of its neighbours, capped at the horizon. */
+	float GetTimeToImpact(const FCrowdAgent& Agent, const FVector2D& Candidate, const FNeighbourList& Neighbours) const;
+
+	FIntPoint GetCell(const FVector2D& Position) const;
+
+	/** Cell -> index into CellStarts. */
+	TMap<FIntPoint, int32> CellLookup;
+
+	/** Agents of cell C are SortedAgents[CellStarts[C], CellStarts[C + 1]). */
+	TArray<int32> CellStarts;
+	TArray<int32> SortedAgents;
+
+	float InvCellSize = 1.f / 400.f;
+};
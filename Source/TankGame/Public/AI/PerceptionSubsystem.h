@@ -0,0 +1,134 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Shared/GameplayJobSubsystem.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+#include "UObject/ObjectKey.h"
+#include "PerceptionSubsystem.generated.h"
+
+/**
+ * Time-sliced line-of-sight for NPCs against player pawns, on foot or in a tank.
+ *
+ * Each registered perceiver keeps a cached sight result per player pawn. Every frame, as a gameplay job, the stale
+ * results are scored by age, distance and whether the perceiver is in combat on worker threads, each of which also
+ * keeps the top tg.Perception.QueryBudget of its chunk of perceivers. The game thread merges those and refreshes the
+ * overall top QueryBudget, as async line traces whose results arrive on a later frame. The trace cost per frame is
+ * therefore fixed no matter how many NPCs exist. Results older than tg.Perception.MaxAge read as not visible.
+ */
+UCLASS()
+class TANKGAME_API UPerceptionSubsystem : public UWorldSubsystem, public IGameplayJob
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	virtual int32 GatherJob(float DeltaTime) override;
+	virtual void ComputeJob(int32 Index) override;
+	virtual void ApplyJob() override;
+	/** Each compute item is already a chunk of perceivers, so every chunk is its own batch. */
+	virtual int32 GetItemsPerBatch() const override { return 1; }
+
+	void RegisterPerceiver(APawn* Perceiver);
+	void UnregisterPerceiver(APawn* Perceiver);
+
+	/** Cached line of sight from Perceiver to Target. False if not visible, unknown or older than the staleness limit. */
+	UFUNCTION(BlueprintPure, Category = Perception)
+	bool HasLineOfSight(const APawn* Perceiver, const AActor* Target) const;
+
+	/** Cached sight result and its age in seconds. Returns false if Target has never been checked for Perceiver. */
+	bool GetSightResult(const APawn* Perceiver, const AActor* Target, bool& bOutVisible, float& OutAge) const;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	struct FSightResult
+	{
+		TWeakObjectPtr<AActor> Target;
+		double CheckTime = -UE_BIG_NUMBER;
+		bool bVisible = false;
+		bool bPending = false;
+	};
+
+	struct FPerceiver
+	{
+		TWeakObjectPtr<APawn> Pawn;
+		FObjectKey Key;
+		TArray<FSightResult, TInlineAllocator<2>> Results;
+	};
+
+	struct FPendingQuery
+	{
+		FObjectKey Perceiver;
+		FObjectKey Target;
+	};
+
+	struct FQueryCandidate
+	{
+		float Priority = 0.f;
+		int32 PerceiverIndex = INDEX_NONE;
+		int32 ResultIndex = INDEX_NONE;
+	};
+
+	/** A perceiver as gathered for scoring. Its results are ScoringResults[FirstResult, FirstResult + NumResults). */
+	struct FScoringPerceiver
+	{
+		FVector Location = FVector::ZeroVector;
+		float ThreatScale = 1.f;
+		int32 FirstResult = 0;
+		int32 NumResults = 0;
+	};
+
+	struct FScoringResult
+	{
+		FVector TargetLocation = FVector::ZeroVector;
+		double CheckTime = 0.0;
+		bool bSkip = false;
+
+		/** Written by ComputeJob. */
+		bool bOutOfRange = false;
+	};
+
+	/** Written by ComputeJob for one chunk of perceivers. */
+	struct FScoringChunk
+	{
+		/** Min-heap of the chunk's highest priority candidates. */
+		TArray<FQueryCandidate> Candidates;
+		int32 QueueDepth = 0;
+	};
+
+	void PushCandidate(TArray<FQueryCandidate>& Heap, const FQueryCandidate& Candidate) const;
+	void RefreshTargets(const TArray<AActor*, TInlineAllocator<4>>& Targets);
+	void IssueQuery(FPerceiver& Perceiver, FSightResult& Result);
+	void RemovePerceiverAt(int32 PerceiverIndex);
+
+	void OnTraceCompleted(const FTraceHandle& Handle, FTraceDatum& Datum);
+
+	const FSightResult* FindResult(const APawn* Perceiver, const AActor* Target) const;
+
+	TArray<FPerceiver> Perceivers;
+	TMap<FObjectKey, int32> PerceiverLookup;
+
+	TMap<uint32, FPendingQuery> PendingQueries;
+	uint32 NextQueryId = 0;
+
+	/** Reused every frame to avoid reallocating the candidate heap. */
+	TArray<FQueryCandidate> Candidates;
+
+	/** Scoring inputs and outputs, indexed like Perceivers and reused every frame. */
+	TArray<FScoringPerceiver> ScoringPerceivers;
+	TArray<FScoringResult> ScoringResults;
+	TArray<FScoringChunk> ScoringChunks;
+
+	double ScoringTime = 0.0;
+	float ScoringMinRefreshInterval = 0.f;
+	float ScoringSightRange = 0.f;
+	int32 ScoringQueryBudget = 0;
+
+	FTraceDelegate TraceDelegate;
+};
@@ -0,0 +1,73 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AIController.h"
+#include "TankAIController.generated.h"
+
+class ATank;
+struct FTankPath;
+
+/**
+ * Drives an AI tank along paths from UTankPathPlannerSubsystem.
+ *
+ * Paths respect the tank's turning radius, so following them is plain pure pursuit: steer toward a point a fixed
+ * distance ahead on the path and ease off the throttle in tight turns and near the goal.
+ */
+UCLASS()
+class TANKGAME_API ATankAIController : public AAIController
+{
+	GENERATED_BODY()
+
+public:
+	ATankAIController();
+
+	/** Plans a path to Goal and follows it once it arrives. Replaces any path being followed. */
+	UFUNCTION(BlueprintCallable, Category = "AI|Tank")
+	void MoveTankTo(const FVector& Goal);
+
+	/** Cancels any pending plan, drops the current path and brakes. */
+	UFUNCTION(BlueprintCallable, Category = "AI|Tank")
+	void StopTank();
+
+	UFUNCTION(BlueprintPure, Category = "AI|Tank")
+	bool IsFollowingPath() const { return CurrentPath.IsValid(); }
+
+	virtual void Tick(float DeltaTime) override;
+
+protected:
+	virtual void OnPossess(APawn* InPawn) override;
+	virtual void OnUnPossess() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Distance ahead along the path the tank steers toward. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Tank", meta = (ClampMin = "100", Units = "cm"))
+	float LookaheadDistance = 1500.f;
+
+	/** Path following stops within this distance of the final pose. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Tank", meta = (ClampMin = "0", Units = "cm"))
+	float ArrivalDistance = 400.f;
+
+	/** Heading error, in degrees, that gives full steering lock. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Tank", meta = (ClampMin = "1", ClampMax = "180"))
+	float FullSteeringAngle = 35.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Tank", meta = (ClampMin = "0", ClampMax = "1"))
+	float CruiseThrottle = 0.8f;
+
+private:
+	void OnPathPlanned(TSharedPtr<const FTankPath> Path);
+	void CancelPendingRequest();
+	void ApplyInputs(float Throttle, float Steering, float Brake) const;
+
+	UPROPERTY(Transient)
+	TObjectPtr<ATank> ControlledTank;
+
+	TSharedPtr<const FTankPath> CurrentPath;
+
+	/** Index of the path pose the tank is currently closest to. Only ever moves forward. */
+	int32 PathIndex = 0;
+
+	uint32 PendingRequestId = 0;
+};
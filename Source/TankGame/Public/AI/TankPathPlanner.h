@@ -0,0 +1,79 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Coarse 2D terrain grid for tank path planning: one height and one traversal cost per cell.
+ * Immutable once built, so any number of planning tasks can read it concurrently.
+ */
+struct TANKGAME_API FTankCostGrid
+{
+	static constexpr uint8 BlockedCost = 255;
+
+	FVector2D Origin = FVector2D::ZeroVector;
+	float CellSize = 500.f;
+	int32 SizeX = 0;
+	int32 SizeY = 0;
+
+	TArray<float> Heights;
+	/** 0 is open ground, higher values are progressively more expensive, BlockedCost is impassable. */
+	TArray<uint8> Costs;
+
+	void Init(const FVector2D& InOrigin, float InCellSize, int32 InSizeX, int32 InSizeY);
+
+	bool IsValidCell(const FIntPoint& Cell) const { return Cell.X >= 0 && Cell.Y >= 0 && Cell.X < SizeX && Cell.Y < SizeY; }
+	int32 GetIndex(const FIntPoint& Cell) const { return Cell.Y * SizeX + Cell.X; }
+
+	FIntPoint WorldToCell(const FVector2D& Location) const;
+	FVector2D CellToWorld(const FIntPoint& Cell) const;
+
+	SIZE_T GetAllocatedSize() const { return Heights.GetAllocatedSize() + Costs.GetAllocatedSize(); }
+};
+
+struct FTankPlannerParams
+{
+	/** Tightest turn the tank can follow at driving speed. */
+	float TurningRadius = 800.f;
+	/** Steepest climb or descent between neighbouring samples. */
+	float MaxSlopeDegrees = 30.f;
+	/** Distance the planner may end from the goal. */
+	float GoalTolerance = 600.f;
+	/** Number of discrete headings used to detect revisited states. */
+	int32 HeadingBins = 16;
+	/** Node expansions before giving up. */
+	int32 MaxExpansions = 30000;
+	/** Extra cost, as a fraction of distance travelled, for driving at full steering. Favours straight driving. */
+	float SteeringPenalty = 0.2f;
+	/** Extra cost, as a fraction of distance travelled, for swinging the steering from one lock to the other. Favours smooth paths. */
+	float SteeringChangePenalty = 0.4f;
+};
+
+struct FTankPathPose
+{
+	FVector Location = FVector::ZeroVector;
+	float Yaw = 0.f;
+};
+
+struct FTankPath
+{
+	TArray<FTankPathPose> Poses;
+	bool bReachedGoal = false;
+	int32 Expansions = 0;
+};
+
+/**
+ * Hybrid A* planner for tracked vehicles. States are continuous (x, y, yaw), expanded with constant curvature
+ * arcs no tighter than the turning radius, and deduplicated on (cell, heading bin). Self-contained and free of
+ * UObjects so it can run on any worker thread.
+ *
+ * When the goal cannot be reached within the expansion budget, the path ends at the expanded pose closest to the
+ * goal and bReachedGoal is false. Invalid or blocked start and goal cells give an empty path.
+ */
+class TANKGAME_API FTankPathPlanner
+{
+public:
+	static FTankPath PlanPath(const FTankCostGrid& Grid, const FTankPlannerParams& Params, const FVector2D& Start, float StartYaw,
+		const FVector2D& Goal);
+};
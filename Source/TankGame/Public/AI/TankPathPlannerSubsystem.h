@@ -0,0 +1,98 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AI/TankPathPlanner.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tasks/Task.h"
+#include "WorldCollision.h"
+#include "TankPathPlannerSubsystem.generated.h"
+
+DECLARE_DELEGATE_OneParam(FOnTankPathPlanned, TSharedPtr<const FTankPath> /*Path*/);
+
+/**
+ * Plans tank paths on worker threads over a coarse terrain cost grid.
+ *
+ * The grid is sampled with asynchronous downward traces when the world begins play, a few rows issued per frame
+ * so loading never hitches, then frozen and shared read-only with every planning task. Requests are answered on the game thread
+ * from Tick. A request is served from the cache if it can join a cached path to the same goal cell close to its
+ * start pose, and identical requests in flight share one task, so a column of tanks heading to one objective
+ * plans once. Nothing here ever waits on a task from the game thread.
+ */
+UCLASS()
+class TANKGAME_API UTankPathPlannerSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Requests a path. OnPlanned is called on the game thread on a later frame. Returns an id for CancelRequest. */
+	uint32 RequestPath(const FVector& Start, float StartYaw, const FVector& Goal, FOnTankPathPlanned OnPlanned);
+
+	void CancelRequest(uint32 RequestId);
+
+	/** The terrain grid, or null while it is still being sampled. */
+	TSharedPtr<const FTankCostGrid> GetCostGrid() const { return CostGrid; }
+
+	const FTankPlannerParams& GetPlannerParams() const { return PlannerParams; }
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	struct FPathRequest
+	{
+		uint32 RequestId = 0;
+		FVector2D Start;
+		float StartYaw = 0.f;
+		FVector2D Goal;
+		FOnTankPathPlanned OnPlanned;
+	};
+
+	struct FPlanJob
+	{
+		/** Start cell, start heading bin and goal cell; requests with the same key share the job. */
+		uint64 Key = 0;
+		FIntPoint GoalCell;
+		UE::Tasks::TTask<TSharedPtr<const FTankPath>> Task;
+		TArray<FPathRequest> Requests;
+	};
+
+	void SampleGridRows(int32 NumRows);
+	void OnGridTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+	void FinishGrid();
+	void StartRequest(FPathRequest&& Request);
+	uint64 MakeJobKey(const FPathRequest& Request) const;
+	TSharedPtr<const FTankPath> FindReusablePath(const FPathRequest& Request) const;
+	void AddToCache(const FIntPoint& GoalCell, const TSharedPtr<const FTankPath>& Path);
+
+	FTankPlannerParams PlannerParams;
+
+	/** Grid under construction; moved into CostGrid once every row has been sampled. */
+	TUniquePtr<FTankCostGrid> PendingGrid;
+	int32 NextGridRow = 0;
+	int32 NumGridTracesInFlight = 0;
+
+	/** Bound once and shared by every grid trace; UserData carries the cell index. */
+	FTraceDelegate GridTraceDelegate;
+
+	TSharedPtr<const FTankCostGrid> CostGrid;
+
+	/** Requests made before the grid was ready. */
+	TArray<FPathRequest> DeferredRequests;
+
+	TArray<FPlanJob> Jobs;
+
+	/** Paths delivered from the cache on the next Tick, so callbacks never run inside RequestPath. */
+	TArray<TPair<FPathRequest, TSharedPtr<const FTankPath>>> CachedResults;
+
+	TMap<FIntPoint, TArray<TSharedPtr<const FTankPath>>> PathCache;
+
+	uint32 NextRequestId = 0;
+};
@@ -0,0 +1,57 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AnimationBudgetSubsystem.generated.h"
+
+class AMainCharacter;
+
+/**
+ * Per-frame animation budget for NPCs built on AMainCharacter.
+ *
+ * Registered NPCs are ranked by significance (engaging the player first, then on-screen and close before off-screen
+ * and far), re-sorted every few frames, and each frame assigned an update rate of 1, 2, 4 or 8 frames so that the
+ * estimated cost of the updates fits tg.AnimBudget.BudgetMs. Throttled meshes use update rate optimizations with
+ * external tick rate control and interpolate the skipped frames. Distant or off-screen NPCs also blend out their
+ * aim offsets, and throttled off-screen NPCs skip cosmetic notifies. Player-controlled characters always run at
+ * full rate.
+ */
+UCLASS()
+class TANKGAME_API UAnimationBudgetSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void RegisterCharacter(AMainCharacter* Character);
+	void UnregisterCharacter(AMainCharacter* Character);
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	struct FBudgetedCharacter
+	{
+		TWeakObjectPtr<AMainCharacter> Character;
+		float Significance = 0.f;
+		float DistanceToViewer = 0.f;
+		bool bOnScreen = true;
+		/** Zero until the first rate has been applied. */
+		uint8 UpdateRate = 0;
+	};
+
+	void UpdateSignificance(FBudgetedCharacter& Budgeted, const TArray<FVector, TInlineAllocator<4>>& ViewLocations) const;
+	void ApplyUpdateRate(FBudgetedCharacter& Budgeted, uint8 UpdateRate) const;
+
+	/** Sorted by descending significance as of the last sort. */
+	TArray<FBudgetedCharacter> Characters;
+
+	uint32 FramesSinceSort = 0;
+	bool bNeedsSort = false;
+};
@@ -9,6 +9,9 @@
 class AMainCharacter;
 /**
  * AnimInstance subclass for controlling animation properties of the MainCharacter.
+ *
+ * The character's state is copied on the game thread in NativeUpdateAnimation, and the properties are computed
+ * from that copy in NativeThreadSafeUpdateAnimation, which runs on a worker thread alongside other meshes.
  */
 UCLASS()
 class TANKGAME_API UCharacterAnimInstance : public UAnimInstance
@@ -17,8 +20,12 @@ class TANKGAME_API UCharacterAnimInstance : public UAnimInstance
 
 public:
 	virtual void NativeUpdateAnimation(float DeltaSeconds) override;
+	virtual void NativeThreadSafeUpdateAnimation(float DeltaSeconds) override;
+	virtual bool HandleNotify(const FAnimNotifyEvent& AnimNotifyEvent) override;
+	virtual bool ShouldTriggerAnimNotifyState(const UAnimNotifyState* AnimNotifyState) const override;
 
-	UFUNCTION(BlueprintCallable, Category = AnimationProperties)
+	/** Kept so existing Blueprint calls still compile. Properties now update natively every frame. */
+	UFUNCTION(BlueprintCallable, Category = AnimationProperties, meta = (DeprecatedFunction, DeprecationMessage = "Animation properties update natively on a worker thread. Remove this call."))
 	void UpdateAnimationProperties(float DeltaTime);
 
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Movement)
@@ -41,7 +48,33 @@ public:
 
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Movement)
 	float AimYaw;
+
+	/** Cleared by the animation budget for distant or off-screen NPCs. AimPitch and AimYaw blend back to zero while false. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Budget)
+	bool bEvaluateAimOffset = true;
+
+	/**
+	 * Cleared by the animation budget for throttled off-screen NPCs. While false, sound and particle notifies and
+	 * timed particle and trail notify states are skipped. Gameplay notifies such as attack windows always run.
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Budget)
+	bool bRunCosmeticNotifies = true;
 	
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Movement)
 	TObjectPtr<AMainCharacter> MainCharacter;
+
+private:
+	/** Character state copied on the game thread for the worker thread update. */
+	struct FGatheredCharacterState
+	{
+		FVector Velocity = FVector::ZeroVector;
+		FRotator ActorRotation = FRotator::ZeroRotator;
+		FRotator ControlRotation = FRotator::ZeroRotator;
+		bool bFalling = false;
+		bool bAiming = false;
+		bool bCrouched = false;
+		bool bValid = false;
+	};
+
+	FGatheredCharacterState Gathered;
 };
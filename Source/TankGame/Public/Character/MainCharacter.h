@@ -7,9 +7,12 @@
 #include "GameFramework/Character.h"
 #include "MainCharacter.generated.h"
 
+class ATank;
 class UCameraComponent;
 class USpringArmComponent;
 class UBoxComponent;
+class UHealthComponent;
+class UPhysicsAsset;
 class UTimelineComponent;
 
 UCLASS()
@@ -19,7 +22,7 @@ class TANKGAME_API AMainCharacter : public ACharacter
 
 public:
 	// Sets default values for this character's properties
-	AMainCharacter();
+	AMainCharacter(const FObjectInitializer& ObjectInitializer);
 	
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
 	TObjectPtr<USpringArmComponent> CameraBoom;
@@ -39,6 +42,9 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	TObjectPtr<UCapsuleComponent> AttackCapsule;
 
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	TObjectPtr<UHealthComponent> HealthComponent;
+
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
 	TObjectPtr<UTimelineComponent> CameraZoomTimeline;
 
@@ -59,10 +65,20 @@ public:
 	
 	float ZoomValue;
 
+	/** How close a tank has to be for the character to be offered to enter it. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Vehicle, meta = (AllowPrivateAccess = "true"))
+	float EnterVehicleRadius = 400;
+
+	/** Simplified physics asset used when this character dies far from the player. The mesh's own asset is used when unset. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Death, meta = (AllowPrivateAccess = "true"))
+	TObjectPtr<UPhysicsAsset> DistantRagdollPhysicsAsset;
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	virtual void OnConstruction(const FTransform& Transform) override;
 	
 	// Called every frame
@@ -78,7 +94,14 @@ public:
 	void ActivateAttack(bool activate) const;
 	bool IsAttacking() const;
 
+	/** Attacking, aiming or recently damaged. Used to keep engaged NPCs at full simulation detail. */
+	bool IsInCombat() const;
+
 	void ZoomCamera(float ZoomValue);
+
+	/** Nearest tank within EnterVehicleRadius, found through the spatial hash instead of an overlap volume. */
+	UFUNCTION(BlueprintPure, Category = Vehicle)
+	ATank* FindEnterableTank() const;
 	
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	bool bIsAiming = false;
@@ -95,6 +118,9 @@ public:
 
 	UFUNCTION()
 	void OnCameraZoomTimelineFinished();
+
+	UFUNCTION()
+	void OnHealthDepleted(UHealthComponent* DeadHealthComponent, AController* Killer, AActor* DamageCauser);
 	
 private:
 	void PerformLineTraceAndApplyDamage();
@@ -0,0 +1,83 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "MainCharacterMovementComponent.generated.h"
+
+/** Movement simulation detail for a character, chosen by UMovementLODSubsystem. */
+UENUM(BlueprintType)
+enum class EMovementLOD : uint8
+{
+	/** Regular walking with floor sweeps and step-up checks every frame. */
+	Full,
+	/** Nav walking projected onto the navmesh at a reduced rate, ticking at a reduced rate. */
+	NavWalking,
+	/** Nav walking with no collision sweeps and infrequent projection, ticking at a low rate. */
+	Kinematic
+};
+
+/**
+ * Character movement with a switchable level of detail, so distant NPCs do not pay for full floor sweeps.
+ * Path following requests are steered by UCrowdAvoidanceSubsystem while it keeps an avoidance velocity fresh.
+ */
+UCLASS()
+class TANKGAME_API UMainCharacterMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	virtual void RequestDirectMove(const FVector& MoveVelocity, bool bForceMaxSpeed) override;
+
+	UFUNCTION(BlueprintCallable, Category = Movement)
+	void SetMovementLOD(EMovementLOD NewMovementLOD);
+
+	UFUNCTION(BlueprintPure, Category = Movement)
+	EMovementLOD GetMovementLOD() const { return MovementLOD; }
+
+	/** Velocity path following last asked for, before avoidance. Zero if nothing was requested within MaxAge seconds. */
+	FVector GetPreferredVelocity(double MaxAge) const;
+
+	/** Velocity used in place of path following requests until it is older than the avoidance staleness limit. */
+	void SetAvoidanceVelocity(const FVector& NewAvoidanceVelocity);
+
+	/** Hands path following requests straight back to path following, for characters avoidance no longer solves. */
+	void ClearAvoidanceVelocity();
+
+	/** Seconds between navmesh projections at EMovementLOD::NavWalking. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Movement LOD", meta = (ClampMin = "0", Units = "s"))
+	float NavWalkingProjectionInterval = 0.25f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Movement LOD", meta = (ClampMin = "0", Units = "s"))
+	float NavWalkingTickInterval = 1.f / 30.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Movement LOD", meta = (ClampMin = "0", Units = "s"))
+	float KinematicTickInterval = 0.1f;
+
+	/** Seconds between navmesh projections at EMovementLOD::Kinematic, so pawns still follow the terrain height. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Movement LOD", meta = (ClampMin = "0", Units = "s"))
+	float KinematicProjectionInterval = 1.f;
+
+#if !UE_BUILD_SHIPPING
+	/** Game thread seconds spent ticking character movement at each EMovementLOD since the last reset. Used by benchmarks. */
+	static double TickSecondsByLOD[3];
+#endif
+
+protected:
+	virtual void BeginPlay() override;
+
+private:
+	EMovementLOD MovementLOD = EMovementLOD::Full;
+
+	/** Full-detail settings captured at BeginPlay so EMovementLOD::Full can restore them. */
+	float FullProjectionInterval = 0.f;
+	float FullTickInterval = 0.f;
+
+	FVector PreferredVelocity = FVector::ZeroVector;
+	double PreferredVelocityTime = -UE_BIG_NUMBER;
+
+	FVector AvoidanceVelocity = FVector::ZeroVector;
+	double AvoidanceVelocityTime = -UE_BIG_NUMBER;
+};
@@ -0,0 +1,41 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Character/MainCharacterMovementComponent.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "MovementLODSubsystem.generated.h"
+
+class AMainCharacter;
+
+/**
+ * Picks an EMovementLOD for every NPC built on AMainCharacter from its distance to the nearest player pawn.
+ *
+ * NPCs in combat and player-controlled characters always get full movement. Tiers are re-evaluated a few times a
+ * second, with hysteresis on the distance thresholds so pawns near a boundary do not flip every update.
+ */
+UCLASS()
+class TANKGAME_API UMovementLODSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void RegisterCharacter(AMainCharacter* Character);
+	void UnregisterCharacter(AMainCharacter* Character);
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	EMovementLOD ChooseMovementLOD(const AMainCharacter* Character, EMovementLOD CurrentLOD, const TArray<FVector, TInlineAllocator<4>>& PlayerLocations) const;
+
+	TArray<TWeakObjectPtr<AMainCharacter>> Characters;
+
+	float TimeUntilUpdate = 0.f;
+};
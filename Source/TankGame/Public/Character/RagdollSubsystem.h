@@ -0,0 +1,68 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RagdollSubsystem.generated.h"
+
+class AMainCharacter;
+
+/**
+ * Turns dead NPCs into ragdolls under a global simulation budget.
+ *
+ * Deaths are queued and started a few per frame, so a burst of kills spreads its physics setup over several frames.
+ * At most tg.Ragdoll.MaxSimulating ragdolls simulate at once; starting another freezes the oldest. NPCs that die
+ * far from every player camera use their simplified DistantRagdollPhysicsAsset, and beyond tg.Ragdoll.FreezeDistance
+ * they skip the ragdoll entirely. Once a ragdoll has settled it is frozen: its pose is kept, its mesh stops ticking
+ * and its physics bodies are released. The oldest corpse is destroyed when there are more than tg.Ragdoll.MaxCorpses.
+ */
+UCLASS()
+class TANKGAME_API URagdollSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Hands a dead character over. Its ragdoll starts once there is room in this frame's budget. */
+	void QueueRagdoll(AMainCharacter* Character);
+
+	int32 GetNumSimulating() const { return Simulating.Num(); }
+	int32 GetNumPending() const { return PendingDeaths.Num(); }
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	enum class ERagdollLOD : uint8
+	{
+		Full,
+		Simplified,
+		Frozen
+	};
+
+	struct FRagdoll
+	{
+		TWeakObjectPtr<AMainCharacter> Character;
+		double StartTime = 0.0;
+		float SettledTime = 0.f;
+	};
+
+	ERagdollLOD ChooseRagdollLOD(const AMainCharacter* Character, const TArray<FVector, TInlineAllocator<4>>& ViewLocations) const;
+
+	void StartRagdoll(AMainCharacter* Character, ERagdollLOD RagdollLOD);
+	void FreezeCorpse(AMainCharacter* Character);
+
+	/** Oldest first. */
+	TArray<TWeakObjectPtr<AMainCharacter>> PendingDeaths;
+
+	/** Oldest first. */
+	TArray<FRagdoll> Simulating;
+
+	/** Frozen corpses, oldest first. */
+	TArray<TWeakObjectPtr<AMainCharacter>> Corpses;
+};
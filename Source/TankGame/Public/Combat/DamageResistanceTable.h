@@ -0,0 +1,47 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "DamageResistanceTable.generated.h"
+
+/** How a hit was delivered. Resistances are authored per kind. */
+UENUM(BlueprintType)
+enum class EDamageKind : uint8
+{
+	Melee,
+	Bullet,
+	Shell,
+	Splash,
+
+	MAX UMETA(Hidden)
+};
+
+/**
+ * Damage multipliers for one actor class. Kinds that are not listed take full damage.
+ */
+USTRUCT(BlueprintType)
+struct TANKGAME_API FDamageResistance
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Damage)
+	TSubclassOf<AActor> ActorClass;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Damage)
+	TMap<EDamageKind, float> Multipliers;
+};
+
+/**
+ * Data asset holding per-class damage resistances. The entry for the most derived matching class wins.
+ */
+UCLASS(BlueprintType)
+class TANKGAME_API UDamageResistanceTable : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Damage, meta = (TitleProperty = "ActorClass"))
+	TArray<FDamageResistance> Resistances;
+};
@@ -0,0 +1,76 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Combat/DamageResistanceTable.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "DamageSubsystem.generated.h"
+
+class UHealthComponent;
+
+/**
+ * Queued, batched damage pipeline.
+ *
+ * Hits call QueueDamage, which only appends a compact record. Once per frame, after all actors have ticked,
+ * the queue is resolved in enqueue order: hits on the same target by the same causer and damage kind within a
+ * frame are merged into one event whose amount is their sum, resistances from the configured UDamageResistanceTable
+ * are applied, health components are updated directly, and deaths are broadcast after every record of the frame has
+ * been applied. Every resolved event is also passed to AActor::TakeDamage so Blueprint damage events keep working.
+ *
+ * Damage queued while resolving (for example from an OnDeath handler) is resolved on the next frame.
+ */
+UCLASS()
+class TANKGAME_API UDamageSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	UFUNCTION(BlueprintCallable, Category = Damage)
+	void QueueDamage(AActor* Target, float Amount, EDamageKind DamageKind, AController* Instigator, AActor* DamageCauser);
+
+	void RegisterHealthComponent(UHealthComponent* HealthComponent);
+	void UnregisterHealthComponent(UHealthComponent* HealthComponent);
+
+	UHealthComponent* FindHealthComponent(const AActor* Actor) const;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	struct FDamageRecord
+	{
+		TWeakObjectPtr<AActor> Target;
+		TWeakObjectPtr<AController> Instigator;
+		TWeakObjectPtr<AActor> DamageCauser;
+		float Amount = 0.f;
+		EDamageKind DamageKind = EDamageKind::Melee;
+	};
+
+	struct FResolvedResistance
+	{
+		float Multipliers[static_cast<int32>(EDamageKind::MAX)];
+	};
+
+	void ResolveQueuedDamage();
+	const FResolvedResistance& GetResistance(const UClass* ActorClass);
+
+	UPROPERTY(Transient)
+	TObjectPtr<UDamageResistanceTable> ResistanceTable;
+
+	TArray<FDamageRecord> PendingRecords;
+	TArray<FDamageRecord> ResolvingRecords;
+
+	/** (Target, DamageCauser, DamageKind) -> index into ResolvingRecords, reused between frames. */
+	TMap<TTuple<FObjectKey, FObjectKey, EDamageKind>, int32> DedupeLookup;
+
+	TMap<FObjectKey, TWeakObjectPtr<UHealthComponent>> HealthComponents;
+	TMap<const UClass*, FResolvedResistance> ResistanceCache;
+};
@@ -0,0 +1,70 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "HealthComponent.generated.h"
+
+class UHealthComponent;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_FourParams(FOnHealthChanged, UHealthComponent*, HealthComponent, float, Health, float, Delta, AActor*, DamageCauser);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnDeath, UHealthComponent*, HealthComponent, AController*, Killer, AActor*, DamageCauser);
+
+/**
+ * Holds an actor's health. Damage is not applied here directly but resolved once per frame by UDamageSubsystem,
+ * which registers every health component when it begins play.
+ */
+UCLASS(ClassGroup = (Combat), meta = (BlueprintSpawnableComponent))
+class TANKGAME_API UHealthComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UHealthComponent();
+
+	UFUNCTION(BlueprintPure, Category = Health)
+	float GetHealth() const { return Health; }
+
+	UFUNCTION(BlueprintPure, Category = Health)
+	float GetMaxHealth() const { return MaxHealth; }
+
+	UFUNCTION(BlueprintPure, Category = Health)
+	bool IsDead() const { return Health <= 0.f; }
+
+	/** True if damage was received within the last Seconds. */
+	UFUNCTION(BlueprintPure, Category = Health)
+	bool WasRecentlyDamaged(float Seconds) const;
+
+	/** Removes Damage from Health and broadcasts OnHealthChanged. Returns true if this killed the owner. */
+	bool ReceiveDamage(float Damage, AActor* DamageCauser);
+
+	/** Sets Health directly, e.g. when restoring a checkpoint, and broadcasts OnHealthChanged. Never broadcasts OnDeath. */
+	void SetHealth(float NewHealth);
+
+	UPROPERTY(BlueprintAssignable, Category = Health)
+	FOnHealthChanged OnHealthChanged;
+
+	UPROPERTY(BlueprintAssignable, Category = Health)
+	FOnDeath OnDeath;
+
+	/** Replaces the owner with its wreck from the project's destruction cache set when it dies. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Health)
+	bool bShatterOnDeath = false;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Health, meta = (ClampMin = "1"))
+	float MaxHealth = 100.f;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Health)
+	float Health = 0.f;
+
+	double LastDamageTime = -UE_BIG_NUMBER;
+
+private:
+	UFUNCTION()
+	void ShatterOwner(UHealthComponent* DeadHealthComponent, AController* Killer, AActor* DamageCauser);
+};
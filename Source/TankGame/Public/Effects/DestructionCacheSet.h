@@ -0,0 +1,58 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "DestructionCacheSet.generated.h"
+
+class UChaosCacheCollection;
+class UGeometryCollection;
+
+/**
+ * How one kind of actor breaks apart: its fractured geometry and the destruction pre-recorded from it.
+ *
+ * Record the caches of every entry by running TankGame.Destruction.RecordCaches during Play In Editor, then saving
+ * the cache set and its cache collections.
+ */
+USTRUCT(BlueprintType)
+struct TANKGAME_API FDestructionCacheDefinition
+{
+	GENERATED_BODY()
+
+	/** Actor class replaced by this entry when destroyed. Subclasses use the entry of their closest listed parent. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Destruction)
+	TSubclassOf<AActor> ActorClass;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Destruction)
+	TObjectPtr<UGeometryCollection> GeometryCollection;
+
+	/** Pre-recorded destruction of GeometryCollection. Without one the wreck is always simulated live. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Destruction)
+	TObjectPtr<UChaosCacheCollection> CacheCollection;
+
+	/** Name of the recorded cache inside CacheCollection. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Destruction)
+	FName CacheName;
+
+	/** Placement of the wreck relative to the destroyed actor. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Destruction)
+	FTransform RelativeTransform;
+
+	/** Seconds the wreck stays in the world. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Budget, meta = (ClampMin = "1", Units = "s"))
+	float WreckLifeSpan = 30.f;
+};
+
+/**
+ * Data asset listing the destruction caches used by UDestructionSubsystem, one per tank archetype or key prop.
+ */
+UCLASS(BlueprintType)
+class TANKGAME_API UDestructionCacheSet : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Destruction, meta = (TitleProperty = "ActorClass"))
+	TArray<FDestructionCacheDefinition> Definitions;
+};
@@ -0,0 +1,77 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Effects/DestructionCacheSet.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DestructionSubsystem.generated.h"
+
+/**
+ * Replaces destroyed tanks and props with wrecks from the project's UDestructionCacheSet.
+ *
+ * Shattering hides the actor immediately; its wreck is spawned on a later frame, a few per frame, so many kills
+ * at once do not spike the frame. Wrecks near a player camera are simulated live while tg.Destruction.MaxLive
+ * allows; all others play their pre-recorded cache back on kinematic pieces with no rigid-body simulation.
+ * Wrecks expire after their definition's life span, and the oldest is removed past tg.Destruction.MaxWrecks.
+ */
+UCLASS()
+class TANKGAME_API UDestructionSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/**
+	 * Hides Actor and replaces it with its wreck. A player driving Actor is put back in their character first.
+	 * Returns false, leaving Actor untouched, if its class has no entry, it is already queued, or a player still controls it.
+	 */
+	UFUNCTION(BlueprintCallable, Category = Destruction)
+	bool Shatter(AActor* Actor);
+
+	int32 GetNumPending() const { return PendingDestructions.Num(); }
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	struct FPendingDestruction
+	{
+		TWeakObjectPtr<AActor> Actor;
+		FTransform Transform;
+		int32 DefinitionIndex = INDEX_NONE;
+	};
+
+	struct FWreck
+	{
+		TWeakObjectPtr<AActor> GeometryActor;
+		TWeakObjectPtr<AActor> CacheManager;
+		double ExpireTime = 0.0;
+		bool bLive = false;
+	};
+
+	int32 FindDefinition(const UClass* ActorClass);
+	bool ShouldSimulateLive(const FVector& Location) const;
+
+	void SpawnWreck(const FPendingDestruction& Pending, bool bLive);
+	void DestroyWreck(const FWreck& Wreck) const;
+
+	UPROPERTY(Transient)
+	TObjectPtr<UDestructionCacheSet> CacheSet;
+
+	/** Resolved entry for every class seen so far, including INDEX_NONE for classes without one. */
+	TMap<const UClass*, int32> DefinitionLookup;
+
+	/** Oldest first. */
+	TArray<FPendingDestruction> PendingDestructions;
+
+	/** Oldest first. */
+	TArray<FWreck> Wrecks;
+
+	int32 NumLiveWrecks = 0;
+};
@@ -0,0 +1,72 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Chaos/ChaosEngineInterface.h"
+#include "Engine/DataAsset.h"
+#include "ImpactEffectSet.generated.h"
+
+class UParticleSystem;
+class UMaterialInterface;
+
+/** The gameplay event an effect is played for. Combined with the surface type to pick an effect. */
+UENUM(BlueprintType)
+enum class EImpactEffectType : uint8
+{
+	BulletImpact,
+	MeleeImpact,
+	ShellImpact,
+	MuzzleFlash,
+
+	MAX UMETA(Hidden)
+};
+
+/**
+ * One entry of an impact effect set: what to play for a given effect type on a given surface.
+ */
+USTRUCT(BlueprintType)
+struct TANKGAME_API FImpactEffectDefinition
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Effect)
+	EImpactEffectType EffectType = EImpactEffectType::BulletImpact;
+
+	/** Surface this entry applies to. SurfaceType_Default is used as the fallback for unlisted surfaces. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Effect)
+	TEnumAsByte<EPhysicalSurface> SurfaceType = SurfaceType_Default;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Effect)
+	TObjectPtr<UParticleSystem> ParticleTemplate;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Decal)
+	TObjectPtr<UMaterialInterface> DecalMaterial;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Decal)
+	FVector DecalSize = FVector(8.f, 8.f, 8.f);
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Decal, meta = (ClampMin = "0", Units = "s"))
+	float DecalLifeSpan = 10.f;
+
+	/** Maximum number of instances of this entry alive at once. The oldest one is recycled beyond this. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Budget, meta = (ClampMin = "1"))
+	int32 MaxActive = 16;
+
+	/** Requests further than this from every player camera are dropped without spawning anything. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Budget, meta = (ClampMin = "0", Units = "cm"))
+	float CullDistance = 8000.f;
+};
+
+/**
+ * Data asset listing the impact, decal and muzzle effects used by UImpactEffectSubsystem.
+ */
+UCLASS(BlueprintType)
+class TANKGAME_API UImpactEffectSet : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Effects, meta = (TitleProperty = "EffectType"))
+	TArray<FImpactEffectDefinition> Effects;
+};
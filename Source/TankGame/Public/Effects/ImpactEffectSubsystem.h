@@ -0,0 +1,88 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Effects/ImpactEffectSet.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ImpactEffectSubsystem.generated.h"
+
+class UDecalComponent;
+class UParticleSystemComponent;
+
+/**
+ * World-level pool of impact, decal and muzzle effects.
+ *
+ * Particle and decal components are allocated once when the world begins play and recycled afterwards,
+ * so firing never creates components. Effects are looked up by (effect type, surface type), capped both
+ * globally (the pool size) and per definition, and the oldest instance is stolen when a cap is reached.
+ * Requests that no player camera can see are dropped before touching the pool.
+ */
+UCLASS()
+class TANKGAME_API UImpactEffectSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Plays the effect registered for EffectType on SurfaceType. Returns false if it was culled or not defined. */
+	UFUNCTION(BlueprintCallable, Category = Effects)
+	bool SpawnEffect(EImpactEffectType EffectType, EPhysicalSurface SurfaceType, const FVector& Location, const FRotator& Rotation);
+
+	/** Plays an impact effect at a trace hit, using the hit's physical material and facing out of the surface. */
+	bool SpawnEffectAtHit(EImpactEffectType EffectType, const FHitResult& Hit);
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	struct FPooledEffectSlot
+	{
+		int32 DefinitionIndex = INDEX_NONE;
+		double SpawnTime = 0.0;
+		double ExpireTime = 0.0;
+	};
+
+	int32 FindDefinition(EImpactEffectType EffectType, EPhysicalSurface SurfaceType) const;
+	bool IsRelevantToAnyPlayer(const FVector& Location, float CullDistance) const;
+
+	int32 AcquireSlot(TArray<FPooledEffectSlot>& Slots, TArray<int32>& FreeSlots, TArray<int32>& ActiveCounts, int32 DefinitionIndex);
+	void ReleaseParticleSlot(int32 SlotIndex);
+	void ReleaseDecalSlot(int32 SlotIndex);
+
+	UFUNCTION()
+	void OnParticleSystemFinished(UParticleSystemComponent* ParticleSystem);
+
+	UPROPERTY(Transient)
+	TObjectPtr<UImpactEffectSet> EffectSet;
+
+	/** Owns every pooled component so they share one actor's lifetime and registration. */
+	UPROPERTY(Transient)
+	TObjectPtr<AActor> PoolOwner;
+
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UParticleSystemComponent>> ParticleComponents;
+
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UDecalComponent>> DecalComponents;
+
+	TArray<FPooledEffectSlot> ParticleSlots;
+	TArray<FPooledEffectSlot> DecalSlots;
+
+	TArray<int32> FreeParticleSlots;
+	TArray<int32> FreeDecalSlots;
+
+	/** Active instances per definition, indexed like EffectSet->Effects. */
+	TArray<int32> ActiveParticleCounts;
+	TArray<int32> ActiveDecalCounts;
+
+	/** (EffectType, SurfaceType) packed into 16 bits -> index into EffectSet->Effects. */
+	TMap<uint16, int32> DefinitionLookup;
+
+	int32 NumActiveDecals = 0;
+};
@@ -5,14 +5,18 @@
 #include "CoreMinimal.h"
 #include "InputActionValue.h"
 #include "GameFramework/PlayerController.h"
+#include "Shared/Vehicle.h"
 #include "CharacterPlayerController.generated.h"
 
+class AMainCharacter;
+class ATank;
 class UInputMappingContext;
 class UInputAction;
 /**
  * ACharacterPlayerController is a custom player controller class for handling character actions and inputs.
- * This class is responsible for setting up input actions and binding them
- * to corresponding gameplay functionalities for player character control.
+ * It routes input to whichever pawn is possessed: on foot it drives an AMainCharacter, inside a vehicle it drives
+ * the vehicle through IVehicle. The matching mapping context is swapped in whenever the pawn changes, and the typed
+ * pawn is cached at that point so input handlers never cast.
  */
 UCLASS()
 class TANKGAME_API ACharacterPlayerController : public APlayerController
@@ -21,14 +25,36 @@ class TANKGAME_API ACharacterPlayerController : public APlayerController
 
 public:
 	virtual void SetupInputComponent() override;
+	virtual void SetPawn(APawn* InPawn) override;
+	virtual void PlayerTick(float DeltaTime) override;
+
+	/** Possesses the nearest enterable tank, leaving the character parked inside it. */
+	UFUNCTION(BlueprintCallable, Category = Vehicle)
+	void EnterVehicle();
+
+	/** Possesses Tank if it is unoccupied, leaving the character parked inside it. Does nothing unless on foot. */
+	UFUNCTION(BlueprintCallable, Category = Vehicle)
+	void EnterTank(ATank* Tank);
+
+	/** Returns control to the character that entered the current tank, at the tank's exit point. */
+	UFUNCTION(BlueprintCallable, Category = Vehicle)
+	void ExitVehicle();
 
 protected:
 	virtual void BeginPlay() override;
+	virtual void PreProcessInput(const float DeltaTime, const bool bGamePaused) override;
 
 private:
+	/** Caches the typed pawn and applies the mapping context that goes with it. */
+	void RefreshControlledPawn();
+
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
 	TObjectPtr<UInputMappingContext> DefaultMappingContext;
 
+	/** Mapping context used while a tank is possessed. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
+	TObjectPtr<UInputMappingContext> TankMappingContext;
+
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
 	TObjectPtr<UInputAction> MoveAction;
 
@@ -53,12 +79,47 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
 	TObjectPtr<UInputAction> CameraZoomAction;
 
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
+	TObjectPtr<UInputAction> EnterVehicleAction;
+
+	/** Axis, forward positive. Negative values brake, and reverse once stopped. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
+	TObjectPtr<UInputAction> TankThrottleAction;
+
+	/** Axis, right positive. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
+	TObjectPtr<UInputAction> TankSteerAction;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
+	TObjectPtr<UInputAction> TankHandbrakeAction;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
+	TObjectPtr<UInputAction> TankFireAction;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
+	TObjectPtr<UInputAction> ExitVehicleAction;
+
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Movement, meta = (AllowPrivateAccess = "true"))
 	float WalkSpeed = 200;
 
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Movement, meta = (AllowPrivateAccess = "true"))
 	float RunSpeed = 450;
 
+	/** Set when a character is possessed, null otherwise. */
+	UPROPERTY(Transient)
+	TObjectPtr<AMainCharacter> ControlledCharacter;
+
+	/** Set when a vehicle is possessed, null otherwise. */
+	UPROPERTY(Transient)
+	TScriptInterface<IVehicle> ControlledVehicle;
+
+	/** The character parked inside ControlledVehicle, possessed again on exit. */
+	UPROPERTY(Transient)
+	TObjectPtr<AMainCharacter> ParkedCharacter;
+
+	UPROPERTY(Transient)
+	TObjectPtr<UInputMappingContext> ActiveMappingContext;
+
 	void Move(const FInputActionValue& Value);
 	void StopMove();
 
@@ -76,4 +137,10 @@ private:
 	void ToggleCrouch();
 
 	void CameraZoom(const FInputActionValue& Value);
+
+	void TankThrottle(const FInputActionValue& Value);
+	void StartTankThrottle();
+	void TankSteer(const FInputActionValue& Value);
+	void TankHandbrake(const FInputActionValue& Value);
+	void TankFire();
 };
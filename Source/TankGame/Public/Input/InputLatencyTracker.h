@@ -0,0 +1,73 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class IInputProcessor;
+
+enum class EInputLatencyAction : uint8
+{
+	/** Attack input to melee montage start. */
+	MeleeAttack,
+	/** Attack input while aiming to hitscan trace issue. */
+	HitscanFire,
+	/** Throttle input to the vehicle movement component consuming it. */
+	TankThrottle,
+	/** Fire input to the shell trace. */
+	TankFire,
+	MAX
+};
+
+/**
+ * Measures time from an input event to its gameplay effect, per action.
+ *
+ * The start time is when Slate received the last key, button or analog press before the player controller
+ * processed input this frame, so it includes the wait for the frame as well as dispatch. Mouse movement and key
+ * repeats do not count as presses. The input handler calls Begin on the press edge and the code that produces the
+ * effect calls End, or Cancel if the input had no effect; End without a pending Begin does nothing. Percentiles over
+ * the last samples are published to "stat TankGameInput".
+ */
+class TANKGAME_API FInputLatencyTracker
+{
+public:
+	static FInputLatencyTracker& Get();
+
+	/** Records when the input about to be processed arrived. Called by the player controller before processing input. */
+	void MarkInputSampled();
+
+	/** Records the arrival of a press. Called by the Slate input preprocessor the tracker registers. */
+	void MarkInputEvent();
+
+	/** Starts a measurement for Action, replacing any measurement still pending from an earlier press. */
+	void Begin(EInputLatencyAction Action);
+
+	/** Completes the pending measurement for Action, if any. */
+	void End(EInputLatencyAction Action);
+
+	/** Drops the pending measurement for Action, for input that produced no effect. */
+	void Cancel(EInputLatencyAction Action);
+
+	/** Recomputes percentiles and publishes them to the stat page, at most a few times per second. */
+	void UpdateStats();
+
+	void LogPercentiles() const;
+
+private:
+	static constexpr int32 MaxSamples = 256;
+
+	struct FActionSamples
+	{
+		double PendingStart = -1.0;
+		TArray<float> LatencyMs;
+		int32 NextSample = 0;
+	};
+
+	bool GetPercentiles(EInputLatencyAction Action, float& OutP50, float& OutP95, float& OutP99) const;
+
+	FActionSamples Actions[static_cast<int32>(EInputLatencyAction::MAX)];
+	TSharedPtr<IInputProcessor> InputProcessor;
+	double LastInputEventTime = 0.0;
+	double InputSampleTime = 0.0;
+	double LastStatsTime = 0.0;
+};
@@ -0,0 +1,80 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Shared/WorldSnapshot.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tasks/Task.h"
+#include "CheckpointSubsystem.generated.h"
+
+class AMainCharacter;
+class ATank;
+
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnCheckpointFinished, const FString& /*SlotName*/, bool /*bSuccess*/);
+
+/**
+ * Saves and restores checkpoints of every tank and character without hitching the game thread.
+ *
+ * Saving copies plain state into an FWorldSnapshot on the game thread, then hands it to a task that encodes,
+ * compresses and writes it. Loading reads and decodes on a task; once it completes, Tick destroys the current
+ * tanks and characters a batch per frame (tg.Checkpoint.DestroysPerFrame), then respawns them from the snapshot
+ * a batch per frame (tg.Checkpoint.SpawnsPerFrame). Pawns possessed by a player, and the character parked inside
+ * a player's tank, are kept and moved into their saved state instead of being respawned. Whether the player was
+ * driving is saved too: a player on foot is put back into their restored tank, and a driving player is taken out
+ * of the tank when the checkpoint has them on foot.
+ */
+UCLASS()
+class TANKGAME_API UCheckpointSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Captures the world and starts writing it to SlotName. Returns false if a checkpoint is already being saved or loaded. */
+	bool SaveCheckpoint(const FString& SlotName);
+
+	/** Starts reading SlotName and restoring it. Returns false if a checkpoint is already being saved or loaded. */
+	bool LoadCheckpoint(const FString& SlotName);
+
+	bool IsBusy() const { return SaveTask.IsValid() || LoadTask.IsValid() || RestoreSnapshot.IsValid(); }
+
+	/** Copies the state of every tank and character into OutSnapshot. Game thread only. */
+	void CaptureWorld(FWorldSnapshot& OutSnapshot) const;
+
+	static FString GetCheckpointPath(const FString& SlotName);
+
+	FOnCheckpointFinished OnCheckpointSaved;
+	FOnCheckpointFinished OnCheckpointLoaded;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	void BeginRestore(TSharedPtr<FWorldSnapshot> Snapshot);
+	void RestoreBatch(int32 MaxSpawns);
+	void FinishRestore(bool bSuccess);
+	void EnterRestoredTank(ATank* Tank) const;
+
+	static void ApplyTankState(ATank* Tank, const FTankSnapshot& State);
+	static void ApplyCharacterState(AMainCharacter* Character, const FCharacterSnapshot& State);
+
+	FString SaveSlotName;
+	UE::Tasks::TTask<bool> SaveTask;
+
+	FString LoadSlotName;
+	UE::Tasks::TTask<TSharedPtr<FWorldSnapshot>> LoadTask;
+
+	/** Snapshot being respawned, and the next tank and character records to spawn. */
+	TSharedPtr<FWorldSnapshot> RestoreSnapshot;
+	TArray<UClass*> RestoreClasses;
+	int32 NextTankRecord = 0;
+	int32 NextCharacterRecord = 0;
+
+	/** Current actors still to be destroyed before respawning starts. */
+	TArray<TWeakObjectPtr<AActor>> PendingDestroy;
+};
@@ -0,0 +1,92 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#ifndef TG_DEBUG_EVENTS
+#define TG_DEBUG_EVENTS !UE_BUILD_SHIPPING
+#endif
+
+enum class EDebugEventCategory : uint8
+{
+	Melee,
+	Hitscan,
+	Animation,
+	MAX
+};
+
+enum class EDebugEvent : uint8
+{
+	AttackNotifyBegin,
+	AttackNotifyEnd,
+	MeleeHitCharacter,
+	HitscanHit,
+	HitscanMiss,
+	AttackMontageBusy,
+	AttackMontageMissing,
+	MAX
+};
+
+#if TG_DEBUG_EVENTS
+
+#include <atomic>
+
+/**
+ * Category-filtered channel for gameplay debug events.
+ *
+ * Recording an event copies a small fixed-size record into a single-producer ring buffer owned by the calling
+ * thread; nothing is formatted or allocated. The game thread drains the rings and formats the events only for the
+ * viewers that are switched on: on-screen messages, the log, or Insights bookmarks (tg.DebugEvents.Screen, .Log
+ * and .Insights). With no viewer attached every category is masked off and TG_DEBUG_EVENT costs one relaxed load
+ * and a branch. In Shipping it compiles to nothing.
+ */
+class TANKGAME_API FGameplayDebugLog
+{
+public:
+	static constexpr EDebugEventCategory GetCategory(EDebugEvent Event)
+	{
+		switch (Event)
+		{
+		case EDebugEvent::MeleeHitCharacter:
+			return EDebugEventCategory::Melee;
+		case EDebugEvent::HitscanHit:
+		case EDebugEvent::HitscanMiss:
+			return EDebugEventCategory::Hitscan;
+		default:
+			return EDebugEventCategory::Animation;
+		}
+	}
+
+	static bool IsRecording(EDebugEventCategory Category)
+	{
+		return (RecordingMask.load(std::memory_order_relaxed) & (1u << static_cast<uint32>(Category))) != 0;
+	}
+
+	/** Use TG_DEBUG_EVENT instead, so the call and its arguments compile out. */
+	static void Record(EDebugEvent Event, const UObject* Subject, float Value);
+
+	/** Formats every pending event for the attached viewers. Game thread only. */
+	static void Flush();
+
+	/** Recomputes the recording mask from the viewer and category console variables. */
+	static void RefreshRecordingMask();
+
+private:
+	static std::atomic<uint32> RecordingMask;
+};
+
+#define TG_DEBUG_EVENT(Event, Subject, Value) \
+	do \
+	{ \
+		if (FGameplayDebugLog::IsRecording(FGameplayDebugLog::GetCategory(Event))) \
+		{ \
+			FGameplayDebugLog::Record(Event, Subject, Value); \
+		} \
+	} while (0)
+
+#else
+
+#define TG_DEBUG_EVENT(Event, Subject, Value) do { } while (0)
+
+#endif
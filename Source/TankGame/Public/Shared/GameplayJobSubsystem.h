@@ -0,0 +1,82 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GameplayJobSubsystem.generated.h"
+
+/**
+ * A system's share of the gameplay frame, split into phases by what they may touch.
+ *
+ * GatherJob and ApplyJob run on the game thread and are the only phases allowed to read or write UObjects.
+ * ComputeJob runs on worker threads, concurrently with every other job's compute phase, and may only read what
+ * GatherJob copied and write the results of its own item.
+ */
+class TANKGAME_API IGameplayJob
+{
+public:
+	virtual ~IGameplayJob() = default;
+
+	/** Game thread. Copies the inputs of this frame's work. Returns the number of items to compute, or 0 to skip. */
+	virtual int32 GatherJob(float DeltaTime) = 0;
+
+	/** Worker thread. Computes item Index, for every Index in [0, NumItems), in any order. */
+	virtual void ComputeJob(int32 Index) = 0;
+
+	/** Game thread, once every job has computed. Writes this frame's results back to the world. */
+	virtual void ApplyJob() = 0;
+
+	/** Compute items handed to a worker at a time, or 0 for tg.GameplayJobs.BatchSize. Jobs whose items are already chunks of work return 1. */
+	virtual int32 GetItemsPerBatch() const { return 0; }
+};
+
+/**
+ * Runs registered gameplay jobs once per frame, after actors have ticked.
+ *
+ * Every job gathers in registration order, then the compute items of all jobs are split into batches, sized per
+ * job by IGameplayJob::GetItemsPerBatch, and run together with ParallelFor, then every job applies in registration order. Each phase of each job has its own
+ * Insights scope (GameplayJobs.<Phase>.<Job>) and the phase totals are on "stat TankGame".
+ */
+UCLASS()
+class TANKGAME_API UGameplayJobSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Job must stay alive until it is unregistered. Jobs cannot be registered or unregistered from their own phases. */
+	void RegisterJob(IGameplayJob* Job, FName JobName);
+	void UnregisterJob(IGameplayJob* Job);
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	struct FRegisteredJob
+	{
+		IGameplayJob* Job = nullptr;
+		FString GatherScopeName;
+		FString ComputeScopeName;
+		FString ApplyScopeName;
+		int32 NumItems = 0;
+	};
+
+	struct FComputeBatch
+	{
+		int32 JobIndex = INDEX_NONE;
+		int32 FirstItem = 0;
+		int32 LastItem = 0;
+	};
+
+	TArray<FRegisteredJob> Jobs;
+
+	/** Reused every frame. */
+	TArray<FComputeBatch> Batches;
+
+	bool bRunningJobs = false;
+};
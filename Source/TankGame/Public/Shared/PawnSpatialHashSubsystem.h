@@ -0,0 +1,80 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "PawnSpatialHashSubsystem.generated.h"
+
+/**
+ * Uniform 2D grid of every damageable actor in the world (anything with a UHealthComponent).
+ *
+ * Positions are refreshed once per frame and an actor only touches the grid when it crosses into a new cell,
+ * so keeping the hash current costs one location read per actor. Radius, cone and nearest queries walk only the
+ * cells overlapping the query and never touch the physics scene, which makes them suitable for splash damage,
+ * AI target acquisition and interaction prompts.
+ */
+UCLASS()
+class TANKGAME_API UPawnSpatialHashSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void Register(AActor* Actor);
+	void Unregister(AActor* Actor);
+
+	/** Appends every registered actor within Radius of Center. */
+	void QueryRadius(const FVector& Center, float Radius, TArray<AActor*>& OutActors, const AActor* IgnoreActor = nullptr) const;
+
+	/** Appends every registered actor within Range of Origin and HalfAngle degrees of Direction. Direction must be normalized. */
+	void QueryCone(const FVector& Origin, const FVector& Direction, float HalfAngle, float Range, TArray<AActor*>& OutActors,
+		const AActor* IgnoreActor = nullptr) const;
+
+	/** Closest registered actor of ActorClass within Radius of Center, or null. */
+	AActor* FindNearest(const FVector& Center, float Radius, TSubclassOf<AActor> ActorClass, const AActor* IgnoreActor = nullptr) const;
+
+	/** Appends every registered actor. */
+	void GetRegisteredActors(TArray<AActor*>& OutActors) const;
+
+	int32 GetNumEntries() const { return Entries.Num() - FreeEntries.Num(); }
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	struct FEntry
+	{
+		TWeakObjectPtr<AActor> Actor;
+		/** Kept separately so a destroyed actor's lookup entry can still be removed. */
+		FObjectKey Key;
+		FVector Location = FVector::ZeroVector;
+		FIntPoint Cell = FIntPoint::ZeroValue;
+		int32 IndexInCell = INDEX_NONE;
+	};
+
+	FIntPoint GetCell(const FVector& Location) const;
+
+	void AddToCell(int32 EntryIndex);
+	void RemoveFromCell(int32 EntryIndex);
+	void RemoveEntry(int32 EntryIndex);
+
+	/** Calls Visitor for every live entry in the cells overlapping the square of HalfSize around Center. */
+	template <typename VisitorType>
+	void ForEachEntryInBounds(const FVector& Center, float HalfSize, VisitorType&& Visitor) const;
+
+	TArray<FEntry> Entries;
+	TArray<int32> FreeEntries;
+
+	TMap<FObjectKey, int32> EntryLookup;
+	TMap<FIntPoint, TArray<int32>> Cells;
+
+	float CellSize = 1000.f;
+	float InvCellSize = 0.001f;
+};
@@ -0,0 +1,150 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "WorldCollision.h"
+#include "SurfaceCacheSubsystem.generated.h"
+
+class ALandscapeProxy;
+class UPhysicalMaterial;
+
+/** Landscape surface at a location, as cached by USurfaceCacheSubsystem. */
+USTRUCT(BlueprintType)
+struct FCachedSurface
+{
+	GENERATED_BODY()
+
+	/** Physical material covering most of the cell. */
+	UPROPERTY(BlueprintReadOnly, Category = Surface)
+	TObjectPtr<UPhysicalMaterial> Dominant;
+
+	UPROPERTY(BlueprintReadOnly, Category = Surface)
+	TEnumAsByte<EPhysicalSurface> SurfaceType = SurfaceType_Default;
+
+	/** Second most common physical material in the cell, if any. */
+	UPROPERTY(BlueprintReadOnly, Category = Surface)
+	TObjectPtr<UPhysicalMaterial> Secondary;
+
+	/** Share of the cell covered by Secondary, 0 to 1. */
+	UPROPERTY(BlueprintReadOnly, Category = Surface)
+	float SecondaryWeight = 0.f;
+
+	/** False if the location is not over a landscape cell that has finished building. */
+	UPROPERTY(BlueprintReadOnly, Category = Surface)
+	bool bValid = false;
+};
+
+/**
+ * Coarse 2D grid of the landscape's physical materials, so wheel effects, track audio and traction can look up
+ * the ground under a tank without a scene query.
+ *
+ * The grid is split into chunks that are built as landscape proxies stream in and dropped when they stream out.
+ * Building samples each cell 2x2 with async downward traces, a budgeted number per frame
+ * (tg.SurfaceCache.TracesPerFrame), and keeps the dominant and secondary material with the secondary's weight.
+ * Queries are a chunk hash lookup plus an array index.
+ */
+UCLASS()
+class TANKGAME_API USurfaceCacheSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	FCachedSurface SampleSurface(const FVector& Location) const;
+
+	SIZE_T GetAllocatedSize() const;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	static constexpr int32 ChunkCells = 32;
+	static constexpr int32 SamplesPerAxis = 2;
+	static constexpr int32 SamplesPerCell = SamplesPerAxis * SamplesPerAxis;
+
+	struct FPackedCell
+	{
+		uint8 Dominant = 0;
+		uint8 Secondary = 0;
+		uint8 SecondaryWeight = 0;
+	};
+
+	struct FSurfaceChunk
+	{
+		TArray<FPackedCell> Cells;
+
+		/** Material index of every sample while building; freed once built. */
+		TArray<uint8> Samples;
+
+		/** Landscape proxies overlapping the chunk; a proxy already in here does not restart the chunk again. */
+		TArray<FObjectKey> Proxies;
+
+		double MinZ = 0.0;
+		double MaxZ = 0.0;
+		int32 NextSample = 0;
+		int32 PendingSamples = 0;
+		/** Changes whenever the chunk is created or restarted, so samples issued before that are ignored. */
+		uint32 Generation = 0;
+		bool bBuilt = false;
+
+		SIZE_T GetAllocatedSize() const { return Cells.GetAllocatedSize() + Samples.GetAllocatedSize() + Proxies.GetAllocatedSize(); }
+	};
+
+	struct FPendingSample
+	{
+		FIntPoint Chunk;
+		int32 SampleIndex = 0;
+		uint32 Generation = 0;
+	};
+
+	void OnLevelAdded(ULevel* Level, UWorld* World);
+	void OnLevelRemoved(ULevel* Level, UWorld* World);
+
+	/** Adds the proxy to every chunk it overlaps, or only to those in OnlyChunks if given. */
+	void EnqueueProxy(const ALandscapeProxy* Proxy, const TSet<FIntPoint>* OnlyChunks = nullptr);
+	void IssueSamples(int32 Budget);
+	void FinishChunk(FSurfaceChunk& Chunk);
+	void RestartChunk(const FIntPoint& ChunkCoord, FSurfaceChunk& Chunk);
+	void RemoveChunk(const FIntPoint& ChunkCoord);
+
+	/** Chunk memory is reported through STAT_SurfaceCacheMemory and tracked here so teardown removes exactly what was added. */
+	void TrackChunkMemory(SIZE_T Bytes);
+	void UntrackChunkMemory(SIZE_T Bytes);
+
+	void OnTraceCompleted(const FTraceHandle& Handle, FTraceDatum& Datum);
+
+	uint8 FindOrAddMaterial(UPhysicalMaterial* Material);
+
+	FIntPoint GetChunkCoord(const FVector& Location) const;
+	FBox2D GetChunkBounds(const FIntPoint& ChunkCoord) const;
+
+	float CellSize = 200.f;
+
+	TMap<FIntPoint, FSurfaceChunk> Chunks;
+	TArray<FIntPoint> BuildQueue;
+
+	/** Index 0 means no landscape. */
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UPhysicalMaterial>> Materials;
+	TMap<const UPhysicalMaterial*, uint8> MaterialLookup;
+
+	TMap<uint32, FPendingSample> PendingSamples;
+	uint32 NextSampleId = 0;
+	uint32 NextChunkGeneration = 0;
+
+	SIZE_T TrackedChunkMemory = 0;
+
+	FTraceDelegate TraceDelegate;
+	FDelegateHandle LevelAddedHandle;
+	FDelegateHandle LevelRemovedHandle;
+};
@@ -0,0 +1,86 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DeveloperSettings.h"
+#include "TankGameSettings.generated.h"
+
+class UDamageResistanceTable;
+class UDestructionCacheSet;
+class UImpactEffectSet;
+
+/**
+ * Project-wide gameplay settings for TankGame, editable under Project Settings > Game > Tank Game
+ * and stored in DefaultGame.ini.
+ */
+UCLASS(Config = Game, DefaultConfig, meta = (DisplayName = "Tank Game"))
+class TANKGAME_API UTankGameSettings : public UDeveloperSettings
+{
+	GENERATED_BODY()
+
+public:
+	UTankGameSettings();
+
+	virtual FName GetCategoryName() const override;
+
+	/** Impact, decal and muzzle effects used by the world effect pool. */
+	UPROPERTY(Config, EditAnywhere, Category = Effects)
+	TSoftObjectPtr<UImpactEffectSet> ImpactEffectSet;
+
+	/** Number of particle components pre-allocated per world. This is also the global cap on active particle effects. */
+	UPROPERTY(Config, EditAnywhere, Category = Effects, meta = (ClampMin = "1"))
+	int32 MaxPooledParticles = 96;
+
+	/** Number of decal components pre-allocated per world. This is also the global cap on active decals. */
+	UPROPERTY(Config, EditAnywhere, Category = Effects, meta = (ClampMin = "0"))
+	int32 MaxPooledDecals = 128;
+
+	/** Effects requested inside this distance of a player camera are always spawned, even when behind it. */
+	UPROPERTY(Config, EditAnywhere, Category = Effects, meta = (ClampMin = "0", Units = "cm"))
+	float EffectAlwaysRelevantDistance = 1000.f;
+
+	/** Extra angle added to the camera's half FOV before an effect is considered off-screen. */
+	UPROPERTY(Config, EditAnywhere, Category = Effects, meta = (ClampMin = "0", ClampMax = "90", Units = "deg"))
+	float EffectOffScreenMargin = 15.f;
+
+	/** Wrecks that replace destroyed tanks and props. Destroyed actors are simply removed when unset. */
+	UPROPERTY(Config, EditAnywhere, Category = Effects)
+	TSoftObjectPtr<UDestructionCacheSet> DestructionCacheSet;
+
+	/** Per-class damage multipliers applied by the damage subsystem. Everything takes full damage when unset. */
+	UPROPERTY(Config, EditAnywhere, Category = Damage)
+	TSoftObjectPtr<UDamageResistanceTable> DamageResistanceTable;
+
+	/** Cell size of the damageable actor spatial hash. Roughly the most common query radius works well. */
+	UPROPERTY(Config, EditAnywhere, Category = Spatial, meta = (ClampMin = "100", Units = "cm"))
+	float SpatialHashCellSize = 1000.f;
+
+	/** Cell size of the landscape surface cache used by tank wheels. */
+	UPROPERTY(Config, EditAnywhere, Category = Spatial, meta = (ClampMin = "50", Units = "cm"))
+	float SurfaceCacheCellSize = 200.f;
+
+	/** Center of the terrain grid tank paths are planned over. */
+	UPROPERTY(Config, EditAnywhere, Category = Navigation)
+	FVector2D PathGridCenter = FVector2D::ZeroVector;
+
+	/** Half the side length of the tank path grid. Tanks cannot plan paths outside it. */
+	UPROPERTY(Config, EditAnywhere, Category = Navigation, meta = (ClampMin = "1000", Units = "cm"))
+	float PathGridHalfExtent = 100000.f;
+
+	/** Cell size of the tank path grid. Smaller cells find narrower gaps but cost memory and planning time. */
+	UPROPERTY(Config, EditAnywhere, Category = Navigation, meta = (ClampMin = "100", Units = "cm"))
+	float PathGridCellSize = 500.f;
+
+	/** Grid rows whose asynchronous traces are issued per frame while the path grid is built after the world begins play. */
+	UPROPERTY(Config, EditAnywhere, Category = Navigation, meta = (ClampMin = "1"))
+	int32 PathGridRowsPerFrame = 8;
+
+	/** Tightest turn the path planner will ask of a tank. */
+	UPROPERTY(Config, EditAnywhere, Category = Navigation, meta = (ClampMin = "100", Units = "cm"))
+	float TankTurningRadius = 800.f;
+
+	/** Terrain steeper than this is impassable to tanks. */
+	UPROPERTY(Config, EditAnywhere, Category = Navigation, meta = (ClampMin = "1", ClampMax = "89", Units = "deg"))
+	float TankMaxSlope = 30.f;
+};
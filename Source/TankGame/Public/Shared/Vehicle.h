@@ -7,7 +7,7 @@
 #include "Vehicle.generated.h"
 
 // This class does not need to be modified.
-UINTERFACE(MinimalAPI)
+UINTERFACE(MinimalAPI, meta = (CannotImplementInterfaceInBlueprint))
 class UVehicle : public UInterface
 {
 	GENERATED_BODY()
@@ -19,12 +19,29 @@ class UVehicle : public UInterface
  * The IVehicle interface is intended to provide basic functionality for any class
  * implementing vehicle operations such as entering and exiting the vehicle.
  * This interface serves as a common blueprint for vehicle behavior in a game environment.
+ * The player controller caches it when a vehicle is possessed and drives the vehicle only through it.
  */
 class TANKGAME_API IVehicle
 {
 	GENERATED_BODY()
 	
 public:
-	void EnterVehicle();
-	void ExitVehicle();
+	/** Called after a driver has been parked inside, before the vehicle is possessed. */
+	virtual void EnterVehicle() = 0;
+
+	/** Called when the driver leaves. Driving inputs have already been released. */
+	virtual void ExitVehicle() = 0;
+
+	/** Axis, forward positive. Negative values brake, and reverse once stopped. */
+	virtual void SetThrottleInput(float Throttle) = 0;
+
+	/** Axis, right positive. */
+	virtual void SetSteeringInput(float Steering) = 0;
+
+	virtual void SetHandbrakeInput(bool bHandbrake) = 0;
+
+	virtual void FirePrimary() = 0;
+
+	/** Where the driver is placed on exit. */
+	virtual FTransform GetExitTransform() const = 0;
 };
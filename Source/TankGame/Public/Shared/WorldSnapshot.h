@@ -0,0 +1,81 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Plain state of one tank. Copied on the game thread, serialized on a worker. */
+struct FTankSnapshot
+{
+	FVector Location = FVector::ZeroVector;
+	FQuat Rotation = FQuat::Identity;
+	FVector LinearVelocity = FVector::ZeroVector;
+	FVector AngularVelocity = FVector::ZeroVector;
+	double TurretAngle = 0.0;
+	double GunAngle = 0.0;
+	float Health = 0.f;
+	int32 ClassIndex = INDEX_NONE;
+	bool bLightsOn = false;
+	bool bOccupied = false;
+	bool bPlayerControlled = false;
+};
+
+/** Plain state of one character. Copied on the game thread, serialized on a worker. */
+struct FCharacterSnapshot
+{
+	FVector Location = FVector::ZeroVector;
+	FRotator Rotation = FRotator::ZeroRotator;
+	FVector Velocity = FVector::ZeroVector;
+	float Health = 0.f;
+	int32 ClassIndex = INDEX_NONE;
+	bool bAiming = false;
+	bool bCrouched = false;
+	bool bOccupied = false;
+	/** True for the player's character, whether on foot or parked inside the player's tank. */
+	bool bPlayerControlled = false;
+	/** Parked inside the player's tank rather than on foot. */
+	bool bInVehicle = false;
+};
+
+/**
+ * Checkpoint of every tank and character in a world.
+ *
+ * On disk: a fixed header (magic, format version, uncompressed and compressed sizes) followed by an
+ * Oodle-compressed payload holding the class table and the records. Records are written field by field
+ * against the format version, so older checkpoints keep loading as fields are added.
+ */
+struct TANKGAME_API FWorldSnapshot
+{
+	static constexpr uint32 Magic = 0x50434754;	// "TGCP"
+
+	enum EVersion : uint32
+	{
+		Initial = 1,
+		/** Characters record whether they are parked inside the player's tank. */
+		VehicleOccupancy = 2,
+
+		LatestPlusOne,
+		Latest = LatestPlusOne - 1
+	};
+
+	/** Returns the index of Class in the class table, adding it if needed. */
+	int32 AddClass(const UClass* Class);
+
+	void Reset();
+
+	/** Serializes and compresses the snapshot. Safe on any thread. */
+	bool Encode(TArray<uint8>& OutBytes) const;
+
+	/** Decompresses and deserializes bytes written by Encode. Safe on any thread. */
+	bool Decode(const TArray<uint8>& Bytes);
+
+	TArray<FSoftClassPath> Classes;
+	TArray<FTankSnapshot> Tanks;
+	TArray<FCharacterSnapshot> Characters;
+
+private:
+	void SerializePayload(FArchive& Ar, uint32 Version);
+
+	/** Game-thread lookup for AddClass; not serialized. */
+	TMap<const UClass*, int32> ClassIndices;
+};
@@ -0,0 +1,68 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * An armor plate baked for ray queries: an oriented box in tank space whose local Z axis is the plate normal.
+ */
+struct FArmorPlatePrimitive
+{
+	FVector3f Center;
+	FVector3f AxisX;
+	FVector3f AxisY;
+	FVector3f AxisZ;
+	FVector3f HalfExtent;
+	int32 PlateIndex = INDEX_NONE;
+};
+
+struct FArmorRayHit
+{
+	/** Index into the plate array the BVH was built from. */
+	int32 PlateIndex = INDEX_NONE;
+	float Distance = 0.f;
+};
+
+/**
+ * Bounding volume hierarchy over the armor plates of one tank archetype.
+ *
+ * Built once per UTankArmorLayout and queried for every shell hit, so it is kept flat and small: nodes are
+ * 32 bytes, stored depth first with the left child directly after its parent, and leaves reference a
+ * contiguous run of primitives. Queries are const and allocation free.
+ */
+class TANKGAME_API FArmorBVH
+{
+public:
+	void Build(TArray<FArmorPlatePrimitive>&& InPrimitives);
+	void Reset();
+
+	bool IsBuilt() const { return Nodes.Num() > 0; }
+
+	/** Finds the closest plate along a tank-space ray. Direction must be normalized. */
+	bool Raycast(const FVector3f& Origin, const FVector3f& Direction, float MaxDistance, FArmorRayHit& OutHit) const;
+
+	/** Local-space bounds of every plate. */
+	FBox3f GetBounds() const;
+
+	SIZE_T GetAllocatedSize() const { return Nodes.GetAllocatedSize() + Primitives.GetAllocatedSize(); }
+
+private:
+	struct FNode
+	{
+		FVector3f BoundsMin;
+		/** Right child for interior nodes (the left child is the next node), first primitive for leaves. */
+		int32 Offset = 0;
+		FVector3f BoundsMax;
+		/** Zero for interior nodes. */
+		int32 PrimitiveCount = 0;
+	};
+
+	static constexpr int32 MaxLeafPrimitives = 2;
+	static constexpr int32 MaxDepth = 32;
+
+	int32 BuildRecursive(int32 Begin, int32 End, int32 Depth);
+
+	TArray<FNode> Nodes;
+	TArray<FArmorPlatePrimitive> Primitives;
+};
@@ -0,0 +1,99 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FFireControlParams
+{
+	/** Shell speed leaving the muzzle. */
+	float MuzzleSpeed = 80000.f;
+
+	/** Downward acceleration applied to the shell. */
+	float Gravity = 980.f;
+
+	/** Time-of-flight refinements per arc. Three is enough for targets below about 30 m/s. */
+	int32 Iterations = 3;
+};
+
+/**
+ * Candidate targets stored as structure of arrays, padded with zeroes to a multiple of the SIMD width so the
+ * kernel never needs a scalar tail.
+ */
+struct TANKGAME_API FFireControlTargets
+{
+	static constexpr int32 Width = 4;
+
+	void Reset(int32 ExpectedNum = 0);
+
+	/** Returns the target index used to look up its solutions. */
+	int32 Add(const FVector& Location, const FVector& Velocity);
+
+	int32 Num() const { return NumTargets; }
+	int32 GetPaddedNum() const { return PosX.Num(); }
+
+	TArray<float, TAlignedHeapAllocator<16>> PosX;
+	TArray<float, TAlignedHeapAllocator<16>> PosY;
+	TArray<float, TAlignedHeapAllocator<16>> PosZ;
+	TArray<float, TAlignedHeapAllocator<16>> VelX;
+	TArray<float, TAlignedHeapAllocator<16>> VelY;
+	TArray<float, TAlignedHeapAllocator<16>> VelZ;
+
+private:
+	int32 NumTargets = 0;
+};
+
+/** Aim for one shooter and target pair. Times are negative when the target is out of range on that arc. */
+struct FFireControlSolution
+{
+	float LowYaw = 0.f;
+	float LowPitch = 0.f;
+	float LowTime = -1.f;
+	float HighYaw = 0.f;
+	float HighPitch = 0.f;
+	float HighTime = -1.f;
+
+	/** True if the low arc reaches the target. */
+	bool HasSolution() const { return LowTime >= 0.f; }
+
+	/** True if the high (lob) arc reaches the target. */
+	bool HasHighSolution() const { return HighTime >= 0.f; }
+};
+
+/**
+ * Solutions for every shooter against every target, as structure of arrays with one row of GetPaddedNum()
+ * entries per shooter. Angles are in degrees in world space.
+ */
+struct TANKGAME_API FFireControlSolutions
+{
+	FFireControlSolution Get(int32 ShooterIndex, int32 TargetIndex) const;
+
+	int32 NumShooters = 0;
+	int32 RowStride = 0;
+
+	TArray<float, TAlignedHeapAllocator<16>> LowYaw;
+	TArray<float, TAlignedHeapAllocator<16>> LowPitch;
+	TArray<float, TAlignedHeapAllocator<16>> LowTime;
+	TArray<float, TAlignedHeapAllocator<16>> HighYaw;
+	TArray<float, TAlignedHeapAllocator<16>> HighPitch;
+	TArray<float, TAlignedHeapAllocator<16>> HighTime;
+};
+
+/**
+ * Fire-control solver for shells under gravity against targets moving at constant velocity.
+ *
+ * Each arc is solved by fixed-point iteration on time of flight: predict where the target will be, solve the
+ * launch angle that reaches that point, and derive a new flight time from it. The batched solver runs four
+ * targets per instruction against each shooter and is branch free, with out-of-range lanes masked at the
+ * end. There are no UObject dependencies, so it can be exercised without a world.
+ */
+struct TANKGAME_API FFireControl
+{
+	/** Shooter locations are muzzle positions, e.g. a tank's GunLocation plus ProjectileOffset. */
+	static void SolveBatch(TConstArrayView<FVector> ShooterLocations, const FFireControlTargets& Targets, const FFireControlParams& Params,
+		FFireControlSolutions& OutSolutions);
+
+	/** Scalar version of the batch kernel for one pair, for one-off queries and for validating the batch. */
+	static FFireControlSolution Solve(const FVector& ShooterLocation, const FVector& TargetLocation, const FVector& TargetVelocity,
+		const FFireControlParams& Params);
+};
@@ -6,11 +6,18 @@
 #include "WheeledVehiclePawn.h"
 #include "Components/TimelineComponent.h"
 #include "Shared/Vehicle.h"
+#include "Tank/TankArmorLayout.h"
 #include "Tank.generated.h"
 
+class UDamageSubsystem;
+class UHealthComponent;
+class UTankAudioComponent;
 class USpringArmComponent;
 class UCameraComponent;
 class USpotLightComponent;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnTankFlipStateChanged, ATank*, Tank, bool, bFlipped);
+
 /**
  * @brief Represents a tank vehicle, inheriting from AWheeledVehiclePawn and implementing the IVehicle interface.
  *        This class includes properties for tank functionalities, visual effects, controls, and gameplay-related components.
@@ -33,8 +40,16 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void GunSightScreen();
 	
+	/** Returns the flip state last detected by the physics-driven flip check. Bind OnFlipStateChanged instead of polling this. */
 	UFUNCTION(BlueprintPure)
 	void VehicleFlip(bool& ReturnValue);
+
+	UFUNCTION(BlueprintPure)
+	bool IsFlipped() const { return bIsFlipped; }
+
+	/** Broadcast when the tank comes to rest flipped over, and again when it is back on its tracks. */
+	UPROPERTY(BlueprintAssignable)
+	FOnTankFlipStateChanged OnFlipStateChanged;
 	
 	UFUNCTION(BlueprintCallable)
 	void EnterTank();
@@ -42,6 +57,30 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void ExitTank();
 
+	/**
+	 * Fires the main gun: plays the pooled muzzle effect at GunFire and traces the shell along the barrel,
+	 * spawning a pooled impact effect and applying ShellDamage to whatever it hits and SplashDamage around it.
+	 */
+	UFUNCTION(BlueprintCallable)
+	void FireGun();
+
+	/**
+	 * Resolves a shell travelling along a world-space ray against this tank's ArmorLayout.
+	 * Tanks without a layout are treated as unarmored.
+	 */
+	UFUNCTION(BlueprintCallable)
+	FArmorHitResult ResolveShellHit(const FVector& Origin, const FVector& Direction, float Penetration, float Caliber) const;
+
+	//~ Begin IVehicle Interface
+	virtual void EnterVehicle() override;
+	virtual void ExitVehicle() override;
+	virtual void SetThrottleInput(float Throttle) override;
+	virtual void SetSteeringInput(float Steering) override;
+	virtual void SetHandbrakeInput(bool bHandbrake) override;
+	virtual void FirePrimary() override;
+	virtual FTransform GetExitTransform() const override;
+	//~ End IVehicle Interface
+
 	UPROPERTY(BlueprintReadWrite, EditDefaultsOnly, Category="Default")
 	TObjectPtr<USkeletalMeshComponent> SkeletalMesh;
 	
@@ -114,6 +153,12 @@ public:
 	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category="Default")
 	TObjectPtr<USpringArmComponent> SpringArm;
 	
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category="Default")
+	TObjectPtr<UHealthComponent> HealthComponent;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category="Default")
+	TObjectPtr<UTankAudioComponent> AudioComponent;
+	
 	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category="BP_Tank")
 	TObjectPtr<UTimelineComponent> Timeline;
 	
@@ -138,6 +183,27 @@ public:
 	UPROPERTY(BlueprintReadWrite, EditDefaultsOnly, Category="Default")
 	FVector ProjectileOffset;
 	
+	UPROPERTY(BlueprintReadWrite, EditDefaultsOnly, Category="Default")
+	float ShellDamage = 250.f;
+
+	UPROPERTY(BlueprintReadWrite, EditDefaultsOnly, Category="Default")
+	float ShellRange = 50000.f;
+
+	UPROPERTY(BlueprintReadWrite, EditDefaultsOnly, Category="Default")
+	float SplashDamage = 100.f;
+
+	UPROPERTY(BlueprintReadWrite, EditDefaultsOnly, Category="Default", meta=(Units="cm"))
+	float SplashRadius = 500.f;
+
+	UPROPERTY(BlueprintReadWrite, EditDefaultsOnly, Category="Default", meta=(Units="mm"))
+	float ShellPenetration = 150.f;
+
+	UPROPERTY(BlueprintReadWrite, EditDefaultsOnly, Category="Default", meta=(Units="mm"))
+	float ShellCaliber = 88.f;
+
+	UPROPERTY(BlueprintReadOnly, EditDefaultsOnly, Category="Default")
+	TObjectPtr<UTankArmorLayout> ArmorLayout;
+	
 	UPROPERTY(BlueprintReadWrite, EditDefaultsOnly, Category="Default")
 	bool StopTurn;
 	
@@ -150,7 +216,60 @@ public:
 	UPROPERTY(BlueprintReadWrite, EditDefaultsOnly, Category="Default")
 	bool AllowLightChange;
 
+	/** Applies a righting impulse automatically when the tank is flipped. */
+	UPROPERTY(BlueprintReadWrite, EditDefaultsOnly, Category="Flip")
+	bool bAutoRight = false;
+
+	/** Seconds between flip checks once the tank tilts past FlipUpDot. No checks run while it is upright or asleep. */
+	UPROPERTY(BlueprintReadWrite, EditDefaultsOnly, Category="Flip", meta=(ClampMin="0.05", Units="s"))
+	float FlipCheckInterval = 0.25f;
+
+	/** The tank counts as flipped once its up vector's Z falls below this... */
+	UPROPERTY(BlueprintReadWrite, EditDefaultsOnly, Category="Flip", meta=(ClampMin="-1", ClampMax="1"))
+	float FlipUpDot = 0.3f;
+
+	/** ...and as upright again once it rises above this. */
+	UPROPERTY(BlueprintReadWrite, EditDefaultsOnly, Category="Flip", meta=(ClampMin="-1", ClampMax="1"))
+	float RecoverUpDot = 0.7f;
+
+	/** How long the tank must stay tilted past FlipUpDot, turning slower than FlipMaxAngularSpeed, to count as flipped. */
+	UPROPERTY(BlueprintReadWrite, EditDefaultsOnly, Category="Flip", meta=(ClampMin="0", Units="s"))
+	float FlipConfirmTime = 1.f;
+
+	UPROPERTY(BlueprintReadWrite, EditDefaultsOnly, Category="Flip", meta=(ClampMin="0", Units="deg"))
+	float FlipMaxAngularSpeed = 45.f;
+
+	/** Roll rate given to the body by a righting impulse. Applied as a velocity change, so it does not depend on mass. */
+	UPROPERTY(BlueprintReadWrite, EditDefaultsOnly, Category="Flip", meta=(ClampMin="0", Units="deg"))
+	float RightingAngularSpeed = 150.f;
+
+	UPROPERTY(BlueprintReadWrite, EditDefaultsOnly, Category="Flip", meta=(ClampMin="0", Units="s"))
+	float RightingCooldown = 3.f;
+
 protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	void ApplySplashDamage(const FVector& ImpactPoint, const AActor* DirectHitActor, UDamageSubsystem* DamageSubsystem);
+
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
+
+private:
+	UFUNCTION()
+	void OnBodyWake(UPrimitiveComponent* WakingComponent, FName BoneName);
+
+	UFUNCTION()
+	void OnBodySleep(UPrimitiveComponent* SleepingComponent, FName BoneName);
+
+	void StartFlipChecks();
+	void CheckFlip();
+	void SetFlipped(bool bFlipped);
+	void ApplyRightingImpulse();
+
+	FTimerHandle FlipCheckTimer;
+	float TimeTilted = 0.f;
+	double LastRightingTime = -UE_BIG_NUMBER;
+	bool bBodyAwake = false;
+	bool bIsFlipped = false;
 };
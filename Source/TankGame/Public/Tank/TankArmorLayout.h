@@ -0,0 +1,165 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "Tank/ArmorBVH.h"
+#include "TankArmorLayout.generated.h"
+
+/** Internal tank modules that can be damaged by a penetrating shell. */
+UENUM(BlueprintType)
+enum class ETankModule : uint8
+{
+	None,
+	Engine,
+	Transmission,
+	AmmoRack,
+	FuelTank,
+	Crew,
+	TurretRing,
+	Gun
+};
+
+UENUM(BlueprintType)
+enum class EArmorHitOutcome : uint8
+{
+	/** The shell did not touch any plate, so it hit an unarmored part of the tank. */
+	Unarmored,
+	Ricochet,
+	NonPenetration,
+	Penetration
+};
+
+/**
+ * One armor plate, authored in tank (actor) space. The plate's local Z axis is its outward normal.
+ */
+USTRUCT(BlueprintType)
+struct TANKGAME_API FArmorPlate
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Armor)
+	FName Name;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Armor)
+	FVector Center = FVector::ZeroVector;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Armor)
+	FRotator Rotation = FRotator::ZeroRotator;
+
+	/** Width and height of the plate face. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Armor, meta = (Units = "cm"))
+	FVector2D Size = FVector2D(100.f, 100.f);
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Armor, meta = (ClampMin = "0", Units = "mm"))
+	float Thickness = 50.f;
+};
+
+/**
+ * An internal module volume, authored in tank space as an axis aligned box.
+ */
+USTRUCT(BlueprintType)
+struct TANKGAME_API FArmorModuleVolume
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Armor)
+	ETankModule Module = ETankModule::None;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Armor)
+	FVector Center = FVector::ZeroVector;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Armor, meta = (Units = "cm"))
+	FVector Extent = FVector(50.f, 50.f, 50.f);
+
+	/** Scales shell damage when a penetrating shell passes through this module. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Armor, meta = (ClampMin = "0"))
+	float DamageMultiplier = 1.f;
+};
+
+USTRUCT(BlueprintType)
+struct TANKGAME_API FArmorHitResult
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = Armor)
+	EArmorHitOutcome Outcome = EArmorHitOutcome::Unarmored;
+
+	UPROPERTY(BlueprintReadOnly, Category = Armor)
+	int32 PlateIndex = INDEX_NONE;
+
+	/** Angle between the shell path and the plate normal. */
+	UPROPERTY(BlueprintReadOnly, Category = Armor, meta = (Units = "deg"))
+	float ImpactAngle = 0.f;
+
+	/** Plate thickness along the shell path. */
+	UPROPERTY(BlueprintReadOnly, Category = Armor, meta = (Units = "mm"))
+	float EffectiveThickness = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = Armor)
+	ETankModule Module = ETankModule::None;
+
+	/** Multiplier to apply to the shell's damage. */
+	UPROPERTY(BlueprintReadOnly, Category = Armor)
+	float DamageMultiplier = 1.f;
+};
+
+/**
+ * Locational armor for one tank archetype.
+ *
+ * Plates are baked into an FArmorBVH once, when the asset is loaded or edited, and every tank using the asset
+ * shares it. ResolveShellHit is pure math on that BVH, so a shell that already hit the tank through its
+ * collision trace resolves penetration, ricochet and module damage without any further physics queries.
+ */
+UCLASS(BlueprintType)
+class TANKGAME_API UTankArmorLayout : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	virtual void PostLoad() override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	/**
+	 * Resolves a shell travelling along a tank-space ray. Tank space is unscaled: plates are authored in cm
+	 * regardless of the actor's scale.
+	 * @param Origin		Ray origin in tank space, outside the armor.
+	 * @param Direction		Normalized ray direction in tank space.
+	 * @param Penetration	Shell penetration, in mm of armor at normal impact.
+	 * @param Caliber		Shell caliber in mm, used for overmatch.
+	 */
+	FArmorHitResult ResolveShellHit(const FVector& Origin, const FVector& Direction, float Penetration, float Caliber) const;
+
+	const FArmorBVH& GetBVH() const { return BVH; }
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Armor, meta = (TitleProperty = "Name"))
+	TArray<FArmorPlate> Plates;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Armor, meta = (TitleProperty = "Module"))
+	TArray<FArmorModuleVolume> Modules;
+
+	/** Impacts steeper than this from the plate normal bounce off, unless the shell overmatches the plate. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Armor, meta = (ClampMin = "0", ClampMax = "90", Units = "deg"))
+	float RicochetAngle = 70.f;
+
+	/** A shell whose caliber exceeds the plate thickness by this ratio can never ricochet off it. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Armor, meta = (ClampMin = "1"))
+	float OvermatchRatio = 3.f;
+
+	/** Fraction of shell damage still dealt when a shell fails to penetrate. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Armor, meta = (ClampMin = "0", ClampMax = "1"))
+	float NonPenetrationDamageMultiplier = 0.1f;
+
+	/** How far behind the plate a penetrating shell can damage modules. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Armor, meta = (ClampMin = "0", Units = "cm"))
+	float PostPenetrationDistance = 300.f;
+
+private:
+	/** Bakes Plates into BVH. Only called from PostLoad and on edit, so queries never mutate the shared asset. */
+	void RebuildBVH();
+
+	FArmorBVH BVH;
+};
@@ -0,0 +1,105 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SceneComponent.h"
+#include "TankAudioComponent.generated.h"
+
+class ATank;
+class UAudioComponent;
+class USoundBase;
+class USoundConcurrency;
+
+/**
+ * Engine, track and turret traverse loops plus gunfire for one tank.
+ *
+ * Does not tick. UTankAudioSubsystem decides every frame which tanks get voices and how often each one's
+ * parameters are pushed. Tanks outside the voice budget are virtualized: their loops are stopped but their
+ * state keeps being tracked, so they resume with current parameters when they become audible again.
+ */
+UCLASS(ClassGroup = (Audio), meta = (BlueprintSpawnableComponent))
+class TANKGAME_API UTankAudioComponent : public USceneComponent
+{
+	GENERATED_BODY()
+
+public:
+	UTankAudioComponent();
+
+	/** Plays the gun report at this component, unless the tank is beyond MaxAudibleDistance of every listener. */
+	UFUNCTION(BlueprintCallable, Category = Audio)
+	void PlayGunfire();
+
+	/** Starts or stops the loops. Called by UTankAudioSubsystem. */
+	void SetVoiced(bool bInVoiced);
+	bool IsVoiced() const { return bVoiced; }
+
+	/** Recomputes parameters from the tank, and pushes them to the loops if voiced. DeltaTime is time since the last update. */
+	void UpdateParameters(float DeltaTime);
+
+	/** Higher is more important. Occupied tanks and tanks that fired recently are boosted. */
+	float GetPriority() const;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Audio)
+	TObjectPtr<USoundBase> EngineSound;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Audio)
+	TObjectPtr<USoundBase> TrackSound;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Audio)
+	TObjectPtr<USoundBase> TraverseSound;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Audio)
+	TObjectPtr<USoundBase> GunfireSound;
+
+	/** Concurrency group shared by every tank's loops. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Audio)
+	TObjectPtr<USoundConcurrency> LoopConcurrency;
+
+	/** Concurrency group shared by every tank's gunfire. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Audio)
+	TObjectPtr<USoundConcurrency> GunfireConcurrency;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Audio)
+	FName RPMParameter = TEXT("RPM");
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Audio)
+	FName TrackSpeedParameter = TEXT("TrackSpeed");
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Audio)
+	FName TraverseRateParameter = TEXT("TraverseRate");
+
+	/** Integer parameter on the track loop set to the EPhysicalSurface under the first wheel. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Audio)
+	FName TrackSurfaceParameter = TEXT("Surface");
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Audio, meta = (ClampMin = "0", Units = "cm"))
+	float MaxAudibleDistance = 15000.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Audio, meta = (ClampMin = "0"))
+	float BasePriority = 1.f;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	UAudioComponent* CreateLoop(USoundBase* Sound, const TCHAR* Name);
+
+	UPROPERTY(Transient)
+	TObjectPtr<UAudioComponent> EngineLoop;
+
+	UPROPERTY(Transient)
+	TObjectPtr<UAudioComponent> TrackLoop;
+
+	UPROPERTY(Transient)
+	TObjectPtr<UAudioComponent> TraverseLoop;
+
+	float EngineRPM = 0.f;
+	float TrackSpeed = 0.f;
+	float TraverseRate = 0.f;
+	int32 TrackSurface = SurfaceType_Default;
+	double PreviousTurretAngle = 0.0;
+	double LastGunfireTime = -UE_BIG_NUMBER;
+	bool bVoiced = false;
+};
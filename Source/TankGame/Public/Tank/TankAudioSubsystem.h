@@ -0,0 +1,60 @@
+// Copyright (c) 2025 Sawnoff Games. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TankAudioSubsystem.generated.h"
+
+class UTankAudioComponent;
+
+/**
+ * Budgets tank audio voices.
+ *
+ * Every frame tanks are scored by priority over distance to the nearest listener. The best
+ * tg.TankAudio.MaxVoicedTanks within audible range keep their loops; the rest are virtualized. Voiced tanks
+ * within tg.TankAudio.NearDistance update their parameters every frame, farther ones every
+ * tg.TankAudio.FarUpdateInterval frames, staggered so the cost is spread evenly.
+ */
+UCLASS()
+class TANKGAME_API UTankAudioSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void RegisterTank(UTankAudioComponent* TankAudio);
+	void UnregisterTank(UTankAudioComponent* TankAudio);
+
+	/** Distance from Location to the nearest audio listener, or a large number when there is none. */
+	double GetListenerDistance(const FVector& Location) const;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	struct FTankAudioEntry
+	{
+		TWeakObjectPtr<UTankAudioComponent> Component;
+		float TimeSinceUpdate = 0.f;
+		float Score = 0.f;
+		double Distance = 0.0;
+		bool bShouldVoice = false;
+	};
+
+	void GatherListeners();
+
+	TArray<FTankAudioEntry> Entries;
+
+	/** Listener locations, refreshed at the start of every Tick. */
+	TArray<FVector, TInlineAllocator<4>> Listeners;
+
+	/** Reused every frame to rank entries without reallocating. */
+	TArray<int32> RankedEntries;
+
+	uint32 FrameCounter = 0;
+};
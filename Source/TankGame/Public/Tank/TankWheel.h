@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "ChaosVehicleWheel.h"
+#include "Shared/SurfaceCacheSubsystem.h"
 #include "TankWheel.generated.h"
 /**
  * @class UTankWheel
@@ -21,4 +22,11 @@ class TANKGAME_API UTankWheel : public UChaosVehicleWheel
 public:
 	// Sets default values for this character's properties
 	UTankWheel();
+
+	/**
+	 * The landscape surface under this wheel's contact point, from USurfaceCacheSubsystem rather than a trace.
+	 * Invalid while the wheel is off the ground.
+	 */
+	UFUNCTION(BlueprintPure, Category = Surface)
+	FCachedSurface GetCachedSurface() const;
 };
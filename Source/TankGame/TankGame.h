@@ -4,3 +4,6 @@
 
 #include "CoreMinimal.h"
 
+DECLARE_LOG_CATEGORY_EXTERN(LogTankGame, Log, All);
+
+DECLARE_STATS_GROUP(TEXT("TankGame"), STATGROUP_TankGame, STATCAT_Advanced);